@@ -0,0 +1,63 @@
+package com.example.finalappv2;
+
+import android.support.test.runner.AndroidJUnit4;
+import android.util.Log;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.util.Random;
+
+//time of top-k and NMS over a full tiled frame worth of candidates on the phone, target is under 100 us
+//only logged (adb logcat -s INFO), correctness is checked by DetectionFilterTest
+//run: ./gradlew connectedAndroidTest -Pandroid.testInstrumentationRunnerArguments.class=com.example.finalappv2.DetectionFilterBenchmark
+@RunWith(AndroidJUnit4.class)
+public class DetectionFilterBenchmark {
+
+    private static final int CANDIDATES = 4096;
+    private static final int TOP_K = 100;
+    private static final int MAX_OUT = 10;
+    private static final float IOU = 0.6f;
+    private static final int WARMUP = 2000;
+    private static final int RUNS = 1000;
+
+    @Test
+    public void topKAndNms() {
+        float[] y0 = new float[CANDIDATES], x0 = new float[CANDIDATES];
+        float[] y1 = new float[CANDIDATES], x1 = new float[CANDIDATES];
+        float[] score = new float[CANDIDATES];
+        int[] cls = new int[CANDIDATES];
+        //candidates cluster around a few objects like detector output does
+        Random random = new Random(7);
+        for (int i = 0; i < CANDIDATES; i++) {
+            float cy = (i % 23) / 23f, cx = (i % 17) / 17f, h = 0.05f + 0.1f * random.nextFloat();
+            y0[i] = cy + 0.01f * random.nextFloat();
+            x0[i] = cx + 0.01f * random.nextFloat();
+            y1[i] = y0[i] + h;
+            x1[i] = x0[i] + h;
+            score[i] = random.nextFloat();
+            cls[i] = random.nextInt(3);
+        }
+
+        DetectionFilter f = new DetectionFilter(CANDIDATES);
+        long[] times = new long[RUNS];
+        for (int i = 0; i < WARMUP + RUNS; i++) {
+            System.arraycopy(y0, 0, f.ymin, 0, CANDIDATES);
+            System.arraycopy(x0, 0, f.xmin, 0, CANDIDATES);
+            System.arraycopy(y1, 0, f.ymax, 0, CANDIDATES);
+            System.arraycopy(x1, 0, f.xmax, 0, CANDIDATES);
+            System.arraycopy(score, 0, f.scores, 0, CANDIDATES);
+            System.arraycopy(cls, 0, f.classes, 0, CANDIDATES);
+            f.count = CANDIDATES;
+            long start = System.nanoTime();
+            f.topK(TOP_K);
+            f.nms(IOU, MAX_OUT);
+            if (i >= WARMUP) {
+                times[i - WARMUP] = System.nanoTime() - start;
+            }
+        }
+        java.util.Arrays.sort(times);
+        Log.d("INFO", "topK + nms over " + CANDIDATES + " candidates: p50 " + times[RUNS / 2] / 1000
+                + "us, p99 " + times[RUNS * 99 / 100] / 1000 + "us");
+    }
+}
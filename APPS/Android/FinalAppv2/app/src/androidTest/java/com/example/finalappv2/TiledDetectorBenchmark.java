@@ -0,0 +1,167 @@
+package com.example.finalappv2;
+
+import android.content.Context;
+import android.graphics.Bitmap;
+import android.graphics.BitmapFactory;
+import android.os.SystemClock;
+import android.support.test.InstrumentationRegistry;
+import android.support.test.runner.AndroidJUnit4;
+import android.util.Log;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.FileReader;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+
+import static org.junit.Assume.assumeTrue;
+
+//full frame detection against tiled detection on a fixed set of square frames, time and recall are logged
+//(adb logcat -s INFO), skipped when the set is not on the phone
+//set: <app external files>/frames/labels.csv, one object per line: file,class,xmin,ymin,xmax,ymax
+//with the box in 0..1 units of the centered square of the frame (the detection area, like the preview),
+//class as the detector outputs it (COCO id - 1), the frames (jpg or png) next to it:
+//adb push frames /sdcard/Android/data/com.example.finalappv2/files/
+//run: ./gradlew connectedAndroidTest -Pandroid.testInstrumentationRunnerArguments.class=com.example.finalappv2.TiledDetectorBenchmark
+@RunWith(AndroidJUnit4.class)
+public class TiledDetectorBenchmark {
+
+    //same settings as Camera2BasicFragment
+    private static final int DETECTIONS = ImageClassifierQuantizedMobileNet.DETECTIONS;
+    private static final float MIN_SCORE = 0.5f;
+    private static final float NMS_IOU = 0.6f;
+    private static final int PRE_NMS_TOP_K = 100;
+    private static final int DETECTOR_SIZE = 300;
+    private static final int TILE_SIZE = 540;
+    private static final float TILE_OVERLAP = 0.25f;
+    private static final int TILE_WORKERS = 2;
+    private static final int MAX_TILES = 16;
+    private static final float MATCH_IOU = 0.5f; //a detection of the same class this close finds an object
+
+    private static class Frame {
+        String file;
+        Bitmap bitmap;
+        final List<float[]> objects = new ArrayList<>(); //class, xmin, ymin, xmax, ymax
+    }
+
+    private static class Result {
+        long ms;
+        int found, objects;
+
+        @Override
+        public String toString() {
+            return (objects == 0 ? "-" : (found * 100 / objects) + "% recall") + ", " + ms + "ms";
+        }
+    }
+
+    @Test
+    public void fullFrameAgainstTiles() throws IOException {
+        Context context = InstrumentationRegistry.getTargetContext();
+        File dir = new File(context.getExternalFilesDir(null), "frames");
+        File labels = new File(dir, "labels.csv");
+        assumeTrue("no frame set in " + dir, labels.exists());
+        List<Frame> frames = load(dir, labels);
+        assumeTrue("frame set is empty", !frames.isEmpty());
+
+        ImageClassifierQuantizedMobileNet classifier = new ImageClassifierQuantizedMobileNet(context);
+        classifier.setNumThreads(TILE_WORKERS * 2);
+        TiledDetector tiled = new TiledDetector(context, TILE_SIZE, TILE_OVERLAP, TILE_WORKERS, 2);
+        DetectionFilter detections = new DetectionFilter(DETECTIONS * MAX_TILES);
+        try {
+            //first pass warms up both, the second one is measured
+            for (int pass = 0; pass < 2; pass++) {
+                Result full = new Result(), tiles = new Result();
+                for (Frame frame : frames) {
+                    long start = SystemClock.uptimeMillis();
+                    Bitmap scaled = Bitmap.createScaledBitmap(frame.bitmap, DETECTOR_SIZE, DETECTOR_SIZE, false);
+                    classifier.classifyFrame(scaled);
+                    detections.load(classifier.getBoxes(), classifier.getScores(), classifier.getClasses(),
+                            DETECTIONS, MIN_SCORE, DetectionFilter.ANY_CLASS);
+                    detections.topK(PRE_NMS_TOP_K);
+                    detections.nms(NMS_IOU, DETECTIONS);
+                    full.ms += SystemClock.uptimeMillis() - start;
+                    score(frame, detections, full);
+                    if (scaled != frame.bitmap) {
+                        scaled.recycle();
+                    }
+
+                    start = SystemClock.uptimeMillis();
+                    tiled.detect(frame.bitmap, 0, 0, frame.bitmap.getWidth(), MIN_SCORE, DetectionFilter.ANY_CLASS, detections);
+                    detections.topK(PRE_NMS_TOP_K);
+                    detections.nms(NMS_IOU, DETECTIONS);
+                    tiles.ms += SystemClock.uptimeMillis() - start;
+                    score(frame, detections, tiles);
+                }
+                if (pass == 1) {
+                    full.ms /= frames.size();
+                    tiles.ms /= frames.size();
+                    Log.d("INFO", "detection on " + frames.size() + " frames, full: " + full + " | tiled: " + tiles);
+                }
+            }
+        } finally {
+            tiled.close();
+            classifier.close();
+            for (Frame frame : frames) {
+                frame.bitmap.recycle();
+            }
+        }
+    }
+
+    private static List<Frame> load(File dir, File labels) throws IOException {
+        List<Frame> frames = new ArrayList<>();
+        try (BufferedReader reader = new BufferedReader(new FileReader(labels))) {
+            String line;
+            Frame frame = null;
+            while ((line = reader.readLine()) != null) {
+                String[] f = line.trim().split(",");
+                if (f.length != 6) {
+                    continue;
+                }
+                if (frame == null || !frame.file.equals(f[0])) {
+                    Bitmap bitmap = BitmapFactory.decodeFile(new File(dir, f[0]).getPath());
+                    if (bitmap == null) {
+                        Log.e("ERR", "cant read frame " + f[0]);
+                        frame = null;
+                        continue;
+                    }
+                    int side = Math.min(bitmap.getWidth(), bitmap.getHeight());
+                    frame = new Frame();
+                    frame.file = f[0];
+                    frame.bitmap = Bitmap.createBitmap(bitmap, (bitmap.getWidth() - side) / 2,
+                            (bitmap.getHeight() - side) / 2, side, side);
+                    if (frame.bitmap != bitmap) {
+                        bitmap.recycle();
+                    }
+                    frames.add(frame);
+                }
+                frame.objects.add(new float[]{Float.parseFloat(f[1]), Float.parseFloat(f[2]), Float.parseFloat(f[3]),
+                        Float.parseFloat(f[4]), Float.parseFloat(f[5])});
+            }
+        }
+        return frames;
+    }
+
+    private static void score(Frame frame, DetectionFilter d, Result result) {
+        for (float[] object : frame.objects) {
+            result.objects++;
+            for (int i = 0; i < d.count; i++) {
+                if (d.classes[i] != (int) object[0]) {
+                    continue;
+                }
+                float h = Math.min(d.ymax[i], object[4]) - Math.max(d.ymin[i], object[2]);
+                float w = Math.min(d.xmax[i], object[3]) - Math.max(d.xmin[i], object[1]);
+                float inter = Math.max(h, 0f) * Math.max(w, 0f);
+                float union = (d.ymax[i] - d.ymin[i]) * (d.xmax[i] - d.xmin[i])
+                        + (object[4] - object[2]) * (object[3] - object[1]) - inter;
+                if (inter / union >= MATCH_IOU) {
+                    result.found++;
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -13,6 +13,7 @@ import android.graphics.Paint;
 import android.graphics.PixelFormat;
 import android.graphics.Point;
 import android.graphics.PorterDuff;
+import android.graphics.Rect;
 import android.graphics.RectF;
 import android.graphics.SurfaceTexture;
 import android.hardware.camera2.CameraAccessException;
@@ -90,6 +91,25 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
     private Bitmap last;
     private ImageView lastview;
     private float lastid;
+    private static final int DETECTIONS = ImageClassifierQuantizedMobileNet.DETECTIONS;
+    private static final float MIN_SCORE = 0.5f;
+    private static final float NMS_IOU = 0.6f;
+    private static final int PRE_NMS_TOP_K = 100;
+    private static final int DETECTOR_SIZE = 300; //detector input resolution
+    //tiled detection for small objects, preview square is split into overlapping tiles
+    private static final boolean TILED_DETECTION = false;
+    private static final int TILE_SIZE = 540; //preview pixels
+    private static final float TILE_OVERLAP = 0.25f;
+    private static final int TILE_WORKERS = 2;
+    private static final int MAX_TILES = 16;
+    private final DetectionFilter detections = new DetectionFilter(DETECTIONS * MAX_TILES);
+    private TiledDetector tiled;
+    private final RoiPredictor predictor = new RoiPredictor();
+    //siamese tower, embeddings of all candidates are computed in one batch
+    private static final float MAX_DIFFERENCE = 0.2f;
+    private EmbeddingModel embedder;
+    private float[] lastEmbedding;
+    private static int modelLoads = 0; //since the process started, models come from ModelPack when present
 
     static {
         DEFAULT_ORIENTATIONS.append(Surface.ROTATION_0, 90);
@@ -203,9 +223,18 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             classifier.close();
             classifier = null;
         }
+        if (tiled != null){
+            tiled.close();
+            tiled = null;
+        }
+        if (embedder != null){
+            embedder.close();
+            embedder = null;
+        }
 
         Log.i("INFO", "applying model...");
         backgroundHandler.post(() -> {
+            long loadStart = SystemClock.uptimeMillis();
 
             try { //loading model
                 classifier = new ImageClassifierQuantizedMobileNet(getActivity());
@@ -219,6 +248,25 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             }
 
             classifier.setNumThreads(4); // from 1 to 10, number of threads
+
+            if (TILED_DETECTION) {
+                try {
+                    tiled = new TiledDetector(getActivity(), TILE_SIZE, TILE_OVERLAP, TILE_WORKERS, 2);
+                } catch (IOException e) {
+                    Log.e("ERR", "cant load tiled detector");
+                    tiled = null;
+                }
+            }
+
+            try {
+                embedder = new EmbeddingModel(getActivity());
+            } catch (IOException e) {
+                Log.e("ERR", "cant load embedding model, tracking wont match objects");
+                embedder = null;
+            }
+            //first load after start maps cold pages, later ones reuse the mapping
+            Log.i("INFO", "models loaded in " + (SystemClock.uptimeMillis() - loadStart) + "ms ("
+                    + (modelLoads++ == 0 ? "cold" : "warm") + ")");
         });
 
         synchronized (lock){
@@ -226,9 +274,50 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
         }
     }
 
-    private float bitmapSim(Bitmap tocompare){
-        getActivity().runOnUiThread(() -> lastview.setImageBitmap(tocompare));
-        return 1;
+    //part of the detector input with the i-th detection
+    private Bitmap cropDetection(Bitmap scaled, int i){
+        int x = (int)(detections.xmin[i] * DETECTOR_SIZE);
+        if (x < 0) {x =0;}
+        if (x > DETECTOR_SIZE-1) {x=DETECTOR_SIZE-1;}
+        int y = (int)(detections.ymin[i] * DETECTOR_SIZE);
+        if (y<0) {y=0;}
+        if (y > DETECTOR_SIZE-1) {y=DETECTOR_SIZE-1;}
+        int width = (int)(detections.xmax[i] * DETECTOR_SIZE) - x;
+        if (width+x>DETECTOR_SIZE) {width=DETECTOR_SIZE-x;}
+        if (width < 1) {width=1;}
+        int height = (int)(detections.ymax[i] * DETECTOR_SIZE) - y;
+        if (height+y>DETECTOR_SIZE) {height=DETECTOR_SIZE-y;}
+        if (height < 1) {height=1;}
+        return Bitmap.createBitmap(scaled, x, y, width, height);
+    }
+
+    //embeds up to MAX_BATCH candidates in one inference, returns index of the most similar one or -1
+    private int matchCandidates(Bitmap scaled){
+        if (embedder == null || lastEmbedding == null){
+            return -1;
+        }
+        int n = Math.min(detections.count, EmbeddingModel.MAX_BATCH);
+        if (n == 0){
+            return -1;
+        }
+        for (int c = 0; c < n; c++){
+            Bitmap tocompare = cropDetection(scaled, c);
+            embedder.put(c, tocompare);
+            if (tocompare != scaled){
+                tocompare.recycle();
+            }
+        }
+        float[][] embeddings = embedder.run(n);
+        int best = -1;
+        float bestDifference = MAX_DIFFERENCE;
+        for (int c = 0; c < n; c++){
+            float difference = 1 - embedder.similarity(lastEmbedding, embeddings[c]);
+            if (difference < bestDifference){ //if the difference is smaller than 20%
+                bestDifference = difference;
+                best = c;
+            }
+        }
+        return best;
     }
 
     private void classifyFrame() {
@@ -236,25 +325,43 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             return;
         }
         long startTime = SystemClock.uptimeMillis(), endTime;
-        Bitmap resized = Bitmap.createBitmap(textureView.getBitmap(), 0, (textureView.getHeight()-textureView.getWidth())/2, textureView.getWidth(), textureView.getWidth());
-        Bitmap scaled = Bitmap.createScaledBitmap(resized, 300, 300, false);
-
-        classifier.classifyFrame(scaled);
-
-        float[][] boxes = new float[10][4];
-        float[] scores = new float[10];
-        float[] classes = new float[10];
+        int offset = (textureView.getHeight() - textureView.getWidth()) / 2;
+        Bitmap frame = textureView.getBitmap();
+        Bitmap resized = null, scaled;
+        //detector boxes are relative to its input, this is where the input lies in the preview
+        int originX, originY, side;
+        //in tracking state the detector looks only around the predicted position, without downscaling
+        boolean roiMode = clicked.x == -2 && predictor.useRoi()
+                && frame.getWidth() >= DETECTOR_SIZE && frame.getHeight() >= DETECTOR_SIZE;
+        if (roiMode) {
+            Rect roi = predictor.roi(frame.getWidth(), frame.getHeight(), DETECTOR_SIZE);
+            scaled = Bitmap.createBitmap(frame, roi.left, roi.top, DETECTOR_SIZE, DETECTOR_SIZE);
+            originX = roi.left;
+            originY = roi.top;
+            side = DETECTOR_SIZE;
+        } else {
+            resized = Bitmap.createBitmap(frame, 0, offset, textureView.getWidth(), textureView.getWidth());
+            scaled = Bitmap.createScaledBitmap(resized, DETECTOR_SIZE, DETECTOR_SIZE, false);
+            originX = 0;
+            originY = offset;
+            side = textureView.getWidth();
+        }
 
-        for(int i=0; i<10; i++) {
-            System.arraycopy(classifier.getBoxes()[i], 0, boxes[i], 0, 4);
+        //in tracking state only objects of the saved category are interesting
+        int wanted = clicked.x == -2 ? (int) lastid : DetectionFilter.ANY_CLASS;
+        if (tiled != null && !roiMode) {
+            tiled.detect(frame, originX, originY, side, MIN_SCORE, wanted, detections);
+        } else {
+            classifier.classifyFrame(scaled);
+            detections.load(classifier.getBoxes(), classifier.getScores(), classifier.getClasses(), DETECTIONS, MIN_SCORE, wanted);
         }
-        System.arraycopy(classifier.getClasses(), 0, classes, 0, 10);
-        System.arraycopy(classifier.getScores(), 0, scores, 0, 10);
+        detections.topK(PRE_NMS_TOP_K);
+        detections.nms(NMS_IOU, DETECTIONS);
+        float[] ymin = detections.ymin, xmin = detections.xmin, ymax = detections.ymax, xmax = detections.xmax;
 
         //Get the results and now: if clicked is set to (-1, -1) then normally show all objects
         //if is set to some kind of value then it means user clicked on object and we need to now on what he/she clicked and then set point to (-2,-2)
         //(-2, -2) means tracking state
-        int offset = (textureView.getHeight() - textureView.getWidth()) / 2;
         Paint paintt = new Paint();
         paintt.setColor(Color.BLUE);
         paintt.setTextSize(36);
@@ -270,10 +377,8 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
 
                     canvas1.drawColor(Color.TRANSPARENT, PorterDuff.Mode.CLEAR);
                     canvas1.drawColor(Color.TRANSPARENT);
-                    int i = 0;
-                    while (i < 10 && scores[i] >= 0.5){
-                        canvas1.drawRect(boxes[i][1] * canvas1.getWidth(), (boxes[i][0] * canvas1.getWidth()) + offset, boxes[i][3] * canvas1.getWidth(), (boxes[i][2] * canvas1.getWidth()) + offset, paint);
-                        i++;
+                    for (int i = 0; i < detections.count; i++){
+                        canvas1.drawRect(xmin[i] * canvas1.getWidth(), (ymin[i] * canvas1.getWidth()) + offset, xmax[i] * canvas1.getWidth(), (ymax[i] * canvas1.getWidth()) + offset, paint);
                     }
                     //drawing of speed
                     endTime = SystemClock.uptimeMillis();
@@ -283,34 +388,16 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             }
 
         } else if (clicked.x == -2){
-            int i = 0;
-            boolean matching = false;
-            while (i < 10 && scores[i] >= 0.5){
-                if(classes[i] != lastid){
-                    i++;
-                    continue;
-                }
-                int x = (int)(boxes[i][1] * 300);
-                if (x < 0) {x =0;}
-                int y = (int)(boxes[i][0] * 300);
-                if (y<0) {y=0;}
-                int width = (int)(boxes[i][3] * 300) - x;
-                if (width+x>300) {width=300-x;}
-                int height = (int)(boxes[i][2] * 300) - y;
-                if (height+y>300) {height=300-y;}
-
-                Bitmap tocompare = Bitmap.createBitmap(scaled, x, y, width, height);
-                if (bitmapSim(tocompare) < 0.2){ //if the difference is smaller than 20%
-                    matching = true;
-                    break;
-                }
-                i++;
-            }
+            int i = matchCandidates(scaled);
+            boolean matching = i >= 0;
             if (matching){
                 Log.d("INFO", "znaleziono podobny obiekt!"); //now we need to draw shape around it
+                predictor.update(true, originX + (xmin[i] + xmax[i]) / 2 * side, originY + (ymin[i] + ymax[i]) / 2 * side);
             } else {
                 Log.d("INFO", "nie znaleziono podobnego obiektu");
+                predictor.update(false, 0, 0);
             }
+            predictor.record(roiMode, matching, SystemClock.uptimeMillis() - startTime);
 
         } else { //we need to find on what object user clicked and add it to compare base
             boolean found = false;
@@ -319,38 +406,39 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
                 if (canvas1 != null) {
                     canvas1.drawColor(Color.TRANSPARENT, PorterDuff.Mode.CLEAR);
                     canvas1.drawColor(Color.TRANSPARENT);
-                    float ymax=0, ymin=0, xmax=0, xmin=0;
+                    float bymax=0, bymin=0, bxmax=0, bxmin=0;
                     int i=0;
-                    while (i < 10 && scores[i] >= 0.5){
-                        xmin = boxes[i][1] * canvas1.getWidth();
-                        xmax = boxes[i][3] * canvas1.getWidth();
-                        ymin = (boxes[i][0] * canvas1.getWidth()) + offset;
-                        ymax = (boxes[i][2] * canvas1.getWidth()) + offset;
+                    while (i < detections.count){
+                        bxmin = xmin[i] * canvas1.getWidth();
+                        bxmax = xmax[i] * canvas1.getWidth();
+                        bymin = (ymin[i] * canvas1.getWidth()) + offset;
+                        bymax = (ymax[i] * canvas1.getWidth()) + offset;
 
-                        if(clicked.x >= xmin && clicked.x <= xmax && clicked.y >= ymin && clicked.y <= ymax){
+                        if(clicked.x >= bxmin && clicked.x <= bxmax && clicked.y >= bymin && clicked.y <= bymax){
                             found = true;
                             break;
                         }
                         i++;
                     }
                     if (found){ //if we found this object then we need to draw and remember what it is
-                        Log.d("INFO", "found object id: " + Float.toString(classes[i]+1));
-                        lastid = classes[i];
+                        Log.d("INFO", "found object id: " + Integer.toString(detections.classes[i]+1));
+                        lastid = detections.classes[i];
 
                         Paint paint = new Paint();
                         paint.setStyle(Paint.Style.STROKE);
                         paint.setColor(Color.RED);
-                        canvas1.drawRect(xmin, ymin, xmax, ymax, paint);
-
-                        int x = (int)(boxes[i][1] * 300);
-                        if (x < 0) {x =0;}
-                        int y = (int)(boxes[i][0] * 300);
-                        if (y<0) {y=0;}
-                        int width = (int)(boxes[i][3] * 300) - x;
-                        if (width+x>300) {width=300-x;}
-                        int height = (int)(boxes[i][2] * 300) - y;
-                        if (height+y>300) {height=300-y;}
-                        last = Bitmap.createBitmap(scaled, x, y, width, height); //saving the look of saved object
+                        canvas1.drawRect(bxmin, bymin, bxmax, bymax, paint);
+
+                        last = cropDetection(scaled, i); //saving the look of saved object
+                        if (last == scaled) {
+                            last = scaled.copy(scaled.getConfig(), false);
+                        }
+                        lastEmbedding = null;
+                        if (embedder != null) {
+                            embedder.put(0, last);
+                            lastEmbedding = embedder.run(1)[0].clone();
+                        }
+                        predictor.reset(originX + (xmin[i] + xmax[i]) / 2 * side, originY + (ymin[i] + ymax[i]) / 2 * side);
 
                         getActivity().runOnUiThread(() -> lastview.setImageBitmap(last));
                         clicked.x = -2;
@@ -368,8 +456,11 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             }
         }
 
-        resized.recycle();
+        if (resized != null) {
+            resized.recycle();
+        }
         scaled.recycle();
+        frame.recycle();
     }
 
     private Runnable periodicClassify = new Runnable() {
@@ -605,6 +696,8 @@ public class Camera2BasicFragment extends Fragment implements ActivityCompat.OnR
             case R.id.reset: {
                 clicked.x = -1;
                 clicked.y = -1;
+                predictor.clear();
+                lastEmbedding = null;
                 break;
             }
         }
@@ -0,0 +1,195 @@
+package com.example.finalappv2;
+
+//detector output post processing: score threshold, class filter, top-k and non maximum suppression
+//candidates are kept as separate arrays (structure of arrays) so IoU loops run over contiguous floats
+//all buffers are allocated once, nothing is created per frame
+public class DetectionFilter {
+
+    static final int ANY_CLASS = -1;
+
+    final float[] ymin, xmin, ymax, xmax, scores;
+    final int[] classes;
+    int count;
+
+    private final int capacity;
+    private final float[] area, iou;
+    private final boolean[] suppressed;
+    private final int[] order;
+    //second set of arrays for reordering candidates
+    private final float[] ymin2, xmin2, ymax2, xmax2, scores2;
+    private final int[] classes2;
+
+    DetectionFilter(int capacity) {
+        this.capacity = capacity;
+        ymin = new float[capacity];
+        xmin = new float[capacity];
+        ymax = new float[capacity];
+        xmax = new float[capacity];
+        scores = new float[capacity];
+        classes = new int[capacity];
+        ymin2 = new float[capacity];
+        xmin2 = new float[capacity];
+        ymax2 = new float[capacity];
+        xmax2 = new float[capacity];
+        scores2 = new float[capacity];
+        classes2 = new int[capacity];
+        area = new float[capacity];
+        iou = new float[capacity];
+        suppressed = new boolean[capacity];
+        order = new int[capacity];
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    //adds one candidate, box in the same [ymin, xmin, ymax, xmax] order as tflite output
+    boolean add(float y0, float x0, float y1, float x1, float score, int cls) {
+        if (count == capacity) {
+            return false;
+        }
+        ymin[count] = y0;
+        xmin[count] = x0;
+        ymax[count] = y1;
+        xmax[count] = x1;
+        scores[count] = score;
+        classes[count] = cls;
+        count++;
+        return true;
+    }
+
+    //copies detector output keeping candidates above minScore of the wanted class (or ANY_CLASS)
+    void load(float[][] boxes, float[] detScores, float[] detClasses, int n, float minScore, int wantedClass) {
+        clear();
+        append(boxes, detScores, detClasses, n, minScore, wantedClass, 0, 0, 1);
+    }
+
+    //like load but keeps current candidates, boxes of a tile placed at (offX, offY) with side size
+    //(all in 0..1 units of the whole area) are moved to area coordinates
+    void append(float[][] boxes, float[] detScores, float[] detClasses, int n, float minScore, int wantedClass,
+                float offX, float offY, float size) {
+        for (int i = 0; i < n; i++) {
+            if (detScores[i] < minScore) {
+                continue;
+            }
+            int cls = (int) detClasses[i];
+            if (wantedClass != ANY_CLASS && cls != wantedClass) {
+                continue;
+            }
+            add(offY + boxes[i][0] * size, offX + boxes[i][1] * size, offY + boxes[i][2] * size, offX + boxes[i][3] * size,
+                    detScores[i], cls);
+        }
+    }
+
+    //appends all candidates of another filter
+    void append(DetectionFilter other) {
+        for (int i = 0; i < other.count; i++) {
+            add(other.ymin[i], other.xmin[i], other.ymax[i], other.xmax[i], other.scores[i], other.classes[i]);
+        }
+    }
+
+    //keeps k best candidates sorted by score, partial selection instead of sorting everything
+    void topK(int k) {
+        if (k > count) {
+            k = count;
+        }
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        if (k < count) {
+            select(k);
+        }
+        sortByScore(k);
+        gather(k);
+    }
+
+    //greedy per class suppression, expects candidates sorted by score (call topK first)
+    void nms(float iouThreshold, int maxOut) {
+        int n = count;
+        for (int i = 0; i < n; i++) {
+            area[i] = (ymax[i] - ymin[i]) * (xmax[i] - xmin[i]);
+            suppressed[i] = false;
+        }
+        int kept = 0;
+        for (int i = 0; i < n && kept < maxOut; i++) {
+            if (suppressed[i]) {
+                continue;
+            }
+            order[kept++] = i;
+            final float ay0 = ymin[i], ax0 = xmin[i], ay1 = ymax[i], ax1 = xmax[i], aa = area[i];
+            //branch free loop, JIT can vectorize it
+            for (int j = i + 1; j < n; j++) {
+                float h = Math.min(ay1, ymax[j]) - Math.max(ay0, ymin[j]);
+                float w = Math.min(ax1, xmax[j]) - Math.max(ax0, xmin[j]);
+                float inter = Math.max(h, 0f) * Math.max(w, 0f);
+                iou[j] = inter / (aa + area[j] - inter + 1e-9f);
+            }
+            final int cls = classes[i];
+            for (int j = i + 1; j < n; j++) {
+                suppressed[j] |= iou[j] > iouThreshold && classes[j] == cls;
+            }
+        }
+        gather(kept);
+    }
+
+    //quickselect on order so the first k entries have the highest scores
+    private void select(int k) {
+        int lo = 0, hi = count - 1;
+        while (lo < hi) {
+            float pivot = scores[order[(lo + hi) >>> 1]];
+            int i = lo, j = hi;
+            while (i <= j) {
+                while (scores[order[i]] > pivot) i++;
+                while (scores[order[j]] < pivot) j--;
+                if (i <= j) {
+                    int t = order[i];
+                    order[i] = order[j];
+                    order[j] = t;
+                    i++;
+                    j--;
+                }
+            }
+            if (k - 1 <= j) {
+                hi = j;
+            } else if (k - 1 >= i) {
+                lo = i;
+            } else {
+                break;
+            }
+        }
+    }
+
+    //insertion sort of the first k entries, k is small
+    private void sortByScore(int k) {
+        for (int i = 1; i < k; i++) {
+            int idx = order[i];
+            float s = scores[idx];
+            int j = i - 1;
+            while (j >= 0 && scores[order[j]] < s) {
+                order[j + 1] = order[j];
+                j--;
+            }
+            order[j + 1] = idx;
+        }
+    }
+
+    //moves candidates listed in order[0..k) to the front of the arrays
+    private void gather(int k) {
+        for (int i = 0; i < k; i++) {
+            int idx = order[i];
+            ymin2[i] = ymin[idx];
+            xmin2[i] = xmin[idx];
+            ymax2[i] = ymax[idx];
+            xmax2[i] = xmax[idx];
+            scores2[i] = scores[idx];
+            classes2[i] = classes[idx];
+        }
+        System.arraycopy(ymin2, 0, ymin, 0, k);
+        System.arraycopy(xmin2, 0, xmin, 0, k);
+        System.arraycopy(ymax2, 0, ymax, 0, k);
+        System.arraycopy(xmax2, 0, xmax, 0, k);
+        System.arraycopy(scores2, 0, scores, 0, k);
+        System.arraycopy(classes2, 0, classes, 0, k);
+        count = k;
+    }
+}
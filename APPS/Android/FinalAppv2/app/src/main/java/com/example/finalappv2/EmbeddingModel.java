@@ -0,0 +1,183 @@
+package com.example.finalappv2;
+
+import android.app.Activity;
+import android.content.res.AssetFileDescriptor;
+import android.graphics.Bitmap;
+import android.os.SystemClock;
+import android.util.Log;
+
+import org.tensorflow.lite.Interpreter;
+
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.nio.channels.FileChannel;
+
+//one tower of the siamese net from ML/my_net.py (exported by ML/export.py) used to compare objects
+//all candidate crops of a frame are put into one preallocated batch tensor and inferred together
+//one interpreter per batch bucket (1, 2, 4, 8) is sized at load time, a batch runs in the smallest bucket
+//that holds it so the tensors are never reallocated, unused slots keep old crops and their rows are ignored
+public class EmbeddingModel {
+
+    static final int SIZE = 224; //tower input
+    static final int DIM = 1280; //embedding length
+    static final int MAX_BATCH = 8;
+    private static final int IMAGE_FLOATS = SIZE * SIZE * 3;
+    private static final int STATS_RUNS = 50; //how often throughput per batch size is logged
+
+    private static final int[] BUCKETS = {1, 2, 4, MAX_BATCH};
+
+    //interpreters share the mapped model, each holds the tensors of its batch size
+    private final Interpreter[] towers = new Interpreter[BUCKETS.length];
+    private final ByteBuffer batch;
+    private final FloatBuffer batchFloats;
+    //views of the batch buffer and outputs for every bucket, no allocation per frame
+    private final ByteBuffer[] inputs = new ByteBuffer[BUCKETS.length];
+    private final float[][][] outputs = new float[BUCKETS.length][][];
+    private final float[] headWeights = new float[DIM];
+    private float headBias;
+    private int[] pixels = new int[SIZE * SIZE];
+
+    private final int[] statRuns = new int[MAX_BATCH + 1];
+    private final long[] statMs = new long[MAX_BATCH + 1];
+    private int runs = 0;
+
+    EmbeddingModel(Activity activity) throws IOException {
+        ByteBuffer tower = loadTower(activity);
+        loadHead(activity, "siamese_head.bin");
+        batch = ByteBuffer.allocateDirect(MAX_BATCH * IMAGE_FLOATS * 4);
+        batch.order(ByteOrder.nativeOrder());
+        batchFloats = batch.asFloatBuffer();
+        for (int b = 0; b < BUCKETS.length; b++) {
+            int n = BUCKETS[b];
+            towers[b] = new Interpreter(tower);
+            towers[b].resizeInput(0, new int[]{n, SIZE, SIZE, 3});
+            ByteBuffer view = batch.duplicate();
+            view.limit(n * IMAGE_FLOATS * 4);
+            inputs[b] = view.slice().order(ByteOrder.nativeOrder());
+            outputs[b] = new float[n][DIM];
+        }
+        Log.i("INFO", "loaded embedding model...");
+    }
+
+    //int8 tower from ML/quantize.py is shipped only when it passed the accuracy check, otherwise fp32
+    private ByteBuffer loadTower(Activity activity) throws IOException {
+        try {
+            ByteBuffer model = loadModelFile(activity, "siamese_tower_int8.tflite");
+            Log.i("INFO", "using int8 embedding model");
+            return model;
+        } catch (IOException e) {
+            Log.i("INFO", "no int8 embedding model, using fp32");
+            return loadModelFile(activity, "siamese_tower.tflite");
+        }
+    }
+
+    private ByteBuffer loadModelFile(Activity activity, String path) throws IOException {
+        ByteBuffer packed = ModelPack.get(activity, path);
+        if (packed != null) {
+            return packed;
+        }
+        AssetFileDescriptor fileDescriptor = activity.getAssets().openFd(path);
+        FileInputStream inputStream = new FileInputStream(fileDescriptor.getFileDescriptor());
+        FileChannel fileChannel = inputStream.getChannel();
+        long startOffset = fileDescriptor.getStartOffset();
+        long declaredLength = fileDescriptor.getDeclaredLength();
+        return fileChannel.map(FileChannel.MapMode.READ_ONLY, startOffset, declaredLength);
+    }
+
+    //dense layer on |a - b|, raw little endian floats: DIM weights and bias
+    private void loadHead(Activity activity, String path) throws IOException {
+        ByteBuffer packed = ModelPack.get(activity, path);
+        if (packed != null && packed.capacity() == (DIM + 1) * 4) {
+            FloatBuffer floats = packed.order(ByteOrder.LITTLE_ENDIAN).asFloatBuffer();
+            floats.get(headWeights);
+            headBias = floats.get();
+            return;
+        }
+        byte[] raw = new byte[(DIM + 1) * 4];
+        try (InputStream stream = activity.getAssets().open(path)) {
+            int read = 0;
+            while (read < raw.length) {
+                int n = stream.read(raw, read, raw.length - read);
+                if (n < 0) {
+                    throw new IOException("head weights too short");
+                }
+                read += n;
+            }
+        }
+        FloatBuffer floats = ByteBuffer.wrap(raw).order(ByteOrder.LITTLE_ENDIAN).asFloatBuffer();
+        floats.get(headWeights);
+        headBias = floats.get();
+    }
+
+    //resizes crop into slot of the batch tensor (nearest neighbour) and normalizes it like my_net.py:
+    //(2/255)*x - 1, channel order BGR because the net was trained on cv2.imread images
+    void put(int slot, Bitmap crop) {
+        if (NativePreprocess.available
+                && NativePreprocess.toFloat(crop, batch, slot * IMAGE_FLOATS, SIZE, SIZE, 2f / 255f, -1f, true)) {
+            return;
+        }
+        int w = crop.getWidth(), h = crop.getHeight();
+        if (pixels.length < w * h) {
+            pixels = new int[w * h];
+        }
+        crop.getPixels(pixels, 0, w, 0, 0, w, h);
+        int pos = slot * IMAGE_FLOATS;
+        for (int y = 0; y < SIZE; y++) {
+            int row = (y * h / SIZE) * w;
+            for (int x = 0; x < SIZE; x++) {
+                int val = pixels[row + x * w / SIZE];
+                batchFloats.put(pos++, (val & 0xFF) * (2f / 255f) - 1f);
+                batchFloats.put(pos++, ((val >> 8) & 0xFF) * (2f / 255f) - 1f);
+                batchFloats.put(pos++, ((val >> 16) & 0xFF) * (2f / 255f) - 1f);
+            }
+        }
+    }
+
+    //one inference for crops in slots 0..count-1, rows from count on belong to old crops,
+    //returned rows are reused by the next run
+    float[][] run(int count) {
+        long start = SystemClock.uptimeMillis();
+        int b = 0;
+        while (BUCKETS[b] < count) {
+            b++;
+        }
+        inputs[b].rewind();
+        towers[b].run(inputs[b], outputs[b]);
+
+        statRuns[count]++;
+        statMs[count] += SystemClock.uptimeMillis() - start;
+        if (++runs == STATS_RUNS) {
+            StringBuilder log = new StringBuilder("embedding throughput:");
+            for (int n = 1; n <= MAX_BATCH; n++) {
+                if (statRuns[n] > 0) {
+                    log.append(" batch ").append(n).append(": ")
+                            .append((float) statMs[n] / (statRuns[n] * n)).append("ms/crop");
+                }
+                statRuns[n] = 0;
+                statMs[n] = 0;
+            }
+            Log.d("INFO", log.toString());
+            runs = 0;
+        }
+        return outputs[b];
+    }
+
+    //probability that both embeddings show the same object, siamese head of my_net.py
+    float similarity(float[] a, float[] b) {
+        float sum = headBias;
+        for (int i = 0; i < DIM; i++) {
+            sum += headWeights[i] * Math.abs(a[i] - b[i]);
+        }
+        return (float) (1 / (1 + Math.exp(-sum)));
+    }
+
+    public void close() {
+        for (Interpreter tower : towers) {
+            tower.close();
+        }
+    }
+}
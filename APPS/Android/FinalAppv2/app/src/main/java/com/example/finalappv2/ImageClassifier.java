@@ -1,6 +1,6 @@
 package com.example.finalappv2;
 
-import android.app.Activity;
+import android.content.Context;
 import android.content.res.AssetFileDescriptor;
 import android.graphics.Bitmap;
 import android.util.Log;
@@ -21,9 +21,12 @@ public abstract class ImageClassifier {
     private static final int DIM_PIXEL_SIZE = 3;
     private int[] intValues = new int[getImageSizeX() * getImageSizeY()];
     private final Interpreter.Options tfliteOptions = new Interpreter.Options();
+    private static final int STATS_FRAMES = 100; //how often preprocessing time is logged
+    private int frames = 0;
+    private long preprocessNs = 0;
 
-    ImageClassifier(Activity activity) throws IOException {
-        tfliteModel = loadModelFile(activity);
+    ImageClassifier(Context context) throws IOException {
+        tfliteModel = loadModelFile(context);
         Log.i("INFO", "loaded model...");
         tflite = new Interpreter(tfliteModel, tfliteOptions);
         imgData =
@@ -38,8 +41,12 @@ public abstract class ImageClassifier {
 
     }
 
-    private ByteBuffer loadModelFile(Activity activity) throws IOException {
-        AssetFileDescriptor fileDescriptor = activity.getAssets().openFd(getModelPath());
+    private ByteBuffer loadModelFile(Context context) throws IOException {
+        ByteBuffer packed = ModelPack.get(context, getModelPath());
+        if (packed != null) {
+            return packed;
+        }
+        AssetFileDescriptor fileDescriptor = context.getAssets().openFd(getModelPath());
         FileInputStream inputStream = new FileInputStream(fileDescriptor.getFileDescriptor());
         FileChannel fileChannel = inputStream.getChannel();
         long startOffset = fileDescriptor.getStartOffset();
@@ -52,6 +59,9 @@ public abstract class ImageClassifier {
             return;
         }
         imgData.rewind();
+        if (convertNative(bitmap)) {
+            return;
+        }
         bitmap.getPixels(intValues, 0, bitmap.getWidth(), 0, 0, bitmap.getWidth() ,bitmap.getHeight());
         int pixel = 0;
         for (int i = 0; i < getImageSizeX(); ++i) {
@@ -67,7 +77,14 @@ public abstract class ImageClassifier {
             Log.e("ERR", "Image classifier has not been initialized; Skipped.");
             return;
         }
+        long start = System.nanoTime();
         convertBitmapToByteBuffer(bitmap);
+        preprocessNs += System.nanoTime() - start;
+        if (++frames == STATS_FRAMES) {
+            Log.d("INFO", "preprocessing: " + (preprocessNs / frames / 1000) + "us per frame");
+            frames = 0;
+            preprocessNs = 0;
+        }
         runInference();
     }
 
@@ -89,6 +106,11 @@ public abstract class ImageClassifier {
         tfliteModel = null;
     }
 
+    //fills imgData in native code, false when java conversion with addPixelValue is needed
+    protected boolean convertNative(Bitmap bitmap) {
+        return false;
+    }
+
     protected abstract String getModelPath();
     protected abstract int getImageSizeX();
     protected abstract int getImageSizeY();
@@ -1,20 +1,22 @@
 package com.example.finalappv2;
 
-import android.app.Activity;
+import android.content.Context;
+import android.graphics.Bitmap;
 
 import java.io.IOException;
 import java.util.Map;
 import java.util.TreeMap;
 
 public class ImageClassifierQuantizedMobileNet extends ImageClassifier {
-    private float[][][] boxes = new float[1][10][4];
-    private float[][] scores = new float[1][10];
-    private float[][] classes = new float[1][10];
+    static final int DETECTIONS = 10; //boxes returned by the detector
+    private float[][][] boxes = new float[1][DETECTIONS][4];
+    private float[][] scores = new float[1][DETECTIONS];
+    private float[][] classes = new float[1][DETECTIONS];
     private Map<Integer, Object> output_map = new TreeMap<>();
     private Object[] input_data = new Object[1];;
 
-    ImageClassifierQuantizedMobileNet(Activity activity) throws IOException {
-        super(activity);
+    ImageClassifierQuantizedMobileNet(Context context) throws IOException {
+        super(context);
         output_map.put(0, boxes);
         output_map.put(1, classes);
         output_map.put(2, scores);
@@ -39,6 +41,11 @@ public class ImageClassifierQuantizedMobileNet extends ImageClassifier {
         return 1;
     }
 
+    @Override
+    protected boolean convertNative(Bitmap bitmap) {
+        return NativePreprocess.available && NativePreprocess.toRgb(bitmap, imgData, getImageSizeX(), getImageSizeY());
+    }
+
     @Override
     protected void addPixelValue(int pixelValue) {
         imgData.put((byte) ((pixelValue >> 16) & 0xFF));
@@ -0,0 +1,124 @@
+package com.example.finalappv2;
+
+import android.content.Context;
+import android.content.pm.PackageManager;
+import android.util.Log;
+
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.util.HashMap;
+import java.util.Map;
+
+//blob with all models made by ML/pack.py, mapped once per process
+//interpreters get read only slices of the mapping, so nothing is parsed or copied and every
+//interpreter (tiled workers too) shares the same physical pages, only the entry table is read at startup
+//zipalign puts assets at 4 byte offsets of the apk only, so the pack is copied out once per install
+//and mapped from offset 0 of that file, which keeps the models page aligned as pack.py lays them out
+public class ModelPack {
+
+    private static final String PATH = "models.bin";
+    private static final int MAGIC = 0x424D544F; //'OTMB' little endian
+    private static final int VERSION = 1;
+    private static final int NAME_SIZE = 48;
+
+    private static boolean opened = false;
+    private static MappedByteBuffer mapping;
+    private static final Map<String, long[]> entries = new HashMap<>(); //name -> offset, size
+
+    private static synchronized boolean open(Context context) {
+        if (opened) {
+            return mapping != null;
+        }
+        opened = true;
+        try (FileInputStream inputStream = new FileInputStream(extract(context))) {
+            FileChannel fileChannel = inputStream.getChannel();
+            //the mapping stays valid after the file is closed
+            MappedByteBuffer map = fileChannel.map(FileChannel.MapMode.READ_ONLY, 0, fileChannel.size());
+            map.order(ByteOrder.LITTLE_ENDIAN);
+            if (map.getInt(0) != MAGIC || map.getInt(4) != VERSION) {
+                Log.e("ERR", "wrong model pack header");
+                return false;
+            }
+            int count = map.getInt(8);
+            byte[] name = new byte[NAME_SIZE];
+            for (int i = 0; i < count; i++) {
+                int pos = 16 + i * (NAME_SIZE + 16);
+                map.position(pos);
+                map.get(name);
+                int length = 0;
+                while (length < NAME_SIZE && name[length] != 0) {
+                    length++;
+                }
+                long offset = map.getLong(pos + NAME_SIZE), size = map.getLong(pos + NAME_SIZE + 8);
+                if (offset + size > map.capacity()) {
+                    Log.e("ERR", "model pack entry out of file");
+                    return false;
+                }
+                entries.put(new String(name, 0, length, "US-ASCII"), new long[]{offset, size});
+            }
+            mapping = map;
+            Log.i("INFO", "mapped model pack, " + count + " models");
+        } catch (IOException e) {
+            Log.i("INFO", "no model pack, models are mapped one by one");
+        }
+        return mapping != null;
+    }
+
+    //copy of the asset made for the installed apk, the ones of older installs are deleted
+    private static File extract(Context context) throws IOException {
+        long installed;
+        try {
+            installed = context.getPackageManager().getPackageInfo(context.getPackageName(), 0).lastUpdateTime;
+        } catch (PackageManager.NameNotFoundException e) {
+            throw new IOException(e);
+        }
+        File dir = context.getNoBackupFilesDir();
+        File file = new File(dir, "models-" + installed + ".bin");
+        if (file.exists()) {
+            return file;
+        }
+        File[] old = dir.listFiles((d, name) -> name.startsWith("models-") && name.endsWith(".bin"));
+        if (old != null) {
+            for (File f : old) {
+                f.delete();
+            }
+        }
+        //written under another name first, a killed copy is never mapped
+        File part = new File(dir, "models.part");
+        try (InputStream in = context.getAssets().open(PATH); FileOutputStream out = new FileOutputStream(part)) {
+            byte[] buffer = new byte[1 << 16];
+            int n;
+            while ((n = in.read(buffer)) > 0) {
+                out.write(buffer, 0, n);
+            }
+            out.getFD().sync();
+        }
+        if (!part.renameTo(file)) {
+            throw new IOException("cant rename " + part);
+        }
+        Log.i("INFO", "model pack copied out of the apk, " + file.length() + " bytes");
+        return file;
+    }
+
+    //read only view of one model or null when there is no pack or the model is not in it
+    static synchronized ByteBuffer get(Context context, String name) {
+        if (!open(context)) {
+            return null;
+        }
+        long[] entry = entries.get(name);
+        if (entry == null) {
+            return null;
+        }
+        ByteBuffer view = mapping.duplicate();
+        view.position((int) entry[0]);
+        view.limit((int) (entry[0] + entry[1]));
+        return view.slice().order(ByteOrder.nativeOrder());
+    }
+}
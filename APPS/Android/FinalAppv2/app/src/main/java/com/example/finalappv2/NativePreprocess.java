@@ -0,0 +1,33 @@
+package com.example.finalappv2;
+
+import android.graphics.Bitmap;
+import android.util.Log;
+
+import java.nio.ByteBuffer;
+
+//bitmap to input tensor conversion in the shared C++ library (APPS/Native/preprocess)
+//pixels are read straight from the bitmap memory and written to the direct buffer, resize included
+//when the library is missing or the bitmap is not ARGB_8888 callers use their java loops
+public class NativePreprocess {
+
+    static final boolean available;
+
+    static {
+        boolean loaded;
+        try {
+            System.loadLibrary("nativepreprocess");
+            loaded = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e("ERR", "native preprocessing not available, using java");
+            loaded = false;
+        }
+        available = loaded;
+    }
+
+    //uint8 RGB, width * height * 3 bytes from the start of buffer
+    static native boolean toRgb(Bitmap bitmap, ByteBuffer buffer, int width, int height);
+
+    //scale * value + shift floats from offset (in floats), BGR order when bgr is set
+    static native boolean toFloat(Bitmap bitmap, ByteBuffer buffer, int offset, int width, int height,
+                                  float scale, float shift, boolean bgr);
+}
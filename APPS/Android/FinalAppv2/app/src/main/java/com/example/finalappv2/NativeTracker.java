@@ -0,0 +1,79 @@
+package com.example.finalappv2;
+
+import android.graphics.Bitmap;
+import android.os.SystemClock;
+import android.util.Log;
+
+//the same tracking engine as in the iOS app (APPS/Native/tracking) through its C interface
+//built only when gradle gets OpenCV with the tracking module (-DOpenCV_DIR), otherwise available is false
+public class NativeTracker {
+
+    static final int ERROR = -1;
+    static final int LOST = 0;
+    static final int TRACKED = 1;
+
+    static final boolean available;
+
+    static {
+        boolean loaded;
+        try {
+            System.loadLibrary("nativetracking");
+            loaded = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.i("INFO", "native tracker not built");
+            loaded = false;
+        }
+        available = loaded;
+    }
+
+    private long handle;
+    private final float[] box = new float[4]; //x, y, width, height in frame pixels
+
+    NativeTracker(int width, int height) {
+        handle = create();
+        start(handle, width, height);
+    }
+
+    //frames are ARGB_8888 bitmaps of the size given in constructor
+    int init(Bitmap frame, float x, float y, float width, float height) {
+        return init(handle, frame, x, y, width, height);
+    }
+
+    int update(Bitmap frame) {
+        return update(handle, frame, box);
+    }
+
+    float[] getBox() {
+        return box;
+    }
+
+    //0 - left, 50 - center, 100 - right
+    int getPosition() {
+        return position(handle);
+    }
+
+    //gimbal rate setpoint after the last update, frame widths per second, positive is right
+    double getRate() {
+        return control(handle, SystemClock.uptimeMillis() / 1000.0);
+    }
+
+    void reset() {
+        reset(handle);
+    }
+
+    public void close() {
+        if (handle != 0) {
+            destroy(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long create();
+    private static native void destroy(long handle);
+    private static native int start(long handle, int width, int height);
+    private static native int init(long handle, Bitmap frame, float x, float y, float width, float height);
+    private static native int update(long handle, Bitmap frame, float[] out);
+    private static native void reset(long handle);
+    private static native int position(long handle);
+    private static native double control(long handle, double time);
+}
@@ -0,0 +1,108 @@
+package com.example.finalappv2;
+
+import android.graphics.Rect;
+import android.util.Log;
+
+//constant velocity prediction of the tracked object, used to run the detector only on a window
+//around the place where the object should be, at detector resolution (no downscaling)
+//after MAX_MISSES frames without a match the detector goes back to the full frame
+public class RoiPredictor {
+
+    private static final int MAX_MISSES = 3;
+    private static final float VELOCITY_ALPHA = 0.5f; //smoothing of the velocity estimate
+    private static final int STATS_FRAMES = 100; //how often comparison of both modes is logged
+
+    private boolean valid = false;
+    private float cx, cy; //predicted center in preview pixels
+    private float vx, vy; //pixels per frame
+    private int misses = 0;
+
+    private final Rect window = new Rect(); //returned by roi, one per predictor so detector frames allocate nothing
+    private final Stats roiStats = new Stats();
+    private final Stats fullStats = new Stats();
+
+    //object selected by user, start predicting from its center
+    void reset(float centerX, float centerY) {
+        cx = centerX;
+        cy = centerY;
+        vx = 0;
+        vy = 0;
+        misses = 0;
+        valid = true;
+    }
+
+    void clear() {
+        valid = false;
+    }
+
+    boolean useRoi() {
+        return valid && misses < MAX_MISSES;
+    }
+
+    //window of size x size pixels around the predicted center, kept inside the preview
+    //the same Rect is returned every time, it is valid until the next call
+    Rect roi(int frameWidth, int frameHeight, int size) {
+        int left = Math.round(cx + vx) - size / 2;
+        int top = Math.round(cy + vy) - size / 2;
+        left = Math.max(0, Math.min(left, frameWidth - size));
+        top = Math.max(0, Math.min(top, frameHeight - size));
+        window.set(left, top, left + size, top + size);
+        return window;
+    }
+
+    //result of one detection run, center in preview pixels when found
+    void update(boolean found, float centerX, float centerY) {
+        if (!valid) {
+            return;
+        }
+        if (found && misses >= MAX_MISSES) {
+            //found again by the full frame detector, the old velocity has nothing to do with this position
+            reset(centerX, centerY);
+        } else if (found) {
+            vx += VELOCITY_ALPHA * ((centerX - cx) - vx);
+            vy += VELOCITY_ALPHA * ((centerY - cy) - vy);
+            cx = centerX;
+            cy = centerY;
+            misses = 0;
+        } else if (misses < MAX_MISSES) {
+            //keep moving along the last velocity while the object is not visible
+            cx += vx;
+            cy += vy;
+            misses++;
+        }
+    }
+
+    //latency and recall of both modes so they can be compared in the log
+    void record(boolean roiMode, boolean found, long ms) {
+        Stats stats = roiMode ? roiStats : fullStats;
+        stats.frames++;
+        stats.ms += ms;
+        if (found) {
+            stats.found++;
+        }
+        if (roiStats.frames + fullStats.frames >= STATS_FRAMES) {
+            Log.d("INFO", "detection roi: " + roiStats + " | full: " + fullStats);
+            roiStats.clear();
+            fullStats.clear();
+        }
+    }
+
+    private static class Stats {
+        int frames, found;
+        long ms;
+
+        void clear() {
+            frames = 0;
+            found = 0;
+            ms = 0;
+        }
+
+        @Override
+        public String toString() {
+            if (frames == 0) {
+                return "-";
+            }
+            return frames + " frames, " + (ms / frames) + "ms, found " + (found * 100 / frames) + "%";
+        }
+    }
+}
@@ -0,0 +1,146 @@
+package com.example.finalappv2;
+
+import android.content.Context;
+import android.graphics.Bitmap;
+import android.os.SystemClock;
+import android.util.Log;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+
+//splits the square detection area into overlapping tiles so small (distant) objects are not lost
+//by downscaling the whole frame to 300x300, tiles are inferred in parallel, one interpreter per worker
+//(tflite interpreter is not thread safe), results are merged by cross tile NMS in DetectionFilter
+public class TiledDetector {
+
+    private static final int STATS_FRAMES = 100; //how often average time is logged
+    private static final long CLOSE_TIMEOUT_MS = 2000; //a frame of tiles takes a few hundred ms
+
+    private final int tileSize; //in preview pixels
+    private final float overlap; //part of tile shared with the neighbour, 0..1
+    private final ImageClassifier[] workers;
+    private final DetectionFilter[] results;
+    private final ExecutorService executor;
+    private final List<Future<?>> pending = new ArrayList<>();
+    private int[] tileX = new int[0], tileY = new int[0];
+    private int tiles = 0;
+    private int lastSide = -1;
+
+    private int frames = 0, found = 0;
+    private long ms = 0;
+
+    TiledDetector(Context context, int tileSize, float overlap, int workerCount, int threadsPerWorker) throws IOException {
+        this.tileSize = tileSize;
+        this.overlap = overlap;
+        workers = new ImageClassifier[workerCount];
+        results = new DetectionFilter[workerCount];
+        for (int i = 0; i < workerCount; i++) {
+            workers[i] = new ImageClassifierQuantizedMobileNet(context);
+            workers[i].setNumThreads(threadsPerWorker);
+        }
+        executor = Executors.newFixedThreadPool(workerCount);
+    }
+
+    //tile grid for a square area, last tile in a row is moved back so it ends at the border
+    private void layout(int side) {
+        if (side == lastSide) {
+            return;
+        }
+        lastSide = side;
+        int step = Math.max(1, Math.round(tileSize * (1 - overlap)));
+        int perAxis = side <= tileSize ? 1 : (side - tileSize + step - 1) / step + 1;
+        tiles = perAxis * perAxis;
+        tileX = new int[tiles];
+        tileY = new int[tiles];
+        int size = Math.min(tileSize, side);
+        for (int ty = 0; ty < perAxis; ty++) {
+            for (int tx = 0; tx < perAxis; tx++) {
+                int i = ty * perAxis + tx;
+                tileX[i] = Math.min(tx * step, side - size);
+                tileY[i] = Math.min(ty * step, side - size);
+            }
+        }
+        for (int w = 0; w < workers.length; w++) {
+            int perWorker = (tiles + workers.length - 1) / workers.length;
+            results[w] = new DetectionFilter(perWorker * ImageClassifierQuantizedMobileNet.DETECTIONS);
+        }
+        Log.i("INFO", "tiled detection: " + tiles + " tiles of " + size + "px for " + side + "px area");
+    }
+
+    //detects in the square side x side at (originX, originY) of frame, boxes in 0..1 units of that square
+    //candidates which do not fit into out are dropped
+    void detect(Bitmap frame, int originX, int originY, int side, float minScore, int wantedClass, DetectionFilter out) {
+        long start = SystemClock.uptimeMillis();
+        layout(side);
+        final int size = Math.min(tileSize, side);
+        final float unit = (float) size / side;
+        pending.clear();
+        for (int w = 0; w < workers.length; w++) {
+            final ImageClassifier worker = workers[w];
+            final DetectionFilter result = results[w];
+            final int first = w;
+            pending.add(executor.submit(() -> {
+                result.clear();
+                //every worker takes every n-th tile
+                for (int i = first; i < tiles; i += workers.length) {
+                    Bitmap tile = Bitmap.createBitmap(frame, originX + tileX[i], originY + tileY[i], size, size);
+                    Bitmap scaled = Bitmap.createScaledBitmap(tile, worker.getImageSizeX(), worker.getImageSizeY(), false);
+                    worker.classifyFrame(scaled);
+                    result.append(worker.getBoxes(), worker.getScores(), worker.getClasses(),
+                            ImageClassifierQuantizedMobileNet.DETECTIONS, minScore, wantedClass,
+                            (float) tileX[i] / side, (float) tileY[i] / side, unit);
+                    if (scaled != tile) {
+                        scaled.recycle();
+                    }
+                    tile.recycle();
+                }
+            }));
+        }
+        out.clear();
+        for (int w = 0; w < workers.length; w++) {
+            try {
+                pending.get(w).get();
+                out.append(results[w]);
+            } catch (InterruptedException | ExecutionException e) {
+                Log.e("ERR", "tile inference failed", e);
+            }
+        }
+
+        frames++;
+        found += out.count;
+        ms += SystemClock.uptimeMillis() - start;
+        if (frames == STATS_FRAMES) {
+            Log.d("INFO", "tiled detection: " + tiles + " tiles, " + (ms / frames) + "ms, " + ((float) found / frames) + " candidates per frame");
+            frames = 0;
+            found = 0;
+            ms = 0;
+        }
+    }
+
+    //interpreters are closed only after the last tile task is done, a running one would use a closed interpreter
+    public void close() {
+        executor.shutdown();
+        try {
+            if (!executor.awaitTermination(CLOSE_TIMEOUT_MS, TimeUnit.MILLISECONDS)) {
+                executor.shutdownNow();
+                if (!executor.awaitTermination(CLOSE_TIMEOUT_MS, TimeUnit.MILLISECONDS)) {
+                    Log.e("ERR", "tile inference did not stop, interpreters are left open");
+                    return;
+                }
+            }
+        } catch (InterruptedException e) {
+            Log.e("ERR", "interrupted while closing tiled detector, interpreters are left open");
+            Thread.currentThread().interrupt();
+            return;
+        }
+        for (ImageClassifier worker : workers) {
+            worker.close();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+package com.example.finalappv2;
+
+import org.junit.Test;
+
+import java.util.Random;
+
+import static org.junit.Assert.*;
+
+//top-k and NMS on a full tiled frame worth of candidates, timing is in DetectionFilterBenchmark (device)
+public class DetectionFilterTest {
+
+    private static final int CANDIDATES = 4096;
+    private static final int TOP_K = 100;
+    private static final int MAX_OUT = 10;
+    private static final float IOU = 0.6f;
+
+    private final float[] y0 = new float[CANDIDATES], x0 = new float[CANDIDATES];
+    private final float[] y1 = new float[CANDIDATES], x1 = new float[CANDIDATES];
+    private final float[] score = new float[CANDIDATES];
+    private final int[] cls = new int[CANDIDATES];
+
+    //candidates cluster around a few objects like detector output does
+    private DetectionFilter filled() {
+        Random random = new Random(7);
+        for (int i = 0; i < CANDIDATES; i++) {
+            float cy = (i % 23) / 23f, cx = (i % 17) / 17f, h = 0.05f + 0.1f * random.nextFloat();
+            y0[i] = cy + 0.01f * random.nextFloat();
+            x0[i] = cx + 0.01f * random.nextFloat();
+            y1[i] = y0[i] + h;
+            x1[i] = x0[i] + h;
+            score[i] = random.nextFloat();
+            cls[i] = random.nextInt(3);
+        }
+        return new DetectionFilter(CANDIDATES);
+    }
+
+    private void reload(DetectionFilter f) {
+        System.arraycopy(y0, 0, f.ymin, 0, CANDIDATES);
+        System.arraycopy(x0, 0, f.xmin, 0, CANDIDATES);
+        System.arraycopy(y1, 0, f.ymax, 0, CANDIDATES);
+        System.arraycopy(x1, 0, f.xmax, 0, CANDIDATES);
+        System.arraycopy(score, 0, f.scores, 0, CANDIDATES);
+        System.arraycopy(cls, 0, f.classes, 0, CANDIDATES);
+        f.count = CANDIDATES;
+    }
+
+    private static float iou(DetectionFilter f, int a, int b) {
+        float h = Math.min(f.ymax[a], f.ymax[b]) - Math.max(f.ymin[a], f.ymin[b]);
+        float w = Math.min(f.xmax[a], f.xmax[b]) - Math.max(f.xmin[a], f.xmin[b]);
+        float inter = Math.max(h, 0f) * Math.max(w, 0f);
+        float areaA = (f.ymax[a] - f.ymin[a]) * (f.xmax[a] - f.xmin[a]);
+        float areaB = (f.ymax[b] - f.ymin[b]) * (f.xmax[b] - f.xmin[b]);
+        return inter / (areaA + areaB - inter + 1e-9f);
+    }
+
+    @Test
+    public void topKKeepsBestSorted() {
+        DetectionFilter f = filled();
+        reload(f);
+        f.topK(TOP_K);
+        assertEquals(TOP_K, f.count);
+        float[] sorted = score.clone();
+        java.util.Arrays.sort(sorted);
+        for (int i = 0; i < TOP_K; i++) {
+            assertEquals(sorted[CANDIDATES - 1 - i], f.scores[i], 0f);
+        }
+    }
+
+    @Test
+    public void nmsLeavesNoOverlapInClass() {
+        DetectionFilter f = filled();
+        reload(f);
+        f.topK(TOP_K);
+        f.nms(IOU, MAX_OUT);
+        assertTrue(f.count > 0 && f.count <= MAX_OUT);
+        for (int i = 0; i < f.count; i++) {
+            for (int j = i + 1; j < f.count; j++) {
+                assertTrue(f.scores[i] >= f.scores[j]);
+                assertFalse(f.classes[i] == f.classes[j] && iou(f, i, j) > IOU);
+            }
+        }
+    }
+}
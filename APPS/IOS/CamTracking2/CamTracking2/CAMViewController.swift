@@ -14,6 +14,11 @@ import Photos
 //special characteristics for my Bluetooth device
 let BService = CBUUID(string: "0xFFE0")
 let BCharacteristic = CBUUID(string: "0xFFE1")
+//Gimbal Motion service of the EFR32 board (ELECTRONIC-BOARD gatt.xml), binary frames only
+let MService = CBUUID(string: "A7C30001-5E1B-4C8E-9F21-3B6D0E4A5C10")
+let MSetpoint = CBUUID(string: "A7C30002-5E1B-4C8E-9F21-3B6D0E4A5C10")
+//boards with the gains characteristic run the control loop themselves and take GP_TRACK frames
+let MGains = CBUUID(string: "A7C30005-5E1B-4C8E-9F21-3B6D0E4A5C10")
 
 class CAMViewController: UIViewController , CameraBufferDelegate {
     
@@ -42,6 +47,9 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
     
     //function sends simple message requesting baterry information
     @objc func update() {
+        if binary || devicechara == nil {
+            return
+        }
         device?.writeValue("p".data(using: .utf8)!, for: devicechara!, type: CBCharacteristicWriteType(rawValue: 1)!)
     }
     
@@ -81,6 +89,13 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
     readytotrack = false
     trackerreset = true
     opencvWrapper.trackerreset()
+    if binary {
+        if let frame = opencvWrapper.ramka(0), let chara = devicechara {
+            device?.writeValue(frame, for: chara, type: .withoutResponse)
+        }
+    } else {
+        send(command: "b")
+    }
     }
     
     @IBOutlet weak var Recstate: UIButton!
@@ -89,13 +104,16 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
     @IBAction func Rec(_ sender: UIButton) {
         if cameraBuffer.isRecording {
             cameraBuffer.stop()
+            opencvWrapper.koniec()
             Recstate.setTitle("Start rec", for: .normal)
             PHPhotoLibrary.requestAuthorization { status in
                 if status == .authorized {
                     // Save the movie file to the photo library and cleanup.
                     PHPhotoLibrary.shared().performChanges({
                         let options = PHAssetResourceCreationOptions()
-                        options.shouldMoveFile = true
+                        //a copy stays in Documents next to its .track sidecar (file sharing) for tools/trackmerge,
+                        //only the newest few are kept there (CameraBuffer.pruneRecordings)
+                        options.shouldMoveFile = false
                         let creationRequest = PHAssetCreationRequest.forAsset()
                         creationRequest.addResource(with: .video, fileURL: self.cameraBuffer.urll, options: options)
                     }, completionHandler: { success, error in
@@ -118,6 +136,7 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
         }
         else {
             cameraBuffer.start()
+            opencvWrapper.nagrywaj(cameraBuffer.outputFileLocation.deletingPathExtension().appendingPathExtension("track").path)
             Recstate.setTitle("Stop rec", for: .normal)
             let alertController = UIAlertController(title: "Recording started", message: nil, preferredStyle: .alert)
             let defaultAction = UIAlertAction(title: "OK", style: .default, handler: nil)
@@ -132,8 +151,7 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
     var stateT = true
     var readytotrack = false
     var counter = 1
-    var move = false
-    func captured(image: UIImage) {
+    func captured(image: UIImage, time: Int64) {
         //sending first image only to get size information
         if counter == 1 {
             opencvWrapper.start(image)
@@ -154,6 +172,9 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
                 stateT = false
                 DispatchQueue.main.async {
                     self.camView.image =  self.opencvWrapper.trackerstart(image)
+                    if time >= 0 {
+                        self.opencvWrapper.zapisz(time)
+                    }
                     self.place = self.opencvWrapper.miejsce()
                     self.stateT = true
                 }
@@ -163,35 +184,32 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
     }
     
     //sending special information to my device about how to move motor
+    //direction comes from the PID controller of the tracking engine, only changes are sent
+    var lastcommand = "b"
+    var binary = false //board understands binary frames (gimbal_protocol.h) instead of l / r / b
+    var closedloop = false //board runs the control loop itself, it gets the target instead of a rate (GP_TRACK)
     func ruch () {
-        if place < 40 && move == false {
-            moveleft()
+        let rate = opencvWrapper.predkosc()
+        if binary {
+            if let frame = closedloop ? opencvWrapper.ramkaCelu() : opencvWrapper.ramka(rate), let chara = devicechara {
+                device?.writeValue(frame, for: chara, type: .withoutResponse)
+            }
+            return
         }
-    
-        if place > 60 && move == false {
-            moveright()
+        var command = "b"
+        if rate < -0.05 {
+            command = "l"
         }
-        
-        if place >= 40 && place <= 60 && move {
-            DispatchQueue.main.asyncAfter(deadline: .now() + 0.2){
-                self.device?.writeValue("b".data(using: .utf8)!, for:
-                    self.devicechara!, type: CBCharacteristicWriteType(rawValue: 1)!)
-                self.move = false
-            }
+        if rate > 0.05 {
+            command = "r"
         }
+        send(command: command)
     }
     
-    func moveright () {
-        DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) {
-            self.device?.writeValue("r".data(using: .utf8)!, for:
-                self.devicechara!, type: CBCharacteristicWriteType(rawValue: 1)!)
-            self.move = true
-        }
-    }
-    func moveleft () {
-        DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) {
-            self.device?.writeValue("l".data(using: .utf8)!, for: self.devicechara!, type: CBCharacteristicWriteType(rawValue: 1)!)
-            self.move = true
+    func send (command: String) {
+        if command != lastcommand, let chara = devicechara {
+            device?.writeValue(command.data(using: .utf8)!, for: chara, type: CBCharacteristicWriteType(rawValue: 1)!)
+            lastcommand = command
         }
     }
     
@@ -232,15 +250,22 @@ class CAMViewController: UIViewController , CameraBufferDelegate {
         if trackerreset {
         overlay.isHidden = true
             
-            //coordinates
-            let px = (rect?.minX)! * 100 / camView.bounds.width
-            let py = (rect?.minY)! * 100 / camView.bounds.height
-            let pw = (rect?.width)! * 100 / camView.bounds.width
-            let ph = (rect?.height)! * 100 / camView.bounds.height
-            opencvWrapper.frameinicx(Int32(px))
-            opencvWrapper.frameinicy(Int32(py))
-            opencvWrapper.frameinicw(Int32(pw))
-            opencvWrapper.frameinich(Int32(ph))
+            //short touch without dragging is a tap, the engine snaps a tight box to the object under it
+            if rect == nil || (abs(rect!.width) < 10 && abs(rect!.height) < 10) {
+                let point = touches.first?.location(in: camView) ?? lastPoint
+                opencvWrapper.frametap(Double(point.x * 100 / camView.bounds.width), y: Double(point.y * 100 / camView.bounds.height))
+            } else {
+                //coordinates
+                let px = (rect?.minX)! * 100 / camView.bounds.width
+                let py = (rect?.minY)! * 100 / camView.bounds.height
+                let pw = (rect?.width)! * 100 / camView.bounds.width
+                let ph = (rect?.height)! * 100 / camView.bounds.height
+                opencvWrapper.frameinicx(Int32(px))
+                opencvWrapper.frameinicy(Int32(py))
+                opencvWrapper.frameinicw(Int32(pw))
+                opencvWrapper.frameinich(Int32(ph))
+            }
+            rect = nil
             
         touchstate = true
         trackerreset = false
@@ -300,7 +325,7 @@ extension CAMViewController: CBCentralManagerDelegate,CBPeripheralDelegate {
         DispatchQueue.main.async {
             self.state.title = "OK.1"
         }
-        device?.discoverServices ([BService])
+        device?.discoverServices ([BService, MService])
     }
     
     func centralManager(_ central: CBCentralManager, didDisconnectPeripheral peripheral: CBPeripheral, error: Error?) {
@@ -310,7 +335,7 @@ extension CAMViewController: CBCentralManagerDelegate,CBPeripheralDelegate {
     //checking if I conneted to the right spec device part 1
     func peripheral(_ peripheral: CBPeripheral, didDiscoverServices error: Error?) {
         for service in peripheral.services! {
-            if service.uuid == BService {
+            if service.uuid == BService || service.uuid == MService {
                 DispatchQueue.main.async {
                     self.state.title = "OK.2"
                 }
@@ -322,13 +347,24 @@ extension CAMViewController: CBCentralManagerDelegate,CBPeripheralDelegate {
     //checking if I conneted to the right spec device part 2
     func peripheral(_ peripheral: CBPeripheral, didDiscoverCharacteristicsFor service: CBService, error: Error?) {
         for characteristic in service.characteristics! {
-            if characteristic.uuid == BCharacteristic {
+            if characteristic.uuid == BCharacteristic && !binary {
                 DispatchQueue.main.async {
                     self.state.title = "OK"
                 }
                 peripheral.setNotifyValue(true, for: characteristic)
                 devicechara=characteristic
             }
+            //board with motion service gets binary frames written without response
+            if characteristic.uuid == MSetpoint {
+                DispatchQueue.main.async {
+                    self.state.title = "OK"
+                }
+                devicechara=characteristic
+                binary = true
+            }
+            if characteristic.uuid == MGains {
+                closedloop = true
+            }
         }
     }
     
@@ -11,7 +11,8 @@ import AVFoundation
 import Photos
 
 protocol CameraBufferDelegate: class {
-    func captured(image: UIImage)
+    //time of the frame in the recorded movie in microseconds, -1 when not recording
+    func captured(image: UIImage, time: Int64)
 }
 
 class CameraBuffer: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate {
@@ -62,9 +63,6 @@ class CameraBuffer: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate {
     func captureOutput(_ output: AVCaptureOutput, didOutput sampleBuffer: CMSampleBuffer, from connection: AVCaptureConnection) {
         
         guard let uiImage = imageFromSampleBuffer(sampleBuffer: sampleBuffer) else { return }
-        DispatchQueue.main.async { [unowned self] in
-            self.delegate?.captured(image: uiImage)
-        }
  
         let writable = canWrite()
         if writable,
@@ -75,6 +73,16 @@ class CameraBuffer: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate {
             videoWriter.startSession(atSourceTime: sessionAtSourceTime!)
         }
         
+        // movie starts at sessionAtSourceTime, so this is the pts a decoder gives the frame
+        var time: Int64 = -1
+        if writable, output == videoOutput, videoWriterInput.isReadyForMoreMediaData {
+            let pts = CMTimeSubtract(CMSampleBufferGetPresentationTimeStamp(sampleBuffer), sessionAtSourceTime)
+            time = CMTimeConvertScale(pts, timescale: 1000000, method: .roundHalfAwayFromZero).value
+        }
+        DispatchQueue.main.async { [unowned self] in
+            self.delegate?.captured(image: uiImage, time: time)
+        }
+        
         if output == videoOutput {
             if trans {
             switch UIDevice.current.orientation {
@@ -201,11 +209,33 @@ class CameraBuffer: NSObject, AVCaptureVideoDataOutputSampleBufferDelegate {
         return videoOutputUrl
     }
     
+    //movies kept in Documents next to their .track sidecars, the photo library has its own copy
+    let keptRecordings = 3
+    
+    //deletes all but the newest keptRecordings movies from Documents, sidecars are small and stay
+    func pruneRecordings() {
+        let documents = FileManager.default.urls(for: .documentDirectory, in: .userDomainMask)[0]
+        guard let files = try? FileManager.default.contentsOfDirectory(at: documents, includingPropertiesForKeys: [.creationDateKey], options: []) else { return }
+        let movies = files.filter { $0.pathExtension == "mov" }.sorted {
+            let a = (try? $0.resourceValues(forKeys: [.creationDateKey]).creationDate) ?? nil
+            let b = (try? $1.resourceValues(forKeys: [.creationDateKey]).creationDate) ?? nil
+            return (a ?? Date.distantPast) > (b ?? Date.distantPast)
+        }
+        for movie in movies.dropFirst(keptRecordings) {
+            do {
+                try FileManager.default.removeItem(at: movie)
+            } catch {
+                print(error)
+            }
+        }
+    }
+    
     // MARK: Start recording
     func start() {
         guard !isRecording else { return }
         isRecording = true
         sessionAtSourceTime = nil
+        pruneRecordings()
         setUpWriter()
     }
     
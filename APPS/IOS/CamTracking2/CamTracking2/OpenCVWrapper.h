@@ -19,6 +19,12 @@
 
 - (int) miejsce;
 
+- (double) predkosc;
+
+- (NSData *) ramka: (double) rate;
+
+- (NSData *) ramkaCelu;
+
 - (void) start: (UIImage *) image;
 
 - (void) frameinicx: (int) rectx;
@@ -29,6 +35,14 @@
 
 - (void) frameinich: (int) recth;
 
+- (void) frametap: (double) tapx y: (double) tapy;
+
 - (void) trackerreset;
 
+- (void) nagrywaj: (NSString *) path;
+
+- (void) zapisz: (long long) time;
+
+- (void) koniec;
+
 @end
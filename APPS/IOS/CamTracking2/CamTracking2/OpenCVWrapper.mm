@@ -12,27 +12,48 @@
 #import <opencv2/imgcodecs/ios.h>
 #import <opencv2/tracking.hpp>
 #import <opencv2/imgproc/imgproc.hpp>
+#include "tracking.h"
+#include "gimbal_protocol.h"
 
 using namespace cv;
 using namespace std;
 
 @implementation OpenCVWrapper
 
-Rect2d bbox;
-Ptr<Tracker> tracker = TrackerKCF::create();
-int w, h;
-int procent;
-int xf = 200;
-int yf = 300;
-int widthf = 500;
-int heightf = 500;
-int scale = 3;
+//tracking engine shared with android (APPS/Native/tracking)
+trk_session *session = NULL;
+trk_box bbox;
+//selected box in percent of the frame
+int xf = 20;
+int yf = 40;
+int widthf = 20;
+int heightf = 20;
+//tap point in percent of the frame, the engine finds the box around it in inittracker
+bool tap = false;
+double tapxf = 50;
+double tapyf = 50;
+
+//binary motor commands, initialized in start
+gp_sender sender;
+
+void enginelog (const char *message) {
+    NSLog(@"%s", message);
+}
+
+int16_t thousandths (double value) {
+    long scaled = lround(value * 1000);
+    return (int16_t)(scaled > INT16_MAX ? INT16_MAX : scaled < INT16_MIN ? INT16_MIN : scaled);
+}
 
-void recscale () {
-    bbox.x *= scale;
-    bbox.y *= scale;
-    bbox.width *= scale;
-    bbox.height *= scale;
+NSData *poll () {
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    size_t size = gp_sender_poll(&sender, (uint32_t)(CACurrentMediaTime() * 1000), frame);
+    return size ? [NSData dataWithBytes:frame length:size] : nil;
+}
+
+trk_frame toframe (const Mat &frame) {
+    trk_frame f = { frame.data, frame.step, frame.cols, frame.rows, frame.channels() };
+    return f;
 }
 
 + (NSString *)openCVVersionString {
@@ -41,72 +62,109 @@ void recscale () {
 
 - (void) start: (UIImage *) image {
     Mat startf; UIImageToMat(image, startf);
-    w = startf.size().width/ scale;
-    h = startf.size().height/ scale;
+    if (session == NULL) {
+        trk_set_log(&enginelog);
+        session = trk_create();
+        //changes under 0.02 frame widths/s are not sent, one write per 30 ms connection interval, repeat after 1 s
+        gp_sender_init(&sender, 20, 30, 1000);
+    }
+    trk_start(session, startf.cols, startf.rows, startf.channels());
 }
 
 - (UIImage *) inittracker:  (UIImage *) image {
     Mat initframe; UIImageToMat(image, initframe);
-    Mat grayr; resize(initframe, grayr, cv::Size(w, h));
-    cvtColor(grayr, grayr, CV_BGR2GRAY);
-    bbox.x = xf;
-    bbox.y = yf;
-    bbox.width = widthf;
-    bbox.height = heightf;
-    tracker->init(grayr, bbox);
-    recscale();
-    rectangle(initframe, bbox, Scalar( 255, 0, 0 ), 2, 1 );
+    trk_frame frame = toframe(initframe);
+    bbox.x = initframe.cols * xf / 100;
+    bbox.y = initframe.rows * yf / 100;
+    bbox.width = initframe.cols * widthf / 100;
+    bbox.height = initframe.rows * heightf / 100;
+    if (tap) {
+        //no detector on ios, the box comes from a segment of the frame under the tap
+        trk_select(session, &frame, initframe.cols * tapxf / 100, initframe.rows * tapyf / 100, NULL, 0, &bbox);
+        tap = false;
+    }
+    trk_init(session, &frame, bbox);
+    rectangle(initframe, Rect2d(bbox.x, bbox.y, bbox.width, bbox.height), Scalar( 255, 0, 0 ), 2, 1 );
     return MatToUIImage(initframe);
 }
 
 - (void) trackerreset {
-    tracker->clear();
-    tracker = TrackerKCF::create();
+    trk_reset(session);
 }
 
 - (void) frameinicx: (int) rectx{
-    xf = w * rectx /100;
+    xf = rectx;
 }
 
 - (void) frameinicy: (int) recty{
-    yf = h * recty /100;
+    yf = recty;
 }
 
 - (void) frameinicw: (int) rectw{
-    widthf = w * rectw /100;
+    widthf = rectw;
 }
 
 - (void) frameinich: (int) recth{
-    heightf = h * recth /100;
+    heightf = recth;
+}
+
+- (void) frametap: (double) tapx y: (double) tapy{
+    tapxf = tapx;
+    tapyf = tapy;
+    tap = true;
 }
 
 - (UIImage *) trackerstart: (UIImage *) image {
     
     Mat frame; UIImageToMat(image, frame);
-    Mat res_frame; resize(frame, res_frame, cv::Size(w, h));
-    cvtColor(res_frame, res_frame, CV_BGR2GRAY);
-    // Define initial bounding box
-    // Uncomment the line below to select a different bounding box
-    // bbox = selectROI(frame, false);
-    // Display bounding box.
-    // Update the tracking result
-    bool ok = tracker->update(res_frame, bbox);
-    procent = (bbox.x + bbox.width/2) *100 / w;
-    recscale();
-    
-    if (ok){
+    trk_frame f = toframe(frame);
+    // Update the tracking result, quality level and skipped frames are handled by the engine
+    if (trk_update(session, &f, &bbox) == TRK_TRACKED){
         // Tracking success : Draw the tracked object
-        rectangle(frame, bbox, Scalar( 255, 0, 0 ), 2, 1 );
-    }
-    else {
-        procent = 50;
+        rectangle(frame, Rect2d(bbox.x, bbox.y, bbox.width, bbox.height), Scalar( 255, 0, 0 ), 2, 1 );
     }
     
     return MatToUIImage(frame);
 }
 
+//tracking results next to the recorded video, keyed by the movie time of each frame in microseconds
+- (void) nagrywaj: (NSString *) path {
+    trk_record_open(session, path.UTF8String, 1000000);
+}
+
+- (void) zapisz: (long long) time {
+    trk_record(session, time);
+}
+
+- (void) koniec {
+    trk_record_close(session);
+}
+
 - (int) miejsce {
-    return procent;
+    return trk_position(session);
+}
+
+//gimbal rate setpoint from the engine controller, frame widths per second, positive is right
+- (double) predkosc {
+    return trk_control(session, CACurrentMediaTime());
+}
+
+//velocity frame to write or nil when nothing changed (or it is too early after the last write)
+- (NSData *) ramka: (double) rate {
+    int16_t value = thousandths(rate);
+    gp_sender_set(&sender, value == 0 ? GP_STOP : GP_VELOCITY, value);
+    return poll();
+}
+
+//target frame for a board that runs the control loop itself (GP_TRACK), a lost target stops it
+- (NSData *) ramkaCelu {
+    double bearing, velocity;
+    if (trk_target(session, CACurrentMediaTime(), &bearing, &velocity) == TRK_TRACKED) {
+        gp_sender_set_track(&sender, thousandths(bearing), thousandths(velocity));
+    } else {
+        gp_sender_set(&sender, GP_STOP, 0);
+    }
+    return poll();
 }
 
 @end
@@ -0,0 +1,78 @@
+//
+//  PreprocessJni.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  JNI entry points of com.example.finalappv2.NativePreprocess
+
+#include <jni.h>
+#include <android/bitmap.h>
+#include <android/log.h>
+
+#include "ImagePreprocess.hpp"
+
+namespace {
+
+// locked bitmap pixels, unlocked when going out of scope
+struct LockedBitmap {
+    JNIEnv *env;
+    jobject bitmap;
+    AndroidBitmapInfo info;
+    uint8_t *pixels = nullptr;
+
+    LockedBitmap(JNIEnv *e, jobject b) : env(e), bitmap(b) {
+        if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS
+            || info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+            return;
+        }
+        void *data;
+        if (AndroidBitmap_lockPixels(env, bitmap, &data) == ANDROID_BITMAP_RESULT_SUCCESS) {
+            pixels = static_cast<uint8_t *>(data);
+        }
+    }
+
+    ~LockedBitmap() {
+        if (pixels) {
+            AndroidBitmap_unlockPixels(env, bitmap);
+        }
+    }
+};
+
+// destination address with room for count bytes from offset, null if the buffer is too small
+uint8_t *directBuffer(JNIEnv *env, jobject buffer, jlong offset, jlong count) {
+    uint8_t *data = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+    if (!data || offset < 0 || env->GetDirectBufferCapacity(buffer) < offset + count) {
+        __android_log_print(ANDROID_LOG_ERROR, "ERR", "preprocess: buffer not direct or too small");
+        return nullptr;
+    }
+    return data + offset;
+}
+
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_finalappv2_NativePreprocess_toRgb(JNIEnv *env, jclass, jobject bitmap, jobject buffer,
+                                                    jint width, jint height) {
+    LockedBitmap src(env, bitmap);
+    uint8_t *dst = directBuffer(env, buffer, 0, (jlong)width * height * 3);
+    if (!src.pixels || !dst) {
+        return JNI_FALSE;
+    }
+    imgprep::rgbaToRgb(src.pixels, src.info.stride, src.info.width, src.info.height, dst, width, height);
+    return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_example_finalappv2_NativePreprocess_toFloat(JNIEnv *env, jclass, jobject bitmap, jobject buffer,
+                                                      jint offset, jint width, jint height,
+                                                      jfloat scale, jfloat shift, jboolean bgr) {
+    LockedBitmap src(env, bitmap);
+    uint8_t *dst = directBuffer(env, buffer, (jlong)offset * 4, (jlong)width * height * 3 * 4);
+    if (!src.pixels || !dst) {
+        return JNI_FALSE;
+    }
+    imgprep::rgbaToFloat(src.pixels, src.info.stride, src.info.width, src.info.height,
+                         reinterpret_cast<float *>(dst), width, height, scale, shift, bgr == JNI_TRUE);
+    return JNI_TRUE;
+}
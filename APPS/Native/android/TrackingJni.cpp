@@ -0,0 +1,94 @@
+//
+//  TrackingJni.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  JNI entry points of com.example.finalappv2.NativeTracker, only the C interface of the engine is used
+
+#include <jni.h>
+#include <android/bitmap.h>
+#include <android/log.h>
+
+#include "tracking.h"
+
+namespace {
+
+void androidlog(const char *message) {
+    __android_log_print(ANDROID_LOG_INFO, "INFO", "%s", message);
+}
+
+trk_session *session(jlong handle) {
+    return reinterpret_cast<trk_session *>(handle);
+}
+
+// runs fn with the bitmap pixels as a frame, TRK_ERROR when the bitmap is not RGBA_8888
+template <typename Fn>
+int withFrame(JNIEnv *env, jobject bitmap, Fn fn) {
+    AndroidBitmapInfo info;
+    void *pixels;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS
+        || info.format != ANDROID_BITMAP_FORMAT_RGBA_8888
+        || AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        return TRK_ERROR;
+    }
+    trk_frame frame = { static_cast<const uint8_t *>(pixels), info.stride, (int)info.width, (int)info.height, 4 };
+    int result = fn(frame);
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return result;
+}
+
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_example_finalappv2_NativeTracker_create(JNIEnv *, jclass) {
+    trk_set_log(&androidlog);
+    return reinterpret_cast<jlong>(trk_create());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_finalappv2_NativeTracker_destroy(JNIEnv *, jclass, jlong handle) {
+    trk_destroy(session(handle));
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_example_finalappv2_NativeTracker_start(JNIEnv *, jclass, jlong handle, jint width, jint height) {
+    return trk_start(session(handle), width, height, 4);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_example_finalappv2_NativeTracker_init(JNIEnv *env, jclass, jlong handle, jobject bitmap,
+                                                jfloat x, jfloat y, jfloat width, jfloat height) {
+    trk_box box = { x, y, width, height };
+    return withFrame(env, bitmap, [&](const trk_frame &frame) {
+        return trk_init(session(handle), &frame, box);
+    });
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_example_finalappv2_NativeTracker_update(JNIEnv *env, jclass, jlong handle, jobject bitmap, jfloatArray out) {
+    trk_box box = { 0, 0, 0, 0 };
+    int result = withFrame(env, bitmap, [&](const trk_frame &frame) {
+        return trk_update(session(handle), &frame, &box);
+    });
+    if (result != TRK_ERROR && env->GetArrayLength(out) >= 4) {
+        jfloat values[4] = { (jfloat)box.x, (jfloat)box.y, (jfloat)box.width, (jfloat)box.height };
+        env->SetFloatArrayRegion(out, 0, 4, values);
+    }
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_example_finalappv2_NativeTracker_reset(JNIEnv *, jclass, jlong handle) {
+    trk_reset(session(handle));
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_example_finalappv2_NativeTracker_position(JNIEnv *, jclass, jlong handle) {
+    return trk_position(session(handle));
+}
+
+extern "C" JNIEXPORT jdouble JNICALL
+Java_com_example_finalappv2_NativeTracker_control(JNIEnv *, jclass, jlong handle, jdouble time) {
+    return trk_control(session(handle), time);
+}
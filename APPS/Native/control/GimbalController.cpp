@@ -0,0 +1,107 @@
+//
+//  GimbalController.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "GimbalController.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ctrl {
+
+namespace {
+
+double clamp(double v, double limit) {
+    return std::max(-limit, std::min(limit, v));
+}
+
+}
+
+GimbalController::GimbalController(const ControllerConfig &config) : cfg(config) {}
+
+void GimbalController::configure(const ControllerConfig &config) {
+    cfg = config;
+    integral = clamp(integral, cfg.integralLimit);
+}
+
+void GimbalController::reset() {
+    timed = false;
+    started = false;
+    integral = 0;
+    errorRate = 0;
+    velocity = 0;
+    rate = 0;
+    historyCount = 0;
+}
+
+//setpoint which was active at time, history is ordered from the newest
+double GimbalController::rateAt(double time) const {
+    for (int i = 0; i < historyCount; i++) {
+        if (historyTime[i] <= time) {
+            return historyRate[i];
+        }
+    }
+    return historyCount ? historyRate[historyCount - 1] : 0;
+}
+
+double GimbalController::update(double time, double position, bool tracked) {
+    double dt = timed ? time - lastTime : 0;
+    if (dt < 0 || dt > 1) {
+        //clock jump or long pause, old state is useless
+        reset();
+        dt = 0;
+    }
+    lastTime = time;
+    timed = true;
+
+    double target = 0;
+    if (tracked) {
+        double error = (position - 50) / 50;
+        if (std::fabs(error) < cfg.deadband) {
+            error = 0;
+        }
+        if (started && dt > 0) {
+            double change = (error - lastError) / dt;
+            errorRate += cfg.velocityAlpha * (change - errorRate);
+            //turning by rate moves the target in the frame by -rate, so its own velocity is the change
+            //in the frame plus the rate active when the frame was taken
+            //(error is in half frame widths and rate in frame widths)
+            velocity += cfg.velocityAlpha * (change / 2 + rateAt(time - cfg.latency) - velocity);
+            integral = clamp(integral + error * dt, cfg.integralLimit);
+        }
+        lastError = error;
+        started = true;
+
+        target = cfg.kp * error + cfg.ki * integral + cfg.kd * errorRate + cfg.kff * velocity;
+        if (error == 0 && std::fabs(velocity) < cfg.deadband / 2) {
+            //target in the center and standing still, let the gimbal stop
+            target = cfg.ki * integral;
+        }
+    } else {
+        //lost, stop smoothly and start from scratch when found again
+        started = false;
+        integral = 0;
+        errorRate = 0;
+        velocity = 0;
+    }
+
+    //rate and acceleration limits of the motor
+    target = clamp(target, cfg.maxRate);
+    double step = dt > 0 ? cfg.maxAccel * dt : 0;
+    rate += clamp(target - rate, step);
+
+    for (int i = std::min(historyCount, HISTORY - 1); i > 0; i--) {
+        historyTime[i] = historyTime[i - 1];
+        historyRate[i] = historyRate[i - 1];
+    }
+    historyTime[0] = time;
+    historyRate[0] = rate;
+    historyCount = std::min(historyCount + 1, (int)HISTORY);
+    return rate;
+}
+
+}
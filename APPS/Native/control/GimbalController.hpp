@@ -0,0 +1,66 @@
+//
+//  GimbalController.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  PID with feed-forward on target velocity, turns tracker results into gimbal rate setpoints
+
+#ifndef GimbalController_hpp
+#define GimbalController_hpp
+
+namespace ctrl {
+
+// defaults tuned with tools/gimbalsim (30 fps, 0.1 s latency, 0.1 s motor lag)
+// units: position error is in half frame widths (-1 left edge, 0 center, 1 right edge),
+// rate is in frame widths per second, positive turns right
+struct ControllerConfig {
+    double kp = 1.2;
+    double ki = 0.3;
+    double kd = 0; // error derivative is noisy, feed-forward does its job
+    double kff = 0.8; // part of the estimated target velocity sent directly
+    double maxRate = 1.0; // frame widths per second
+    double maxAccel = 4.0; // rate change per second
+    double deadband = 0.08; // error around the center ignored (was 40..60 percent)
+    double integralLimit = 0.5;
+    double velocityAlpha = 0.1; // smoothing of the target velocity estimate
+    double latency = 0.1; // seconds from frame capture to tracker result
+};
+
+class GimbalController {
+public:
+    explicit GimbalController(const ControllerConfig &config = ControllerConfig());
+
+    void configure(const ControllerConfig &config);
+    const ControllerConfig &config() const { return cfg; }
+
+    void reset();
+
+    // one tracker result, position 0..100 percent like trk_position, time in seconds
+    // returns rate setpoint, when the target is lost the gimbal slows down to 0
+    double update(double time, double position, bool tracked);
+
+    double setpoint() const { return rate; }
+
+private:
+    double rateAt(double time) const;
+
+    enum { HISTORY = 32 };
+    ControllerConfig cfg;
+    bool timed = false; // lastTime is valid
+    bool started = false; // lastError is valid
+    double lastTime = 0;
+    double lastError = 0;
+    double integral = 0;
+    double errorRate = 0; // filtered derivative of the error
+    double velocity = 0; // filtered target velocity in frame widths per second
+    double rate = 0;
+    // past setpoints, the frame behind a result was taken while the gimbal turned with an older rate
+    double historyTime[HISTORY] = {};
+    double historyRate[HISTORY] = {};
+    int historyCount = 0;
+};
+
+}
+
+#endif /* GimbalController_hpp */
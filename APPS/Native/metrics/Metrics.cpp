@@ -0,0 +1,202 @@
+//
+//  Metrics.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "Metrics.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace metrics {
+
+namespace {
+
+// histogram sum is kept in microunits so it fits an integer slot
+const double SUM_SCALE = 1e6;
+
+std::string number(double value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+std::string withLabels(const std::string &labels, const std::string &extra) {
+    if (labels.empty() && extra.empty()) return "";
+    if (labels.empty()) return "{" + extra + "}";
+    if (extra.empty()) return "{" + labels + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+}
+
+Registry &Registry::global() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Shard &Registry::shard() {
+    thread_local Shard *own = nullptr;
+    if (!own) {
+        std::lock_guard<std::mutex> lock(mutex);
+        shards.emplace_back(new Shard());
+        own = shards.back().get();
+    }
+    return *own;
+}
+
+int Registry::add(Series entry, int slots) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int id = registered.load(std::memory_order_relaxed);
+    if (used + slots > SLOTS || id == SERIES) {
+        return -1;
+    }
+    entry.slot = used;
+    used += slots;
+    series[id] = std::move(entry);
+    registered.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+int Registry::counter(const std::string &name, const std::string &help, const std::string &labels) {
+    return add({COUNTER, name, help, labels, 0, {}, nullptr}, 1);
+}
+
+int Registry::histogram(const std::string &name, const std::string &help, const std::string &labels,
+                        const std::vector<double> &bounds) {
+    // bucket per bound, +Inf, count, sum
+    return add({HISTOGRAM, name, help, labels, 0, bounds, nullptr}, (int)bounds.size() + 3);
+}
+
+void Registry::gauge(const std::string &name, const std::string &help, const std::string &labels,
+                     std::function<double()> read) {
+    add({GAUGE, name, help, labels, 0, {}, std::move(read)}, 0);
+}
+
+// only the owning thread writes its shard, load + store is enough and avoids locked instructions
+void Registry::add(int id, uint64_t value) {
+    if (id < 0) return;
+    std::atomic<uint64_t> &slot = shard().slots[series[id].slot];
+    slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void Registry::observe(int id, double value) {
+    if (id < 0) return;
+    const Series &entry = series[id];
+    std::atomic<uint64_t> *slots = shard().slots + entry.slot;
+    size_t bucket = 0;
+    while (bucket < entry.bounds.size() && value > entry.bounds[bucket]) {
+        bucket++;
+    }
+    size_t count = entry.bounds.size() + 1;
+    slots[bucket].store(slots[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slots[count].store(slots[count].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    uint64_t micro = (uint64_t)(value > 0 ? value * SUM_SCALE : 0);
+    slots[count + 1].store(slots[count + 1].load(std::memory_order_relaxed) + micro, std::memory_order_relaxed);
+}
+
+uint64_t Registry::sum(int slot) {
+    uint64_t value = 0;
+    for (const std::unique_ptr<Shard> &each : shards) {
+        value += each->slots[slot].load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+uint64_t Registry::total(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return id < 0 ? 0 : sum(series[id].slot);
+}
+
+std::string Registry::scrape() {
+    // gauges are read without the lock, their callbacks may call total(), only one scrape runs at a time
+    std::vector<Series> copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy.assign(series, series + registered.load(std::memory_order_relaxed));
+    }
+    std::vector<double> gauges(copy.size());
+    for (size_t i = 0; i < copy.size(); i++) {
+        // the registered function, not the copy, so gauges can keep state between scrapes
+        if (copy[i].kind == GAUGE) gauges[i] = series[i].read();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    std::vector<bool> printed(copy.size(), false);
+    // series with the same name are one family, HELP and TYPE only once
+    for (size_t i = 0; i < copy.size(); i++) {
+        if (printed[i]) continue;
+        const char *type = copy[i].kind == COUNTER ? "counter" : copy[i].kind == GAUGE ? "gauge" : "histogram";
+        out += "# HELP " + copy[i].name + " " + copy[i].help + "\n";
+        out += "# TYPE " + copy[i].name + " " + type + "\n";
+        for (size_t j = i; j < copy.size(); j++) {
+            const Series &entry = copy[j];
+            if (printed[j] || entry.name != copy[i].name) continue;
+            printed[j] = true;
+            if (entry.kind == COUNTER) {
+                out += entry.name + withLabels(entry.labels, "") + " " + std::to_string(sum(entry.slot)) + "\n";
+            } else if (entry.kind == GAUGE) {
+                out += entry.name + withLabels(entry.labels, "") + " " + number(gauges[j]) + "\n";
+            } else {
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b <= entry.bounds.size(); b++) {
+                    cumulative += sum(entry.slot + (int)b);
+                    std::string le = b < entry.bounds.size() ? number(entry.bounds[b]) : "+Inf";
+                    out += entry.name + "_bucket" + withLabels(entry.labels, "le=\"" + le + "\"") + " "
+                           + std::to_string(cumulative) + "\n";
+                }
+                int count = entry.slot + (int)entry.bounds.size() + 1;
+                out += entry.name + "_sum" + withLabels(entry.labels, "") + " " + number(sum(count + 1) / SUM_SCALE) + "\n";
+                out += entry.name + "_count" + withLabels(entry.labels, "") + " " + std::to_string(sum(count)) + "\n";
+            }
+        }
+        // quantiles for people reading the page without prometheus, linear inside the bucket
+        if (copy[i].kind != HISTOGRAM) continue;
+        out += "# HELP " + copy[i].name + "_quantile " + copy[i].help + ", estimated from buckets\n";
+        out += "# TYPE " + copy[i].name + "_quantile gauge\n";
+        for (size_t j = i; j < copy.size(); j++) {
+            const Series &entry = copy[j];
+            if (entry.name != copy[i].name) continue;
+            uint64_t count = sum(entry.slot + (int)entry.bounds.size() + 1);
+            for (double q : {0.5, 0.9, 0.99}) {
+                double value = 0;
+                uint64_t below = 0;
+                for (size_t b = 0; b <= entry.bounds.size() && count; b++) {
+                    uint64_t in = sum(entry.slot + (int)b);
+                    if (below + in >= q * count) {
+                        double low = b ? entry.bounds[b - 1] : 0;
+                        double high = b < entry.bounds.size() ? entry.bounds[b] : low;
+                        value = low + (high - low) * (q * count - below) / (in ? in : 1);
+                        break;
+                    }
+                    below += in;
+                }
+                out += entry.name + "_quantile" + withLabels(entry.labels, "quantile=\"" + number(q) + "\"") + " "
+                       + number(value) + "\n";
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<double> latencyBuckets() {
+    return {0.5, 1, 2, 5, 10, 20, 33, 50, 100, 200, 500, 1000};
+}
+
+double residentBytes() {
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+    long pages = 0, resident = 0;
+    int read = fscanf(file, "%ld %ld", &pages, &resident);
+    fclose(file);
+    return read == 2 ? (double)resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+}
@@ -0,0 +1,88 @@
+//
+//  Metrics.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Counters, gauges and histograms for long running tracking servers, printed in Prometheus text format
+//
+//  every thread writes its own shard (plain relaxed stores, no shared cache lines, no locks),
+//  scrape adds the shards together, so a slow scraper never stalls a tracking thread
+
+#ifndef Metrics_hpp
+#define Metrics_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+class Registry {
+public:
+    // slots of one thread (counters and histogram buckets of all metrics) and metrics in total
+    enum { SLOTS = 2048, SERIES = 512 };
+
+    static Registry &global();
+
+    // registration is done once at startup, returns id for the hot path
+    // labels are already formatted: stage="track",session="2"
+    int counter(const std::string &name, const std::string &help, const std::string &labels = "");
+    int histogram(const std::string &name, const std::string &help, const std::string &labels,
+                  const std::vector<double> &bounds);
+    // read when scraped: queue depths, memory, anything owned by someone else
+    void gauge(const std::string &name, const std::string &help, const std::string &labels,
+               std::function<double()> read);
+
+    void add(int id, uint64_t value = 1);
+    void observe(int id, double value);
+
+    // sum over all threads, also usable by gauges (fps from a frame counter)
+    uint64_t total(int id);
+
+    std::string scrape();
+
+private:
+    struct Shard {
+        std::atomic<uint64_t> slots[SLOTS];
+        Shard() {
+            for (std::atomic<uint64_t> &slot : slots) slot.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    enum Kind { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Series {
+        Kind kind;
+        std::string name, help, labels;
+        int slot; // first slot: counter value, or histogram buckets then count and sum
+        std::vector<double> bounds;
+        std::function<double()> read;
+    };
+
+    Shard &shard();
+    uint64_t sum(int slot);
+    int add(Series series, int slots);
+
+    std::mutex mutex;
+    // fixed place, the hot path reads an entry while another thread may register a new one
+    Series series[SERIES];
+    std::atomic<int> registered{0};
+    // shards of finished threads stay, their counts are still part of the totals
+    std::vector<std::unique_ptr<Shard>> shards;
+    int used = 0;
+};
+
+// bucket bounds for latencies in ms
+std::vector<double> latencyBuckets();
+
+// resident memory of this process in bytes (linux), 0 when unknown
+double residentBytes();
+
+}
+
+#endif /* Metrics_hpp */
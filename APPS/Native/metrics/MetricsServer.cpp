@@ -0,0 +1,145 @@
+//
+//  MetricsServer.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "MetricsServer.hpp"
+
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace metrics {
+
+namespace {
+
+void sendAll(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += (size_t)n;
+    }
+}
+
+}
+
+Server::~Server() {
+    stop();
+}
+
+bool Server::start(const std::string &address) {
+    stop();
+    if (address.compare(0, 5, "unix:") == 0) {
+        unixPath = address.substr(5);
+        sockaddr_un local = {};
+        local.sun_family = AF_UNIX;
+        if (unixPath.empty() || unixPath.size() >= sizeof(local.sun_path)) {
+            reason = "bad unix socket path";
+            return false;
+        }
+        strcpy(local.sun_path, unixPath.c_str());
+        unlink(unixPath.c_str());
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener < 0 || bind(listener, (sockaddr *)&local, sizeof(local)) != 0) {
+            reason = "cant bind " + address;
+            stop();
+            return false;
+        }
+    } else {
+        size_t colon = address.rfind(':');
+        std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        int port = atoi(address.c_str() + (colon == std::string::npos ? 0 : colon + 1));
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons((uint16_t)port);
+        if (port <= 0 || port > 65535 || inet_pton(AF_INET, host.c_str(), &local.sin_addr) != 1) {
+            reason = "bad address " + address;
+            return false;
+        }
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        if (listener >= 0) setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (listener < 0 || bind(listener, (sockaddr *)&local, sizeof(local)) != 0) {
+            reason = "cant bind " + address;
+            stop();
+            return false;
+        }
+    }
+    if (listen(listener, 4) != 0 || pipe(wake) != 0) {
+        reason = "cant listen on " + address;
+        stop();
+        return false;
+    }
+    worker = std::thread([this] { run(); });
+    return true;
+}
+
+void Server::stop() {
+    if (worker.joinable()) {
+        char byte = 0;
+        if (write(wake[1], &byte, 1) < 0) {
+            // poll also ends when the listener is closed below
+        }
+        worker.join();
+    }
+    for (int *fd : {&listener, &wake[0], &wake[1]}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+        unixPath.clear();
+    }
+}
+
+void Server::run() {
+    for (;;) {
+        pollfd fds[2] = {{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client >= 0) {
+            answer(client);
+            close(client);
+        }
+    }
+}
+
+// reads the request line only, the headers are ignored
+void Server::answer(int client) {
+    timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char request[1024];
+    size_t length = 0;
+    while (length < sizeof(request) - 1) {
+        ssize_t n = recv(client, request + length, sizeof(request) - 1 - length, 0);
+        if (n <= 0) break;
+        length += (size_t)n;
+        request[length] = 0;
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[length] = 0;
+
+    std::string status = "200 OK", body;
+    if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET / ", 6) == 0) {
+        body = registry.scrape();
+    } else {
+        status = "404 Not Found";
+        body = "only GET /metrics\n";
+    }
+    sendAll(client, "HTTP/1.0 " + status + "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                    + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+}
+
+}
@@ -0,0 +1,46 @@
+//
+//  MetricsServer.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Minimal HTTP exporter, GET /metrics returns Registry::scrape() for Prometheus
+
+#ifndef MetricsServer_hpp
+#define MetricsServer_hpp
+
+#include <string>
+#include <thread>
+
+#include "Metrics.hpp"
+
+namespace metrics {
+
+// one background thread, one request at a time (scrapes are rare), only local clients:
+// "9100" or "127.0.0.1:9100" listens on loopback tcp, "unix:/run/tracker.sock" on a unix socket
+class Server {
+public:
+    explicit Server(Registry &registry = Registry::global()) : registry(registry) {}
+    ~Server();
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    bool start(const std::string &address);
+    void stop();
+    const std::string &error() const { return reason; }
+
+private:
+    void run();
+    void answer(int client);
+
+    Registry &registry;
+    std::thread worker;
+    int listener = -1;
+    int wake[2] = {-1, -1}; // pipe, stop() writes to it to end poll
+    std::string unixPath;
+    std::string reason;
+};
+
+}
+
+#endif /* MetricsServer_hpp */
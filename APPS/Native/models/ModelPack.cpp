@@ -0,0 +1,142 @@
+//
+//  ModelPack.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "ModelPack.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace model {
+
+namespace {
+
+// layout written by ML/pack.py, all numbers little endian
+const char MAGIC[4] = {'O', 'T', 'M', 'B'};
+const uint32_t VERSION = 1;
+const size_t HEADER = 16;
+const size_t NAME_SIZE = 48;
+const size_t ENTRY = NAME_SIZE + 16;
+
+uint32_t read32(const uint8_t *p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+uint64_t read64(const uint8_t *p) {
+    return read32(p) | (uint64_t)read32(p + 4) << 32;
+}
+
+}
+
+ModelPack::~ModelPack() {
+    close();
+}
+
+bool ModelPack::open(const char *path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        close();
+        reason = "cant open file";
+        return false;
+    }
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0 && open(fd, 0, (size_t)info.st_size);
+    ::close(fd); // mapping stays valid
+    return ok;
+}
+
+bool ModelPack::open(int fd, size_t offset, size_t size) {
+    close();
+    // mmap offset has to be page aligned, the pack starts a bit into the mapping
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t skip = offset % page;
+    void *map = mmap(nullptr, size + skip, PROT_READ, MAP_SHARED, fd, (off_t)(offset - skip));
+    if (map == MAP_FAILED) {
+        reason = "cant map file";
+        return false;
+    }
+    mapping = map;
+    mappedSize = size + skip;
+    start = (const uint8_t *)map + skip;
+    length = size;
+    if (!check()) {
+        const char *why = reason;
+        close();
+        reason = why;
+        return false;
+    }
+    reason = "";
+    return true;
+}
+
+void ModelPack::close() {
+    if (mapping) {
+        munmap(mapping, mappedSize);
+    }
+    mapping = nullptr;
+    mappedSize = 0;
+    start = nullptr;
+    length = 0;
+    entries = 0;
+    reason = "not opened";
+}
+
+bool ModelPack::check() {
+    if (length < HEADER || memcmp(start, MAGIC, 4) != 0) {
+        reason = "not a model pack";
+        return false;
+    }
+    if (read32(start + 4) != VERSION) {
+        reason = "unsupported model pack version";
+        return false;
+    }
+    uint32_t count = read32(start + 8);
+    if (count > (length - HEADER) / ENTRY) {
+        reason = "entry table out of file";
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *entry = start + HEADER + i * ENTRY;
+        uint64_t offset = read64(entry + NAME_SIZE), size = read64(entry + NAME_SIZE + 8);
+        if (offset > length || size > length - offset || entry[NAME_SIZE - 1] != 0) {
+            reason = "broken entry";
+            return false;
+        }
+    }
+    entries = (int)count;
+    return true;
+}
+
+Blob ModelPack::find(const char *name) const {
+    for (int i = 0; i < entries; i++) {
+        const uint8_t *entry = start + HEADER + i * ENTRY;
+        if (strncmp((const char *)entry, name, NAME_SIZE) == 0) {
+            return {start + read64(entry + NAME_SIZE), (size_t)read64(entry + NAME_SIZE + 8)};
+        }
+    }
+    return {nullptr, 0};
+}
+
+const char *ModelPack::name(int index) const {
+    return index >= 0 && index < entries ? (const char *)(start + HEADER + index * ENTRY) : nullptr;
+}
+
+void ModelPack::prefetch(const char *name) const {
+    Blob blob = find(name);
+    if (!blob.data) {
+        return;
+    }
+    // madvise needs a page aligned address, models are 16k aligned only in a pack mapped from a page offset
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)blob.data / page * page;
+    madvise((void *)begin, (uintptr_t)blob.data + blob.size - begin, MADV_WILLNEED);
+}
+
+}
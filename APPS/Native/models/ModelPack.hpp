@@ -0,0 +1,60 @@
+//
+//  ModelPack.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Read only mapping of models.bin (ML/pack.py), models are used in place without parsing or copying
+
+#ifndef ModelPack_hpp
+#define ModelPack_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace model {
+
+// one model inside the mapping, data is null when the name is not in the pack
+struct Blob {
+    const void *data;
+    size_t size;
+};
+
+// file is mapped shared, so every session and process using the same pack shares physical pages
+// open only checks the header and entry table, model pages are read when the interpreter touches them
+class ModelPack {
+public:
+    ModelPack() = default;
+    ~ModelPack();
+    ModelPack(const ModelPack &) = delete;
+    ModelPack &operator=(const ModelPack &) = delete;
+
+    bool open(const char *path);
+    // part of a bigger file, android assets are (fd, start offset, declared length) inside the apk
+    // models are page aligned only when offset is, zipalign gives assets 4 bytes
+    bool open(int fd, size_t offset, size_t size);
+    void close();
+
+    Blob find(const char *name) const;
+    const char *name(int index) const; // 0..count()-1
+    // asks the kernel to read the model ahead, before the first inference needs it
+    void prefetch(const char *name) const;
+
+    int count() const { return entries; }
+    size_t size() const { return length; }
+    const char *error() const { return reason; }
+
+private:
+    bool check();
+
+    void *mapping = nullptr;
+    size_t mappedSize = 0;
+    const uint8_t *start = nullptr; // pack inside the mapping
+    size_t length = 0;
+    int entries = 0;
+    const char *reason = "not opened";
+};
+
+}
+
+#endif /* ModelPack_hpp */
@@ -0,0 +1,303 @@
+//
+//  Pipeline.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  C++20 coroutine stages on a small thread pool: ingest -> preprocess -> track -> control -> record
+//
+//  every stage of every target is one coroutine reading its input channel in order, so results of one
+//  target keep the frame order while different targets and different stages run on all cores
+//  cancel() closes the channels, stages see an empty pop and finish, frames past their deadline are dropped
+
+#ifndef Pipeline_hpp
+#define Pipeline_hpp
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace flow {
+
+typedef std::chrono::steady_clock Clock;
+
+// thread pool resuming coroutines, co_await executor.schedule() moves a coroutine onto it
+class Executor {
+public:
+    explicit Executor(unsigned threads) {
+        for (unsigned i = 0; i < (threads ? threads : 1); i++) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(handle);
+        }
+        wake.notify_one();
+    }
+
+    auto schedule() {
+        struct Awaiter {
+            Executor *executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor->post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+    size_t threads() const { return workers.size(); }
+
+private:
+    void run() {
+        for (;;) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                handle = queue.front();
+                queue.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+// lazy coroutine, starts when awaited or spawned, the awaiting coroutine continues when it ends
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Final {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Final{};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task(const Task &) = delete;
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    void await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace detail {
+
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+inline Detached run(Executor &executor, Task task, std::latch &done) {
+    co_await executor.schedule();
+    co_await task;
+    done.count_down();
+}
+
+}
+
+// starts task on the executor, done is counted down when it ends
+inline void spawn(Executor &executor, Task task, std::latch &done) {
+    detail::run(executor, std::move(task), done);
+}
+
+// bounded FIFO between two stages, push waits when full and pop waits when empty
+// after close() pushes fail and pop returns nothing once the buffered items are taken
+template <typename T>
+class Channel {
+    struct PopWaiter {
+        std::coroutine_handle<> handle;
+        std::optional<T> item;
+    };
+    struct PushWaiter {
+        std::coroutine_handle<> handle;
+        T item;
+        bool accepted = false;
+    };
+
+public:
+    Channel(Executor &executor, size_t capacity) : executor(executor), capacity(capacity ? capacity : 1) {}
+
+    auto pop() {
+        struct Awaiter {
+            Channel *channel;
+            PopWaiter waiter;
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                if (channel->take(waiter.item) || channel->closed) {
+                    return false;
+                }
+                waiter.handle = handle;
+                channel->poppers.push_back(&waiter);
+                return true;
+            }
+            std::optional<T> await_resume() { return std::move(waiter.item); }
+        };
+        return Awaiter{this, {}};
+    }
+
+    // false when the channel was closed
+    auto push(T item) {
+        struct Awaiter {
+            Channel *channel;
+            PushWaiter waiter;
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                if (channel->closed) {
+                    return false;
+                }
+                if (!channel->poppers.empty()) {
+                    PopWaiter *popper = channel->poppers.front();
+                    channel->poppers.pop_front();
+                    popper->item = std::move(waiter.item);
+                    channel->executor.post(popper->handle);
+                    waiter.accepted = true;
+                    return false;
+                }
+                if (channel->items.size() < channel->capacity) {
+                    channel->items.push_back(std::move(waiter.item));
+                    waiter.accepted = true;
+                    return false;
+                }
+                waiter.handle = handle;
+                channel->pushers.push_back(&waiter);
+                return true;
+            }
+            bool await_resume() const { return waiter.accepted; }
+        };
+        return Awaiter{this, {{}, std::move(item)}};
+    }
+
+    // queue depth for monitoring, stale as soon as it returns
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        for (PopWaiter *popper : poppers) {
+            executor.post(popper->handle);
+        }
+        for (PushWaiter *pusher : pushers) {
+            executor.post(pusher->handle);
+        }
+        poppers.clear();
+        pushers.clear();
+    }
+
+private:
+    // under lock: next item, a waiting pusher moves its item into the freed place
+    bool take(std::optional<T> &out) {
+        if (items.empty()) {
+            return false;
+        }
+        out = std::move(items.front());
+        items.pop_front();
+        if (!pushers.empty()) {
+            PushWaiter *pusher = pushers.front();
+            pushers.pop_front();
+            items.push_back(std::move(pusher->item));
+            pusher->accepted = true;
+            executor.post(pusher->handle);
+        }
+        return true;
+    }
+
+    Executor &executor;
+    const size_t capacity;
+    std::mutex mutex;
+    std::deque<T> items;
+    std::deque<PopWaiter *> poppers;
+    std::deque<PushWaiter *> pushers;
+    bool closed = false;
+};
+
+// shared by all stages of a pipeline, checked between frames
+class CancelToken {
+public:
+    void cancel() { flag.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> flag{false};
+};
+
+// frame is useless after its deadline (the gimbal already got a newer one)
+inline bool expired(Clock::time_point deadline) {
+    return Clock::now() > deadline;
+}
+
+}
+
+#endif /* Pipeline_hpp */
@@ -0,0 +1,115 @@
+//
+//  ImagePreprocess.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "ImagePreprocess.hpp"
+
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMGPREP_NEON 1
+#endif
+
+namespace imgprep {
+
+namespace {
+
+// source column of every destination column, computed once per size
+const int *columns(int srcw, int dstw) {
+    thread_local std::vector<int> table;
+    thread_local int lastSrc = -1, lastDst = -1;
+    if (srcw != lastSrc || dstw != lastDst) {
+        table.resize(dstw);
+        for (int x = 0; x < dstw; x++) {
+            table[x] = (int)((long long)x * srcw / dstw);
+        }
+        lastSrc = srcw;
+        lastDst = dstw;
+    }
+    return table.data();
+}
+
+// 1:1 row without resize, 16 pixels per step with neon
+void rowRgb(const uint8_t *src, uint8_t *dst, int w) {
+    int x = 0;
+#ifdef IMGPREP_NEON
+    for (; x + 16 <= w; x += 16) {
+        uint8x16x4_t rgba = vld4q_u8(src + x * 4);
+        uint8x16x3_t rgb = { { rgba.val[0], rgba.val[1], rgba.val[2] } };
+        vst3q_u8(dst + x * 3, rgb);
+    }
+#endif
+    for (; x < w; x++) {
+        dst[x * 3] = src[x * 4];
+        dst[x * 3 + 1] = src[x * 4 + 1];
+        dst[x * 3 + 2] = src[x * 4 + 2];
+    }
+}
+
+#ifdef IMGPREP_NEON
+inline float32x4_t lane(uint16x8_t v, bool high, float32x4_t scale, float32x4_t shift) {
+    uint32x4_t wide = high ? vmovl_u16(vget_high_u16(v)) : vmovl_u16(vget_low_u16(v));
+    return vmlaq_f32(shift, vcvtq_f32_u32(wide), scale);
+}
+#endif
+
+void rowFloat(const uint8_t *src, float *dst, int w, float scale, float shift, bool bgr) {
+    const int c0 = bgr ? 2 : 0, c2 = bgr ? 0 : 2;
+    int x = 0;
+#ifdef IMGPREP_NEON
+    const float32x4_t vscale = vdupq_n_f32(scale), vshift = vdupq_n_f32(shift);
+    for (; x + 8 <= w; x += 8) {
+        uint8x8x4_t rgba = vld4_u8(src + x * 4);
+        uint16x8_t ch0 = vmovl_u8(bgr ? rgba.val[2] : rgba.val[0]);
+        uint16x8_t ch1 = vmovl_u8(rgba.val[1]);
+        uint16x8_t ch2 = vmovl_u8(bgr ? rgba.val[0] : rgba.val[2]);
+        float32x4x3_t lo = { { lane(ch0, false, vscale, vshift), lane(ch1, false, vscale, vshift), lane(ch2, false, vscale, vshift) } };
+        float32x4x3_t hi = { { lane(ch0, true, vscale, vshift), lane(ch1, true, vscale, vshift), lane(ch2, true, vscale, vshift) } };
+        vst3q_f32(dst + x * 3, lo);
+        vst3q_f32(dst + x * 3 + 12, hi);
+    }
+#endif
+    for (; x < w; x++) {
+        dst[x * 3] = src[x * 4 + c0] * scale + shift;
+        dst[x * 3 + 1] = src[x * 4 + 1] * scale + shift;
+        dst[x * 3 + 2] = src[x * 4 + c2] * scale + shift;
+    }
+}
+
+// nearest neighbour columns of one row packed to a contiguous RGBA row
+const uint8_t *gatherRow(const uint8_t *srcRow, const int *cols, int dstw) {
+    thread_local std::vector<uint32_t> row;
+    row.resize(dstw);
+    const uint32_t *in = reinterpret_cast<const uint32_t *>(srcRow);
+    for (int x = 0; x < dstw; x++) {
+        row[x] = in[cols[x]];
+    }
+    return reinterpret_cast<const uint8_t *>(row.data());
+}
+
+}
+
+void rgbaToRgb(const uint8_t *src, size_t srcStride, int srcw, int srch,
+               uint8_t *dst, int dstw, int dsth) {
+    const int *cols = srcw == dstw ? nullptr : columns(srcw, dstw);
+    for (int y = 0; y < dsth; y++) {
+        const uint8_t *srcRow = src + (size_t)((long long)y * srch / dsth) * srcStride;
+        rowRgb(cols ? gatherRow(srcRow, cols, dstw) : srcRow, dst + (size_t)y * dstw * 3, dstw);
+    }
+}
+
+void rgbaToFloat(const uint8_t *src, size_t srcStride, int srcw, int srch,
+                 float *dst, int dstw, int dsth, float scale, float shift, bool bgr) {
+    const int *cols = srcw == dstw ? nullptr : columns(srcw, dstw);
+    for (int y = 0; y < dsth; y++) {
+        const uint8_t *srcRow = src + (size_t)((long long)y * srch / dsth) * srcStride;
+        rowFloat(cols ? gatherRow(srcRow, cols, dstw) : srcRow, dst + (size_t)y * dstw * 3, dstw, scale, shift, bgr);
+    }
+}
+
+}
@@ -0,0 +1,31 @@
+//
+//  ImagePreprocess.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Bitmap to network input conversion shared by the apps
+
+#ifndef ImagePreprocess_hpp
+#define ImagePreprocess_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace imgprep {
+
+// source is RGBA_8888 (android bitmap memory order), nearest neighbour resize to dstw x dsth
+// x is taken as x * srcw / dstw like in the java code so both paths give the same tensor
+
+// uint8 RGB for quantized nets, dst has dstw * dsth * 3 bytes
+void rgbaToRgb(const uint8_t *src, size_t srcStride, int srcw, int srch,
+               uint8_t *dst, int dstw, int dsth);
+
+// float scale * value + shift per channel, bgr swaps channel order (nets trained on cv2 images)
+// dst has dstw * dsth * 3 floats
+void rgbaToFloat(const uint8_t *src, size_t srcStride, int srcw, int srch,
+                 float *dst, int dstw, int dsth, float scale, float shift, bool bgr);
+
+}
+
+#endif /* ImagePreprocess_hpp */
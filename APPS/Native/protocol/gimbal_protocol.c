@@ -0,0 +1,161 @@
+/*
+ *  gimbal_protocol.c
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ */
+
+#include "gimbal_protocol.h"
+
+/* CRC-8, polynomial 0x07 */
+uint8_t gp_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0;
+    size_t i;
+    int bit;
+    for (i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t gp_frame_size(uint8_t type)
+{
+    return type == GP_TRACK ? GP_TRACK_FRAME_SIZE : GP_FRAME_SIZE;
+}
+
+size_t gp_encode(const gp_command *cmd, uint8_t out[GP_MAX_FRAME_SIZE])
+{
+    size_t size = gp_frame_size(cmd->type);
+    uint16_t value = (uint16_t)cmd->value;
+    out[0] = cmd->type;
+    out[1] = cmd->seq;
+    out[2] = (uint8_t)(cmd->time_ms & 0xFF);
+    out[3] = (uint8_t)(cmd->time_ms >> 8);
+    out[4] = (uint8_t)(value & 0xFF);
+    out[5] = (uint8_t)(value >> 8);
+    if (cmd->type == GP_TRACK) {
+        uint16_t velocity = (uint16_t)cmd->velocity;
+        out[6] = (uint8_t)(velocity & 0xFF);
+        out[7] = (uint8_t)(velocity >> 8);
+    }
+    out[size - 1] = gp_crc8(out, size - 1);
+    return size;
+}
+
+int gp_decode(const uint8_t *data, size_t len, gp_command *cmd)
+{
+    if (len != GP_FRAME_SIZE && len != GP_TRACK_FRAME_SIZE) {
+        return GP_ERR_LENGTH;
+    }
+    if (gp_crc8(data, len - 1) != data[len - 1]) {
+        return GP_ERR_CRC;
+    }
+    if (data[0] > GP_TRACK) {
+        return GP_ERR_TYPE;
+    }
+    if (len != gp_frame_size(data[0])) {
+        return GP_ERR_LENGTH;
+    }
+    cmd->type = data[0];
+    cmd->seq = data[1];
+    cmd->time_ms = (uint16_t)(data[2] | (data[3] << 8));
+    cmd->value = (int16_t)(uint16_t)(data[4] | (data[5] << 8));
+    cmd->velocity = cmd->type == GP_TRACK ? (int16_t)(uint16_t)(data[6] | (data[7] << 8)) : 0;
+    return GP_OK;
+}
+
+void gp_sender_init(gp_sender *sender, int16_t threshold, uint32_t interval_ms, uint32_t keepalive_ms)
+{
+    sender->threshold = threshold;
+    sender->interval_ms = interval_ms;
+    sender->keepalive_ms = keepalive_ms;
+    sender->last.type = GP_STOP;
+    sender->last.seq = 0;
+    sender->last.time_ms = 0;
+    sender->last.value = 0;
+    sender->last.velocity = 0;
+    sender->pending = sender->last;
+    sender->last_write_ms = 0;
+    sender->seq = 0;
+    sender->has_last = 0;
+    sender->sent = 0;
+    sender->suppressed = 0;
+}
+
+void gp_sender_set(gp_sender *sender, uint8_t type, int16_t value)
+{
+    sender->pending.type = type;
+    sender->pending.value = type == GP_STOP ? 0 : value;
+    sender->pending.velocity = 0;
+}
+
+void gp_sender_set_track(gp_sender *sender, int16_t error, int16_t velocity)
+{
+    sender->pending.type = GP_TRACK;
+    sender->pending.value = error;
+    sender->pending.velocity = velocity;
+}
+
+static int32_t distance(int16_t a, int16_t b)
+{
+    int32_t diff = (int32_t)a - b;
+    return diff < 0 ? -diff : diff;
+}
+
+static int changed(const gp_sender *sender)
+{
+    if (!sender->has_last || sender->pending.type != sender->last.type) {
+        return 1;
+    }
+    if (distance(sender->pending.velocity, sender->last.velocity) >= sender->threshold) {
+        return 1;
+    }
+    /* reaching exactly 0 is always sent, motor has to stop */
+    return distance(sender->pending.value, sender->last.value) >= sender->threshold
+           || (sender->pending.value == 0 && sender->last.value != 0);
+}
+
+size_t gp_sender_poll(gp_sender *sender, uint32_t now_ms, uint8_t out[GP_MAX_FRAME_SIZE])
+{
+    uint32_t since = now_ms - sender->last_write_ms;
+    if (sender->has_last && since < sender->interval_ms) {
+        return 0; /* coalesced, pending is sent in the next interval */
+    }
+    if (!changed(sender) && since < sender->keepalive_ms) {
+        sender->suppressed++;
+        return 0;
+    }
+    sender->pending.seq = sender->seq++;
+    sender->pending.time_ms = (uint16_t)now_ms;
+    sender->last = sender->pending;
+    sender->has_last = 1;
+    sender->last_write_ms = now_ms;
+    sender->sent++;
+    return gp_encode(&sender->pending, out);
+}
+
+void gp_receiver_init(gp_receiver *receiver)
+{
+    receiver->last_seq = 0;
+    receiver->has_last = 0;
+}
+
+int gp_receive(gp_receiver *receiver, const uint8_t *data, size_t len, gp_command *cmd)
+{
+    int result = gp_decode(data, len, cmd);
+    if (result != GP_OK) {
+        return result;
+    }
+    /* sequence distance modulo 256, up to half of the range counts as newer */
+    if (receiver->has_last && (uint8_t)(cmd->seq - receiver->last_seq - 1) >= 128) {
+        return GP_ERR_OLD;
+    }
+    receiver->last_seq = cmd->seq;
+    receiver->has_last = 1;
+    return GP_OK;
+}
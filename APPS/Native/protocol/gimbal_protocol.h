@@ -0,0 +1,106 @@
+/*
+ *  gimbal_protocol.h
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Binary motor commands between phone and board, plain C99 so the firmware can use the same file
+ *
+ *  frame (little endian, GP_FRAME_SIZE bytes):
+ *  0     type
+ *  1     sequence number, +1 for every new frame
+ *  2..3  sender time in ms (wraps)
+ *  4..5  value, int16
+ *  6     crc8 of bytes 0..5
+ *  GP_TRACK frames are GP_TRACK_FRAME_SIZE bytes, velocity follows the value:
+ *  6..7  velocity, int16
+ *  8     crc8 of bytes 0..7
+ */
+
+#ifndef gimbal_protocol_h
+#define gimbal_protocol_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GP_FRAME_SIZE 7
+#define GP_TRACK_FRAME_SIZE 9
+#define GP_MAX_FRAME_SIZE GP_TRACK_FRAME_SIZE
+
+enum {
+    GP_STOP = 0,     /* value ignored */
+    GP_VELOCITY = 1, /* value in 1/1000 frame widths per second, positive is right */
+    GP_POSITION = 2, /* value in 1/100 degree from the start position */
+    GP_TRACK = 3     /* value: target from the center of the frame in 1/1000 frame widths, positive is right,
+                        velocity: its motion in the frame in 1/1000 frame widths per second,
+                        the board closes the loop itself */
+};
+
+enum {
+    GP_OK = 0,
+    GP_ERR_LENGTH = -1,
+    GP_ERR_CRC = -2,
+    GP_ERR_TYPE = -3,
+    GP_ERR_OLD = -4  /* duplicate or older than the last accepted frame */
+};
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint16_t time_ms;
+    int16_t value;
+    int16_t velocity;   /* GP_TRACK, 0 for the others */
+} gp_command;
+
+uint8_t gp_crc8(const uint8_t *data, size_t len);
+
+/* bytes of a frame of this type */
+size_t gp_frame_size(uint8_t type);
+
+/* returns the frame size */
+size_t gp_encode(const gp_command *cmd, uint8_t out[GP_MAX_FRAME_SIZE]);
+int gp_decode(const uint8_t *data, size_t len, gp_command *cmd);
+
+/* phone side: only meaningful changes are sent and at most one frame per connection interval,
+   setpoints coming faster are merged (the newest wins) */
+typedef struct {
+    int16_t threshold;     /* smaller value changes are not sent */
+    uint32_t interval_ms;  /* connection interval */
+    uint32_t keepalive_ms; /* unchanged setpoint is repeated after this, so a lost write is fixed */
+    gp_command last;       /* last sent */
+    gp_command pending;    /* newest setpoint */
+    uint32_t last_write_ms;
+    uint8_t seq;
+    uint8_t has_last;
+    uint32_t sent;
+    uint32_t suppressed;
+} gp_sender;
+
+void gp_sender_init(gp_sender *sender, int16_t threshold, uint32_t interval_ms, uint32_t keepalive_ms);
+
+/* newest setpoint, nothing is sent here */
+void gp_sender_set(gp_sender *sender, uint8_t type, int16_t value);
+/* newest GP_TRACK measurement, a change of either value over the threshold is sent */
+void gp_sender_set_track(gp_sender *sender, int16_t error, int16_t velocity);
+
+/* frame size and frame in out when a write should be done now, 0 when nothing has to be sent */
+size_t gp_sender_poll(gp_sender *sender, uint32_t now_ms, uint8_t out[GP_MAX_FRAME_SIZE]);
+
+/* board side: drops duplicates and frames older than the last accepted one */
+typedef struct {
+    uint8_t last_seq;
+    uint8_t has_last;
+} gp_receiver;
+
+void gp_receiver_init(gp_receiver *receiver);
+int gp_receive(gp_receiver *receiver, const uint8_t *data, size_t len, gp_command *cmd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* gimbal_protocol_h */
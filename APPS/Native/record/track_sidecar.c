@@ -0,0 +1,177 @@
+/*
+ *  track_sidecar.c
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Sidecar writer and reader, plain C99
+ */
+
+#include "track_sidecar.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ~2000 records, a few flushes per minute at 30 fps */
+#define BUFFER_SIZE (64 * 1024)
+
+static const uint8_t MAGIC[4] = { 'O', 'T', 'T', 'S' };
+
+struct tsc_writer {
+    FILE *file;
+    char *buffer;
+    int failed;
+};
+
+struct tsc_reader {
+    FILE *file;
+    uint16_t record_size;
+};
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void putfloat(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put32(p, v);
+}
+
+static float getfloat(const uint8_t *p) {
+    uint32_t v = get32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+tsc_writer *tsc_create(const char *path, const tsc_header *header) {
+    uint8_t head[TSC_HEADER_SIZE] = { 0 };
+    tsc_writer *writer;
+    if (!path || !header || header->timescale == 0) {
+        return NULL;
+    }
+    writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        return NULL;
+    }
+    writer->buffer = malloc(BUFFER_SIZE);
+    writer->file = fopen(path, "wb");
+    if (!writer->buffer || !writer->file || setvbuf(writer->file, writer->buffer, _IOFBF, BUFFER_SIZE) != 0) {
+        if (writer->file) {
+            fclose(writer->file);
+        }
+        free(writer->buffer);
+        free(writer);
+        return NULL;
+    }
+    memcpy(head, MAGIC, 4);
+    head[4] = TSC_VERSION;
+    head[6] = TSC_RECORD_SIZE;
+    put32(head + 8, header->timescale);
+    put32(head + 12, header->width);
+    put32(head + 16, header->height);
+    writer->failed = fwrite(head, sizeof(head), 1, writer->file) != 1;
+    return writer;
+}
+
+int tsc_write(tsc_writer *writer, const tsc_record *record) {
+    uint8_t out[TSC_RECORD_SIZE];
+    uint64_t pts;
+    if (!writer || !record) {
+        return -1;
+    }
+    pts = (uint64_t)record->pts;
+    put32(out, (uint32_t)pts);
+    put32(out + 4, (uint32_t)(pts >> 32));
+    put32(out + 8, record->status);
+    putfloat(out + 12, record->x);
+    putfloat(out + 16, record->y);
+    putfloat(out + 20, record->width);
+    putfloat(out + 24, record->height);
+    putfloat(out + 28, record->rate);
+    if (fwrite(out, sizeof(out), 1, writer->file) != 1) {
+        writer->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+int tsc_close(tsc_writer *writer) {
+    int failed;
+    if (!writer) {
+        return -1;
+    }
+    failed = writer->failed;
+    if (fclose(writer->file) != 0) {
+        failed = 1;
+    }
+    free(writer->buffer);
+    free(writer);
+    return failed ? -1 : 0;
+}
+
+tsc_reader *tsc_open(const char *path, tsc_header *header) {
+    uint8_t head[TSC_HEADER_SIZE];
+    tsc_reader *reader;
+    FILE *file = path ? fopen(path, "rb") : NULL;
+    if (!file) {
+        return NULL;
+    }
+    /* newer versions may only grow the record, the known fields keep their place */
+    if (fread(head, sizeof(head), 1, file) != 1 || memcmp(head, MAGIC, 4) != 0 ||
+        head[4] == 0 || (head[6] | head[7] << 8) < TSC_RECORD_SIZE || get32(head + 8) == 0) {
+        fclose(file);
+        return NULL;
+    }
+    reader = malloc(sizeof(*reader));
+    if (!reader) {
+        fclose(file);
+        return NULL;
+    }
+    reader->file = file;
+    reader->record_size = (uint16_t)(head[6] | head[7] << 8);
+    if (header) {
+        header->timescale = get32(head + 8);
+        header->width = get32(head + 12);
+        header->height = get32(head + 16);
+    }
+    return reader;
+}
+
+int tsc_read(tsc_reader *reader, tsc_record *record) {
+    uint8_t in[TSC_RECORD_SIZE];
+    if (!reader || !record) {
+        return -1;
+    }
+    if (fread(in, sizeof(in), 1, reader->file) != 1) {
+        return ferror(reader->file) ? -1 : 0;
+    }
+    if (reader->record_size > TSC_RECORD_SIZE &&
+        fseek(reader->file, reader->record_size - TSC_RECORD_SIZE, SEEK_CUR) != 0) {
+        return -1;
+    }
+    record->pts = (int64_t)((uint64_t)get32(in) | (uint64_t)get32(in + 4) << 32);
+    record->status = get32(in + 8);
+    record->x = getfloat(in + 12);
+    record->y = getfloat(in + 16);
+    record->width = getfloat(in + 20);
+    record->height = getfloat(in + 24);
+    record->rate = getfloat(in + 28);
+    return 1;
+}
+
+void tsc_free(tsc_reader *reader) {
+    if (reader) {
+        fclose(reader->file);
+        free(reader);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  track_sidecar.h
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Tracking results next to a recorded video, keyed by presentation time of the video frames
+ *
+ *  file (little endian): header of TSC_HEADER_SIZE bytes, then one TSC_RECORD_SIZE record per tracked frame
+ *  header: 0..3 magic 'OTTS', 4..5 version, 6..7 record size, 8..11 timescale (pts units per second),
+ *          12..15 width, 16..19 height of the tracked frames, 20..23 zero
+ *  record: 0..7 pts (int64), 8..11 status, 12..27 x, y, width, height (float), 28..31 gimbal rate (float)
+ *  records are appended in pts order, the file is valid up to the last whole record even after a crash
+ */
+
+#ifndef track_sidecar_h
+#define track_sidecar_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TSC_VERSION 1
+#define TSC_HEADER_SIZE 24
+#define TSC_RECORD_SIZE 32
+
+enum {
+    TSC_NONE = 0,   /* no target selected */
+    TSC_LOST = 1,
+    TSC_TRACKED = 2
+};
+
+typedef struct {
+    uint32_t timescale;
+    uint32_t width;
+    uint32_t height;
+} tsc_header;
+
+typedef struct {
+    int64_t pts;
+    uint32_t status;
+    float x, y, width, height;
+    float rate;
+} tsc_record;
+
+typedef struct tsc_writer tsc_writer;
+typedef struct tsc_reader tsc_reader;
+
+/* records go through one big stdio buffer, the disk sees few sequential writes instead of one per frame */
+tsc_writer *tsc_create(const char *path, const tsc_header *header);
+int tsc_write(tsc_writer *writer, const tsc_record *record);
+/* flushes, 0 when everything reached the file */
+int tsc_close(tsc_writer *writer);
+
+tsc_reader *tsc_open(const char *path, tsc_header *header);
+/* 1 record read, 0 end of file (or a torn last record), -1 error */
+int tsc_read(tsc_reader *reader, tsc_record *record);
+void tsc_free(tsc_reader *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* track_sidecar_h */
@@ -0,0 +1,94 @@
+//
+//  downscalebench.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Fixed size downscale kernels of FramePreprocess.hpp against downscaleGrayGeneric, exit 1 if they differ
+//
+//  usage: downscalebench [--runs=200]
+//  every 720p and 1080p RGBA size and scale selectDownscale specializes, per frame time of both kernels
+//  (best of 5 rounds of runs frames) and the output of the two compared byte by byte
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "FramePreprocess.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int ROUNDS = 5;
+
+struct Frame {
+    int width, height, scale;
+};
+
+const Frame frames[] = {
+    { 1280, 720, 3 }, { 1280, 720, 4 }, { 1280, 720, 5 },
+    { 1920, 1080, 3 }, { 1920, 1080, 4 }, { 1920, 1080, 5 },
+};
+
+// ms per frame, best round so other processes count less
+double time(prep::DownscaleFn fn, const std::vector<uint8_t> &src, const Frame &f,
+            std::vector<uint8_t> &dst, int runs) {
+    const size_t srcStep = (size_t)f.width * 4, dstStep = (size_t)(f.width / f.scale);
+    double best = 1e30;
+    for (int round = 0; round < ROUNDS; round++) {
+        auto start = Clock::now();
+        for (int i = 0; i < runs; i++) {
+            fn(src.data(), srcStep, f.width, f.height, 4, f.scale, dst.data(), dstStep);
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / runs;
+        best = std::min(best, ms);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char **argv) {
+    int runs = 200;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--runs=", 7) == 0) runs = atoi(argv[i] + 7);
+    }
+    if (runs < 1) {
+        fprintf(stderr, "usage: downscalebench [--runs=200]\n");
+        return 1;
+    }
+
+    int failures = 0;
+    printf("%-16s %10s %10s %8s\n", "frame", "fixed ms", "generic ms", "gain");
+    for (const Frame &f : frames) {
+        std::vector<uint8_t> src((size_t)f.width * f.height * 4);
+        uint32_t state = 12345;
+        for (uint8_t &b : src) {
+            state = state * 1664525u + 1013904223u;
+            b = (uint8_t)(state >> 24);
+        }
+        const size_t dstSize = (size_t)(f.width / f.scale) * (f.height / f.scale);
+        std::vector<uint8_t> fixed(dstSize), generic(dstSize);
+
+        prep::DownscaleFn fn = prep::selectDownscale(f.width, f.height, 4, f.scale);
+        if (fn == &prep::downscaleGrayGeneric) {
+            printf("%dx%d /%d has no fixed kernel\n", f.width, f.height, f.scale);
+            failures++;
+            continue;
+        }
+        double fixedMs = time(fn, src, f, fixed, runs);
+        double genericMs = time(&prep::downscaleGrayGeneric, src, f, generic, runs);
+        if (fixed != generic) {
+            printf("%dx%d /%d: fixed and generic output differ\n", f.width, f.height, f.scale);
+            failures++;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d /%d", f.width, f.height, f.scale);
+        printf("%-16s %10.3f %10.3f %7.1f%%\n", name, fixedMs, genericMs, 100.0 * (genericMs - fixedMs) / genericMs);
+    }
+    return failures ? 1 : 0;
+}
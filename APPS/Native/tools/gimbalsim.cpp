@@ -0,0 +1,211 @@
+//
+//  gimbalsim.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Deterministic gimbal simulation for tuning GimbalController against recorded or synthetic tracks
+//
+//  usage: gimbalsim [track.csv] [--kp=1.2 --ki=0.3 --kd=0 --kff=0.8 --rate=1 --accel=4 --deadband=0.08 --alpha=0.1]
+//                   [--fps=30 --latency=0.1 --control-latency=latency --lag=0.1 --bangbang --trace=out.csv]
+//  track.csv lines: time in seconds, target position in percent of a still camera frame
+//  without a file a fixed synthetic track is used (moves, stops, turns back)
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "GimbalController.hpp"
+
+namespace {
+
+struct Sample {
+    double time;
+    double position; // frame widths from the center of a camera looking straight ahead
+};
+
+std::vector<Sample> synthetic() {
+    std::vector<Sample> track;
+    double x = 0;
+    for (int i = 0; i <= 30 * 40; i++) {
+        double t = i / 30.0;
+        double v = 0;
+        if (t < 5) v = 0;
+        else if (t < 12) v = 0.15;
+        else if (t < 16) v = 0;
+        else if (t < 20) v = -0.35;
+        else if (t < 26) v = 0.05 * std::sin(t * 2);
+        else if (t < 32) v = 0.25;
+        x += v / 30.0;
+        track.push_back({t, x});
+    }
+    return track;
+}
+
+bool load(const char *path, std::vector<Sample> &track) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    double t, p;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%lf,%lf", &t, &p) == 2) {
+            track.push_back({t, (p - 50) / 100});
+        }
+    }
+    fclose(file);
+    return !track.empty();
+}
+
+//target position at time t, linear between samples
+double targetAt(const std::vector<Sample> &track, size_t &index, double t) {
+    while (index + 1 < track.size() && track[index + 1].time <= t) {
+        index++;
+    }
+    if (index + 1 >= track.size()) {
+        return track.back().position;
+    }
+    const Sample &a = track[index], &b = track[index + 1];
+    double u = (t - a.time) / (b.time - a.time);
+    return a.position + (b.position - a.position) * std::max(0.0, std::min(1.0, u));
+}
+
+//the old CAMViewController.ruch: l / r / b when the target crosses 40 / 60 percent, sent after 0.2 s
+struct BangBang {
+    double speed;
+    double pending = 0, pendingAt = -1;
+    double rate = 0;
+    bool move = false;
+
+    double update(double time, double position) {
+        if (pendingAt >= 0 && time >= pendingAt) {
+            rate = pending;
+            move = rate != 0;
+            pendingAt = -1;
+        }
+        if (pendingAt < 0) {
+            if (position < 40 && !move) { pending = -speed; pendingAt = time + 0.2; }
+            if (position > 60 && !move) { pending = speed; pendingAt = time + 0.2; }
+            if (position >= 40 && position <= 60 && move) { pending = 0; pendingAt = time + 0.2; }
+        }
+        return rate;
+    }
+};
+
+double arg(const char *a, const char *name, double value) {
+    size_t n = strlen(name);
+    if (strncmp(a, name, n) == 0 && a[n] == '=') {
+        return atof(a + n + 1);
+    }
+    return value;
+}
+
+}
+
+int main(int argc, char **argv) {
+    ctrl::ControllerConfig cfg;
+    double fps = 30, latency = 0.1, lag = 0.1, controlLatency = -1;
+    bool bangbang = false;
+    std::string tracePath;
+    std::vector<Sample> track;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--", 2) != 0) {
+            if (!load(a, track)) {
+                fprintf(stderr, "cant read track %s\n", a);
+                return 2;
+            }
+            continue;
+        }
+        cfg.kp = arg(a, "--kp", cfg.kp);
+        cfg.ki = arg(a, "--ki", cfg.ki);
+        cfg.kd = arg(a, "--kd", cfg.kd);
+        cfg.kff = arg(a, "--kff", cfg.kff);
+        cfg.maxRate = arg(a, "--rate", cfg.maxRate);
+        cfg.maxAccel = arg(a, "--accel", cfg.maxAccel);
+        cfg.deadband = arg(a, "--deadband", cfg.deadband);
+        cfg.velocityAlpha = arg(a, "--alpha", cfg.velocityAlpha);
+        fps = arg(a, "--fps", fps);
+        latency = arg(a, "--latency", latency);
+        controlLatency = arg(a, "--control-latency", controlLatency);
+        lag = arg(a, "--lag", lag);
+        if (strcmp(a, "--bangbang") == 0) bangbang = true;
+        if (strncmp(a, "--trace=", 8) == 0) tracePath = a + 8;
+    }
+    if (track.empty()) {
+        track = synthetic();
+    }
+    //controller is told the real latency unless a wrong estimate is tested
+    cfg.latency = controlLatency < 0 ? latency : controlLatency;
+
+    FILE *trace = tracePath.empty() ? nullptr : fopen(tracePath.c_str(), "w");
+    if (trace) {
+        fprintf(trace, "time,target,camera,seen,setpoint\n");
+    }
+
+    ctrl::GimbalController controller(cfg);
+    BangBang old{cfg.maxRate};
+    const double step = 0.001; // physics step
+    const double frame = 1 / fps;
+    double camera = 0, motorRate = 0, setpoint = 0, lastSent = 0, lastDirection = 0, nextFrame = 0;
+    double sumSq = 0, worst = 0;
+    int frames = 0, lostFrames = 0, writes = 0, reversals = 0;
+    size_t index = 0;
+    std::deque<std::pair<double, double>> delayed; // (time available, position percent)
+
+    const double end = track.back().time;
+    for (double t = track.front().time; t <= end; t += step) {
+        double target = targetAt(track, index, t);
+        //motor follows the setpoint with first order lag, camera angle in frame widths
+        motorRate += (setpoint - motorRate) * std::min(1.0, step / lag);
+        camera += motorRate * step;
+
+        if (t >= nextFrame) {
+            nextFrame += frame;
+            double seen = 50 + 100 * (target - camera);
+            bool inFrame = seen >= 0 && seen <= 100;
+            frames++;
+            if (!inFrame) lostFrames++;
+            sumSq += (seen - 50) * (seen - 50);
+            worst = std::max(worst, std::fabs(seen - 50));
+            //tracker result is ready after the processing latency
+            delayed.push_back({t + latency, inFrame ? seen : -1});
+            if (trace) {
+                fprintf(trace, "%.3f,%.4f,%.4f,%.2f,%.4f\n", t, target, camera, seen, setpoint);
+            }
+        }
+        while (!delayed.empty() && delayed.front().first <= t) {
+            double seen = delayed.front().second;
+            delayed.pop_front();
+            double next = bangbang ? old.update(t, seen < 0 ? 50 : seen)
+                                   : controller.update(t, seen < 0 ? 50 : seen, seen >= 0);
+            setpoint = next;
+            if (setpoint != 0) {
+                double direction = setpoint > 0 ? 1 : -1;
+                if (direction == -lastDirection) {
+                    reversals++;
+                }
+                lastDirection = direction;
+            }
+            //a write is needed when the command changes noticeably
+            if (std::fabs(setpoint - lastSent) > 0.02 || (setpoint == 0 && lastSent != 0)) {
+                writes++;
+                lastSent = setpoint;
+            }
+        }
+    }
+    if (trace) {
+        fclose(trace);
+    }
+
+    printf("%s: %d frames, error rms %.1f%% max %.1f%%, out of frame %d, direction changes %d, writes %d (%.1f/s)\n",
+           bangbang ? "bang-bang" : "pid", frames, std::sqrt(sumSq / frames), worst, lostFrames, reversals, writes,
+           writes / (end - track.front().time));
+    return 0;
+}
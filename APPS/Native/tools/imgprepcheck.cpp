@@ -0,0 +1,149 @@
+//
+//  imgprepcheck.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Checks imgprep against the java conversions it replaces, exit 1 on a failure
+//
+//  the java code reads ARGB ints from Bitmap.getPixels: ImageClassifierQuantizedMobileNet.addPixelValue for
+//  uint8 RGB and EmbeddingModel.put for (2/255) * x - 1 in BGR order, resized as x * w / SIZE, y * h / SIZE
+//  odd widths and heights, padded strides (filled with a pattern that must not show up) and 1:1 and resized
+//  outputs are compared, bytes after the output must stay untouched
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "ImagePreprocess.hpp"
+
+namespace {
+
+const uint8_t PAD = 0xA5;
+const size_t GUARD = 64;
+
+int failures = 0;
+
+void fail(int srcw, int srch, size_t stride, int dstw, int dsth, const char *what, double value) {
+    if (failures++ < 20) {
+        printf("FAIL %dx%d stride %zu to %dx%d: %s (%g)\n", srcw, srch, stride, dstw, dsth, what, value);
+    }
+}
+
+// RGBA_8888 bitmap memory with padding after every row
+struct Bitmap {
+    int width, height;
+    size_t stride;
+    std::vector<uint8_t> bytes;
+
+    Bitmap(int w, int h, size_t padding) : width(w), height(h), stride((size_t)w * 4 + padding),
+                                           bytes(stride * h, PAD) {
+        uint32_t state = (uint32_t)(w * 7919 + h * 104729 + padding);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w * 4; x++) {
+                state = state * 1664525u + 1013904223u;
+                bytes[y * stride + x] = (uint8_t)(state >> 24);
+            }
+        }
+    }
+
+    // what Bitmap.getPixels gives java, 0xAARRGGBB
+    int argb(int x, int y) const {
+        const uint8_t *p = &bytes[y * stride + (size_t)x * 4];
+        return (int)((uint32_t)p[3] << 24 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]);
+    }
+};
+
+// ImageClassifierQuantizedMobileNet.addPixelValue over the resized pixels
+void javaRgb(const Bitmap &src, std::vector<uint8_t> &out, int dstw, int dsth) {
+    out.clear();
+    for (int y = 0; y < dsth; y++) {
+        for (int x = 0; x < dstw; x++) {
+            int val = src.argb(x * src.width / dstw, y * src.height / dsth);
+            out.push_back((uint8_t)((val >> 16) & 0xFF));
+            out.push_back((uint8_t)((val >> 8) & 0xFF));
+            out.push_back((uint8_t)(val & 0xFF));
+        }
+    }
+}
+
+// EmbeddingModel.put
+void javaFloat(const Bitmap &src, std::vector<float> &out, int dstw, int dsth) {
+    out.clear();
+    for (int y = 0; y < dsth; y++) {
+        for (int x = 0; x < dstw; x++) {
+            int val = src.argb(x * src.width / dstw, y * src.height / dsth);
+            out.push_back((val & 0xFF) * (2.0f / 255.0f) - 1.0f);
+            out.push_back(((val >> 8) & 0xFF) * (2.0f / 255.0f) - 1.0f);
+            out.push_back(((val >> 16) & 0xFF) * (2.0f / 255.0f) - 1.0f);
+        }
+    }
+}
+
+void check(const Bitmap &src, int dstw, int dsth) {
+    const size_t n = (size_t)dstw * dsth * 3;
+    std::vector<uint8_t> expectRgb, rgb(n + GUARD, PAD);
+    std::vector<float> expectFloat, floats(n + GUARD, 1234.0f);
+    javaRgb(src, expectRgb, dstw, dsth);
+    javaFloat(src, expectFloat, dstw, dsth);
+
+    imgprep::rgbaToRgb(src.bytes.data(), src.stride, src.width, src.height, rgb.data(), dstw, dsth);
+    for (size_t i = 0; i < n; i++) {
+        if (rgb[i] != expectRgb[i]) {
+            fail(src.width, src.height, src.stride, dstw, dsth, "rgb differs at", (double)i);
+            break;
+        }
+    }
+    for (size_t i = n; i < n + GUARD; i++) {
+        if (rgb[i] != PAD) {
+            fail(src.width, src.height, src.stride, dstw, dsth, "rgb written past the end", (double)(i - n));
+            break;
+        }
+    }
+
+    // neon multiply-add may round once where java rounds twice
+    imgprep::rgbaToFloat(src.bytes.data(), src.stride, src.width, src.height, floats.data(), dstw, dsth,
+                         2.0f / 255.0f, -1.0f, true);
+    for (size_t i = 0; i < n; i++) {
+        if (std::fabs(floats[i] - expectFloat[i]) > 1e-6f) {
+            fail(src.width, src.height, src.stride, dstw, dsth, "float differs at", (double)i);
+            break;
+        }
+    }
+    for (size_t i = n; i < n + GUARD; i++) {
+        if (floats[i] != 1234.0f) {
+            fail(src.width, src.height, src.stride, dstw, dsth, "float written past the end", (double)(i - n));
+            break;
+        }
+    }
+}
+
+}
+
+int main() {
+    // around the 16 and 8 pixel neon steps, odd, and the net input sizes
+    const int sizes[] = { 1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 127, 224, 299, 300 };
+    const size_t paddings[] = { 0, 4, 12, 60 };
+    int cases = 0;
+
+    for (int w : sizes) {
+        for (size_t padding : paddings) {
+            Bitmap src(w, w % 2 ? w + 2 : w + 1, padding);
+            check(src, src.width, src.height);
+            check(src, 300, 300);
+            check(src, 64, 64);
+            check(src, 17, 5);
+            cases += 4;
+        }
+    }
+    // downscale of a camera frame and a crop narrower than the output
+    Bitmap frame(1279, 719, 36), crop(41, 97, 8);
+    check(frame, 300, 300);
+    check(crop, 64, 64);
+    cases += 2;
+
+    printf("%d conversions\n", cases);
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+//
+//  modelbench.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Startup time of models.bin mapped by ModelPack against reading every model into memory
+//
+//  usage: modelbench models.bin [--runs=5]
+//  cold: file pages are dropped from the page cache first (posix_fadvise, works for files not open elsewhere)
+//  open: header and entry table only, touch: first access of every model page (what the first inference does)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+#include "ModelPack.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double ms(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+void dropCache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+// one byte per page is enough to fault the whole model in
+unsigned touch(const model::Blob &blob) {
+    const volatile uint8_t *p = (const uint8_t *)blob.data;
+    unsigned sum = 0;
+    for (size_t i = 0; i < blob.size; i += 4096) {
+        sum += p[i];
+    }
+    return sum;
+}
+
+struct Result {
+    double open = 0, touch = 0, read = 0;
+};
+
+bool mapped(const char *path, Result &result, unsigned &sink) {
+    model::ModelPack pack;
+    auto start = Clock::now();
+    if (!pack.open(path)) {
+        fprintf(stderr, "%s: %s\n", path, pack.error());
+        return false;
+    }
+    result.open += ms(start);
+    start = Clock::now();
+    for (int i = 0; i < pack.count(); i++) {
+        sink += touch(pack.find(pack.name(i)));
+    }
+    result.touch += ms(start);
+    return true;
+}
+
+// what loading without the pack costs: whole file read into a heap buffer
+bool copied(const char *path, Result &result, unsigned &sink) {
+    auto start = Clock::now();
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    sink += data.empty() ? 0 : data[data.size() / 2];
+    result.read += ms(start);
+    return true;
+}
+
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    int runs = 5;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--runs=", 7) == 0) runs = atoi(argv[i] + 7);
+        else path = argv[i];
+    }
+    if (!path || runs < 1) {
+        fprintf(stderr, "usage: modelbench models.bin [--runs=5]\n");
+        return 2;
+    }
+
+    unsigned sink = 0;
+    model::ModelPack pack;
+    if (!pack.open(path)) {
+        fprintf(stderr, "%s: %s\n", path, pack.error());
+        return 1;
+    }
+    printf("%s: %d models, %zu bytes\n", path, pack.count(), pack.size());
+    pack.close();
+
+    for (int cold = 1; cold >= 0; cold--) {
+        Result result;
+        for (int r = 0; r < runs; r++) {
+            if (cold) dropCache(path);
+            if (!mapped(path, result, sink)) return 1;
+            if (cold) dropCache(path);
+            if (!copied(path, result, sink)) return 1;
+        }
+        printf("%s: mapped open %.3f ms + first touch %.2f ms, read %.2f ms\n", cold ? "cold" : "warm",
+               result.open / runs, result.touch / runs, result.read / runs);
+    }
+    return sink == 0xFFFFFFFF ? 1 : 0; // keeps the reads
+}
@@ -0,0 +1,303 @@
+//
+//  pipelinebench.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Runs the coroutine pipeline (pipeline/Pipeline.hpp) on synthetic targets and checks per target order
+//
+//  usage: pipelinebench [--targets=4 --frames=300 --threads=hardware --deadline=100 --queue=4 --cancel-after=0]
+//                       [--metrics=9100 or unix:/path --hold=0]
+//  every target is a 1280x720 RGBA camera with a bright square moving left and right,
+//  stages: ingest -> preprocess (downscale to gray) -> track (centroid) -> control (GimbalController) -> record
+//  deadline is in ms from ingest, late frames are dropped before control, --cancel-after stops all targets
+//  after that many recorded frames; exit code 1 when a target got its results out of order
+//  --metrics serves Prometheus text while running, --hold keeps serving that many seconds after the run
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <latch>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "FramePreprocess.hpp"
+#include "GimbalController.hpp"
+#include "Metrics.hpp"
+#include "MetricsServer.hpp"
+#include "Pipeline.hpp"
+
+namespace {
+
+const int WIDTH = 1280, HEIGHT = 720, SCALE = 4;
+const int SQUARE = 64;
+const double FPS = 30;
+
+struct Frame {
+    int sequence = 0;
+    double time = 0; // camera time in seconds
+    flow::Clock::time_point captured;
+    flow::Clock::time_point deadline;
+    std::vector<uint8_t> pixels; // RGBA, then gray after preprocess
+    double position = 50; // percent like trk_position
+    bool tracked = false;
+    double confidence = 0;
+    double rate = 0;
+};
+
+struct Settings {
+    int frames = 300;
+    int deadlineMs = 100;
+    size_t queue = 4;
+    int cancelAfter = 0;
+};
+
+struct Target {
+    Target(flow::Executor &executor, size_t queue, int id)
+        : id(id), raw(executor, queue), gray(executor, queue), found(executor, queue), commands(executor, queue) {}
+
+    int id;
+    flow::Channel<Frame> raw, gray, found, commands;
+    ctrl::GimbalController controller;
+    int recorded = 0, dropped = 0, outOfOrder = 0, lastSequence = -1;
+    std::vector<double> latencies; // ms from ingest to record
+    int framesMetric = -1, droppedMetric = -1;
+};
+
+// stage timings are shared by all targets, per target series only for counts and queues
+struct Stats {
+    int preprocess, track, control, total, confidence;
+
+    Stats() {
+        metrics::Registry &registry = metrics::Registry::global();
+        const char *help = "time spent in one pipeline stage in ms";
+        preprocess = registry.histogram("tracker_stage_latency_ms", help, "stage=\"preprocess\"", metrics::latencyBuckets());
+        track = registry.histogram("tracker_stage_latency_ms", help, "stage=\"track\"", metrics::latencyBuckets());
+        control = registry.histogram("tracker_stage_latency_ms", help, "stage=\"control\"", metrics::latencyBuckets());
+        total = registry.histogram("tracker_frame_latency_ms", "ingest to record in ms", "", metrics::latencyBuckets());
+        confidence = registry.histogram("tracker_confidence", "tracker confidence of recorded frames", "",
+                                        {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1});
+    }
+};
+
+double since(flow::Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(flow::Clock::now() - start).count();
+}
+
+struct Shared {
+    Settings settings;
+    Stats stats;
+    flow::CancelToken cancel;
+    std::atomic<int> recorded{0};
+};
+
+// square position of the target at frame i, every target moves with its own phase
+int squareX(int id, int i) {
+    double u = 0.5 + 0.4 * std::sin(i / FPS * 1.5 + id);
+    return (int)(u * (WIDTH - SQUARE));
+}
+
+flow::Task ingest(Target &target, Shared &shared) {
+    for (int i = 0; i < shared.settings.frames && !shared.cancel.cancelled(); i++) {
+        Frame frame;
+        frame.sequence = i;
+        frame.time = i / FPS;
+        frame.captured = flow::Clock::now();
+        frame.deadline = frame.captured + std::chrono::milliseconds(shared.settings.deadlineMs);
+        frame.pixels.assign((size_t)WIDTH * HEIGHT * 4, 30);
+        int x0 = squareX(target.id, i), y0 = (HEIGHT - SQUARE) / 2;
+        for (int y = y0; y < y0 + SQUARE; y++) {
+            std::memset(&frame.pixels[((size_t)y * WIDTH + x0) * 4], 230, SQUARE * 4);
+        }
+        if (!co_await target.raw.push(std::move(frame))) {
+            break;
+        }
+    }
+    target.raw.close();
+}
+
+flow::Task preprocess(Target &target, Shared &shared) {
+    std::vector<uint8_t> gray((size_t)(WIDTH / SCALE) * (HEIGHT / SCALE));
+    prep::DownscaleFn downscale = prep::selectDownscale(WIDTH, HEIGHT, 4, SCALE);
+    while (std::optional<Frame> frame = co_await target.raw.pop()) {
+        auto start = flow::Clock::now();
+        downscale(frame->pixels.data(), WIDTH * 4, WIDTH, HEIGHT, 4, SCALE, gray.data(), WIDTH / SCALE);
+        frame->pixels.swap(gray);
+        gray.resize((size_t)(WIDTH / SCALE) * (HEIGHT / SCALE));
+        metrics::Registry::global().observe(shared.stats.preprocess, since(start));
+        if (!co_await target.gray.push(std::move(*frame))) {
+            break;
+        }
+    }
+    target.gray.close();
+}
+
+// stand-in for the engine: centroid of bright pixels, enough to exercise the stage without OpenCV
+flow::Task track(Target &target, Shared &shared) {
+    const int w = WIDTH / SCALE, h = HEIGHT / SCALE;
+    const int area = (SQUARE / SCALE) * (SQUARE / SCALE);
+    while (std::optional<Frame> frame = co_await target.gray.pop()) {
+        auto start = flow::Clock::now();
+        long sum = 0, count = 0;
+        for (int y = 0; y < h; y++) {
+            const uint8_t *row = &frame->pixels[(size_t)y * w];
+            for (int x = 0; x < w; x++) {
+                if (row[x] > 128) {
+                    sum += x;
+                    count++;
+                }
+            }
+        }
+        frame->tracked = count > 0;
+        frame->position = count ? 100.0 * sum / count / w : 50;
+        frame->confidence = std::min(1.0, (double)count / area);
+        metrics::Registry::global().observe(shared.stats.track, since(start));
+        if (!co_await target.found.push(std::move(*frame))) {
+            break;
+        }
+    }
+    target.found.close();
+}
+
+// late results are not sent, the gimbal already moved on newer ones
+flow::Task control(Target &target, Shared &shared) {
+    while (std::optional<Frame> frame = co_await target.found.pop()) {
+        if (flow::expired(frame->deadline)) {
+            target.dropped++;
+            metrics::Registry::global().add(target.droppedMetric);
+            continue;
+        }
+        auto start = flow::Clock::now();
+        frame->rate = target.controller.update(frame->time, frame->position, frame->tracked);
+        metrics::Registry::global().observe(shared.stats.control, since(start));
+        if (!co_await target.commands.push(std::move(*frame))) {
+            break;
+        }
+    }
+    target.commands.close();
+}
+
+flow::Task record(Target &target, Shared &shared) {
+    while (std::optional<Frame> frame = co_await target.commands.pop()) {
+        if (frame->sequence <= target.lastSequence) {
+            target.outOfOrder++;
+        }
+        target.lastSequence = frame->sequence;
+        target.recorded++;
+        target.latencies.push_back(since(frame->captured));
+        metrics::Registry &registry = metrics::Registry::global();
+        registry.add(target.framesMetric);
+        registry.observe(shared.stats.total, target.latencies.back());
+        registry.observe(shared.stats.confidence, frame->confidence);
+        int total = ++shared.recorded;
+        if (shared.settings.cancelAfter > 0 && total >= shared.settings.cancelAfter) {
+            shared.cancel.cancel();
+        }
+    }
+}
+
+int arg(const char *a, const char *name, int value) {
+    size_t n = strlen(name);
+    if (strncmp(a, name, n) == 0 && a[n] == '=') {
+        return atoi(a + n + 1);
+    }
+    return value;
+}
+
+}
+
+int main(int argc, char **argv) {
+    Shared shared;
+    int targets = 4;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int hold = 0;
+    const char *address = nullptr;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--metrics=", 10) == 0) address = a + 10;
+        hold = arg(a, "--hold", hold);
+        targets = arg(a, "--targets", targets);
+        threads = arg(a, "--threads", threads);
+        shared.settings.frames = arg(a, "--frames", shared.settings.frames);
+        shared.settings.deadlineMs = arg(a, "--deadline", shared.settings.deadlineMs);
+        shared.settings.queue = (size_t)arg(a, "--queue", (int)shared.settings.queue);
+        shared.settings.cancelAfter = arg(a, "--cancel-after", shared.settings.cancelAfter);
+    }
+
+    flow::Executor executor((unsigned)threads);
+    std::vector<std::unique_ptr<Target>> all;
+    for (int i = 0; i < targets; i++) {
+        all.push_back(std::make_unique<Target>(executor, shared.settings.queue, i));
+    }
+
+    metrics::Registry &registry = metrics::Registry::global();
+    for (auto &target : all) {
+        Target *t = target.get();
+        std::string session = "session=\"" + std::to_string(t->id) + "\"";
+        t->framesMetric = registry.counter("tracker_frames_total", "frames with a gimbal command", session);
+        t->droppedMetric = registry.counter("tracker_dropped_frames_total", "frames dropped before control",
+                                            session + ",reason=\"deadline\"");
+        // frames per second since the previous scrape
+        registry.gauge("tracker_fps", "recorded frames per second since the last scrape", session,
+                       [t, last = (uint64_t)0, lastTime = flow::Clock::now()]() mutable {
+                           uint64_t frames = metrics::Registry::global().total(t->framesMetric);
+                           double seconds = std::chrono::duration<double>(flow::Clock::now() - lastTime).count();
+                           double fps = seconds > 0 ? (frames - last) / seconds : 0;
+                           last = frames;
+                           lastTime = flow::Clock::now();
+                           return fps;
+                       });
+        const char *help = "frames waiting in front of a stage";
+        registry.gauge("tracker_queue_depth", help, session + ",queue=\"raw\"", [t] { return (double)t->raw.size(); });
+        registry.gauge("tracker_queue_depth", help, session + ",queue=\"gray\"", [t] { return (double)t->gray.size(); });
+        registry.gauge("tracker_queue_depth", help, session + ",queue=\"found\"", [t] { return (double)t->found.size(); });
+        registry.gauge("tracker_queue_depth", help, session + ",queue=\"commands\"", [t] { return (double)t->commands.size(); });
+    }
+    registry.gauge("process_resident_memory_bytes", "resident memory of the process", "", &metrics::residentBytes);
+    metrics::Server server;
+    if (address && !server.start(address)) {
+        fprintf(stderr, "metrics: %s\n", server.error().c_str());
+        return 2;
+    }
+
+    auto start = flow::Clock::now();
+    std::latch done(targets * 5);
+    for (auto &target : all) {
+        flow::spawn(executor, ingest(*target, shared), done);
+        flow::spawn(executor, preprocess(*target, shared), done);
+        flow::spawn(executor, track(*target, shared), done);
+        flow::spawn(executor, control(*target, shared), done);
+        flow::spawn(executor, record(*target, shared), done);
+    }
+    done.wait();
+    double seconds = std::chrono::duration<double>(flow::Clock::now() - start).count();
+
+    int recorded = 0, dropped = 0, outOfOrder = 0;
+    std::vector<double> latencies;
+    for (auto &target : all) {
+        recorded += target->recorded;
+        dropped += target->dropped;
+        outOfOrder += target->outOfOrder;
+        latencies.insert(latencies.end(), target->latencies.begin(), target->latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double p50 = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+    double p99 = latencies.empty() ? 0 : latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+
+    printf("%d targets on %zu threads: %d frames recorded in %.2f s (%.1f fps), %d past deadline, %s\n",
+           targets, executor.threads(), recorded, seconds, recorded / seconds, dropped,
+           shared.cancel.cancelled() ? "cancelled" : "complete");
+    printf("latency ingest -> record: p50 %.1f ms, p99 %.1f ms, out of order %d\n", p50, p99, outOfOrder);
+    if (address && hold > 0) {
+        printf("serving metrics on %s for %d s\n", address, hold);
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::seconds(hold));
+    }
+    server.stop();
+    return outOfOrder ? 1 : 0;
+}
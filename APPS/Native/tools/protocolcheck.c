@@ -0,0 +1,238 @@
+/*
+ *  protocolcheck.c
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Checks gimbal_protocol.c, exit 1 on a failure
+ *  every type goes through encode and decode, every single bit error of a frame has to be caught by the crc,
+ *  the receiver drops duplicates and older frames across the sequence wrap, the sender suppresses small
+ *  changes, merges setpoints coming faster than the connection interval and repeats after the keepalive
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gimbal_protocol.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what, long value)
+{
+    if (!ok && failures++ < 20) {
+        printf("FAIL %s (%ld)\n", what, value);
+    }
+}
+
+static gp_command command(uint8_t type, uint8_t seq, uint16_t time_ms, int16_t value, int16_t velocity)
+{
+    gp_command cmd;
+    cmd.type = type;
+    cmd.seq = seq;
+    cmd.time_ms = time_ms;
+    cmd.value = value;
+    cmd.velocity = velocity;
+    return cmd;
+}
+
+static void round_trip(void)
+{
+    static const int16_t values[] = { 0, 1, -1, 999, -1000, 32767, -32768 };
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    gp_command in, out;
+    size_t size, v;
+    uint8_t type;
+
+    for (type = GP_STOP; type <= GP_TRACK; type++) {
+        for (v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+            in = command(type, (uint8_t)(v * 37), (uint16_t)(v * 9000), values[v], values[(v + 3) % 7]);
+            size = gp_encode(&in, frame);
+            check(size == gp_frame_size(type), "encoded size", (long)size);
+            check(size == (type == GP_TRACK ? GP_TRACK_FRAME_SIZE : GP_FRAME_SIZE), "frame size of type", type);
+            memset(&out, 0x55, sizeof(out));
+            check(gp_decode(frame, size, &out) == GP_OK, "decode", type);
+            check(out.type == in.type && out.seq == in.seq && out.time_ms == in.time_ms, "header round trip", type);
+            check(out.value == in.value, "value round trip", in.value);
+            /* only GP_TRACK carries a velocity */
+            check(out.velocity == (type == GP_TRACK ? in.velocity : 0), "velocity round trip", out.velocity);
+        }
+    }
+}
+
+static void corruption(void)
+{
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    gp_command cmd = command(GP_TRACK, 12, 3456, -789, 321), out;
+    size_t size, i;
+    int bit, result;
+    uint8_t type;
+
+    for (type = GP_STOP; type <= GP_TRACK; type++) {
+        cmd.type = type;
+        size = gp_encode(&cmd, frame);
+        for (i = 0; i < size; i++) {
+            for (bit = 0; bit < 8; bit++) {
+                frame[i] ^= (uint8_t)(1 << bit);
+                result = gp_decode(frame, size, &out);
+                check(result == GP_ERR_CRC, "single bit error accepted", (long)(i * 8 + bit));
+                frame[i] ^= (uint8_t)(1 << bit);
+            }
+        }
+        check(gp_decode(frame, size - 1, &out) == GP_ERR_LENGTH, "short frame", type);
+    }
+
+    /* valid crc, the rest wrong */
+    cmd.type = GP_TRACK + 1;
+    size = gp_encode(&cmd, frame);
+    check(gp_decode(frame, size, &out) == GP_ERR_TYPE, "unknown type", cmd.type);
+    cmd.type = GP_VELOCITY;
+    gp_encode(&cmd, frame);
+    frame[0] = GP_TRACK;
+    frame[GP_FRAME_SIZE - 1] = gp_crc8(frame, GP_FRAME_SIZE - 1);
+    check(gp_decode(frame, GP_FRAME_SIZE, &out) == GP_ERR_LENGTH, "GP_TRACK in a short frame", 0);
+}
+
+static int receive(gp_receiver *receiver, uint8_t seq)
+{
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    gp_command cmd = command(GP_VELOCITY, seq, 0, 100, 0), out;
+    size_t size = gp_encode(&cmd, frame);
+    int result = gp_receive(receiver, frame, size, &out);
+    if (result == GP_OK) {
+        check(out.seq == seq, "received seq", seq);
+    }
+    return result;
+}
+
+static void sequence(void)
+{
+    gp_receiver receiver;
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    gp_command cmd, out;
+    int seq;
+
+    gp_receiver_init(&receiver);
+    /* anything is accepted first */
+    check(receive(&receiver, 200) == GP_OK, "first frame", 200);
+    check(receive(&receiver, 200) == GP_ERR_OLD, "duplicate", 200);
+    check(receive(&receiver, 199) == GP_ERR_OLD, "older", 199);
+    check(receive(&receiver, 200 - 127) == GP_ERR_OLD, "much older", 200 - 127);
+    check(receive(&receiver, 203) == GP_OK, "gap", 203);
+    check(receive(&receiver, 201) == GP_ERR_OLD, "late after gap", 201);
+
+    /* through the wrap one by one, then the stale ones from before it */
+    for (seq = 204; seq < 256 + 10; seq++) {
+        check(receive(&receiver, (uint8_t)seq) == GP_OK, "seq across wrap", seq);
+    }
+    check(receive(&receiver, 255) == GP_ERR_OLD, "pre-wrap frame after wrap", 255);
+    check(receive(&receiver, 9) == GP_ERR_OLD, "duplicate after wrap", 9);
+    /* up to half of the range ahead is newer, a jump over the wrap included */
+    check(receive(&receiver, 9 + 128) == GP_OK, "half range ahead", 9 + 128);
+    check(receive(&receiver, (uint8_t)(9 + 128 + 127)) == GP_OK, "jump over wrap", (9 + 128 + 127) & 0xFF);
+
+    /* a corrupted frame does not move the last seq */
+    cmd = command(GP_STOP, 10, 0, 0, 0);
+    gp_encode(&cmd, frame);
+    frame[GP_FRAME_SIZE - 1] ^= 1;
+    check(gp_receive(&receiver, frame, GP_FRAME_SIZE, &out) == GP_ERR_CRC, "corrupt frame received", 0);
+    check(receive(&receiver, 10) == GP_OK, "seq after corrupt frame", 10);
+}
+
+static size_t poll(gp_sender *sender, uint32_t now_ms, gp_command *sent)
+{
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    size_t size = gp_sender_poll(sender, now_ms, frame);
+    if (size) {
+        check(gp_decode(frame, size, sent) == GP_OK, "sender frame decode", (long)now_ms);
+    }
+    return size;
+}
+
+static void sender(void)
+{
+    gp_sender sender;
+    gp_receiver receiver;
+    gp_command sent;
+    uint32_t now = 1000, suppressed;
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    size_t size;
+    int i;
+
+    gp_sender_init(&sender, 10, 30, 500);
+    check(poll(&sender, now, &sent) == GP_FRAME_SIZE && sent.type == GP_STOP, "first poll sends stop", sent.type);
+
+    gp_sender_set(&sender, GP_VELOCITY, 100);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == 100, "velocity sent", sent.value);
+    check(sent.time_ms == (uint16_t)now, "sender time", sent.time_ms);
+
+    /* smaller changes than the threshold wait for the keepalive */
+    suppressed = sender.suppressed;
+    gp_sender_set(&sender, GP_VELOCITY, 109);
+    now += 30;
+    check(poll(&sender, now, &sent) == 0, "small change sent", 109);
+    check(sender.suppressed == suppressed + 1, "suppressed count", (long)sender.suppressed);
+    gp_sender_set(&sender, GP_VELOCITY, 110);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == 110, "threshold change", sent.value);
+
+    /* setpoints within one interval are merged, the newest is sent */
+    gp_sender_set(&sender, GP_VELOCITY, 200);
+    check(poll(&sender, now + 10, &sent) == 0, "sent within interval", 200);
+    gp_sender_set(&sender, GP_VELOCITY, 300);
+    check(poll(&sender, now + 20, &sent) == 0, "sent within interval", 300);
+    gp_sender_set(&sender, GP_VELOCITY, -50);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == -50, "newest setpoint wins", sent.value);
+
+    /* reaching 0 is sent even under the threshold */
+    gp_sender_set(&sender, GP_VELOCITY, -5);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == -5, "change to -5", sent.value);
+    gp_sender_set(&sender, GP_VELOCITY, 0);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == 0, "zero sent", sent.value);
+
+    /* unchanged setpoint is repeated after the keepalive only */
+    for (i = 1; i < 500 / 30; i++) {
+        check(poll(&sender, now + (uint32_t)i * 30, &sent) == 0, "unchanged sent", i);
+    }
+    now += 500;
+    check(poll(&sender, now, &sent) && sent.value == 0, "keepalive", (long)now);
+
+    /* type changes are always sent, GP_TRACK velocity changes count */
+    gp_sender_set_track(&sender, 0, 0);
+    now += 30;
+    check(poll(&sender, now, &sent) == GP_TRACK_FRAME_SIZE && sent.type == GP_TRACK, "type change", sent.type);
+    gp_sender_set_track(&sender, 3, 40);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.value == 3 && sent.velocity == 40, "track velocity change",
+          sent.velocity);
+    gp_sender_set_track(&sender, 5, 45);
+    now += 30;
+    check(poll(&sender, now, &sent) == 0, "small track change", 45);
+    gp_sender_set(&sender, GP_STOP, 123);
+    now += 30;
+    check(poll(&sender, now, &sent) && sent.type == GP_STOP && sent.value == 0, "stop value", sent.value);
+
+    /* every frame of a sender is new for a receiver, also over the seq wrap */
+    gp_sender_init(&sender, 10, 30, 500);
+    gp_receiver_init(&receiver);
+    for (i = 0; i < 600; i++) {
+        gp_sender_set(&sender, GP_POSITION, (int16_t)(i % 2 ? 1000 : -1000));
+        size = gp_sender_poll(&sender, (uint32_t)i * 30, frame);
+        check(size == GP_FRAME_SIZE, "alternating setpoint", i);
+        check(gp_receive(&receiver, frame, size, &sent) == GP_OK, "sender frame received", i);
+    }
+    check(sender.sent == 600, "sent count", (long)sender.sent);
+}
+
+int main(void)
+{
+    round_trip();
+    corruption();
+    sequence();
+    sender();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,354 @@
+/*
+ *  trackharness.c
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Runs the tracking engine through its C interface on a synthetic moving square (no camera needed)
+ *  usage: trackharness [frames] [width] [height] [memory budget in bytes]
+ *  the same frames are tracked twice, with the engine's frame arena and with its scratch on the heap
+ *  (trk_set_arena), frame time spread and heap allocations of the steady state are printed for both;
+ *  exit 1 when the target is lost, the engine itself allocates in the steady state with the arena
+ *  or the tracker holds more than a quarter over its estimate
+ *  with glibc malloc and friends are interposed here, heap allocations of trk_update are counted
+ *  (operator new of libstdc++ and cv::fastMalloc end up in them too) and so are the bytes the heap holds,
+ *  what the session holds beyond its frame arena in the steady state is printed against the tracker
+ *  estimate of trk_get_memory (trackerBytes in TrackingEngine.cpp)
+ */
+
+#include <errno.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tracking.h"
+
+#define SIDE 120
+
+#ifdef __GLIBC__
+#define COUNTS_ALLOCATIONS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *p);
+
+/* opencv may allocate from its worker threads */
+static unsigned long allocations = 0;
+static long live = 0;
+
+static void *counted(void *p) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    if (p) {
+        __atomic_fetch_add(&live, (long)malloc_usable_size(p), __ATOMIC_RELAXED);
+    }
+    return p;
+}
+
+void free(void *p) {
+    if (p) {
+        __atomic_fetch_sub(&live, (long)malloc_usable_size(p), __ATOMIC_RELAXED);
+    }
+    __libc_free(p);
+}
+
+void *malloc(size_t size) {
+    return counted(__libc_malloc(size));
+}
+
+void *calloc(size_t n, size_t size) {
+    return counted(__libc_calloc(n, size));
+}
+
+void *realloc(void *p, size_t size) {
+    long old = p ? (long)malloc_usable_size(p) : 0;
+    void *q = __libc_realloc(p, size);
+    /* a failed realloc keeps the old block */
+    if (q || size == 0) {
+        __atomic_fetch_sub(&live, old, __ATOMIC_RELAXED);
+    }
+    return counted(q);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **p, size_t alignment, size_t size) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    *p = counted(__libc_memalign(alignment, size));
+    return *p || size == 0 ? 0 : ENOMEM;
+}
+
+static unsigned long allocated(void) {
+    return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
+static long held(void) {
+    return __atomic_load_n(&live, __ATOMIC_RELAXED);
+}
+#else
+static unsigned long allocated(void) {
+    return 0;
+}
+
+static long held(void) {
+    return 0;
+}
+#endif
+
+/* gray noise background with a bright textured square at (x, y), 4 channels like camera frames */
+static void render(uint8_t *data, int width, int height, int x, int y, unsigned *seed) {
+    int i, j;
+    for (j = 0; j < height; j++) {
+        uint8_t *row = data + (size_t)j * width * 4;
+        for (i = 0; i < width; i++) {
+            uint8_t v;
+            *seed = *seed * 1103515245u + 12345u;
+            v = (uint8_t)(40 + ((*seed >> 16) & 31));
+            if (i >= x && i < x + SIDE && j >= y && j < y + SIDE) {
+                v = (uint8_t)(((i - x) / 10 + (j - y) / 10) % 2 ? 230 : 150);
+            }
+            row[i * 4] = row[i * 4 + 1] = row[i * 4 + 2] = v;
+            row[i * 4 + 3] = 255;
+        }
+    }
+}
+
+static int compare(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* one pass over the synthetic clip, steady state is the second half of it */
+typedef struct {
+    double ms, error, worst, p50, p99, stddev;
+    int lost;
+    size_t steady;
+    unsigned long allocations, worst_allocations, growths;
+    long tracker_held; /* heap bytes the session took since trk_init beyond its frame arena, mid clip */
+    size_t tracker_estimate; /* trk_get_memory at the same frame */
+    trk_stats stats;
+    trk_memory memory;
+} run_result;
+
+/* 0 when tracked through, 1 when the target does not fit into the budget, 2 on setup errors */
+static int run(int frames, int width, int height, size_t budget, int arena, int verbose, run_result *r) {
+    unsigned seed = 1;
+    uint8_t *data = malloc((size_t)width * height * 4);
+    double *times = malloc(sizeof(double) * (size_t)frames);
+    trk_frame frame = { data, (size_t)width * 4, width, height, 4 };
+    trk_session *session = trk_create();
+    trk_box box = { 0, 0, SIDE, SIDE };
+    double variance = 0, mean = 0;
+    unsigned long growths = 0;
+    long before_init = 0;
+    size_t frames_before_init = 0;
+    int n, status = 0;
+
+    memset(r, 0, sizeof(*r));
+    if (!data || !times || !session) {
+        fprintf(stderr, "setup failed\n");
+        status = 2;
+        goto done;
+    }
+    trk_start(session, width, height, 4);
+    trk_set_budget(session, budget);
+    trk_set_arena(session, arena);
+
+    for (n = 0; n < frames; n++) {
+        /* target goes along an ellipse around the center */
+        double t = n * 0.02;
+        int x = (int)(width / 2 - SIDE / 2 + cos(t) * width / 3);
+        int y = (int)(height / 2 - SIDE / 2 + sin(t) * height / 4);
+        render(data, width, height, x, y, &seed);
+        if (n == 0) {
+            int result;
+            /* box snapped to the square by a tap in its middle, like the ios app does */
+            if (trk_select(session, &frame, x + SIDE / 2, y + SIDE / 2, NULL, 0, &box) != TRK_TRACKED) {
+                fprintf(stderr, "select failed\n");
+                status = 2;
+                goto done;
+            }
+            if (verbose) {
+                printf("tap selected %.0f,%.0f %.0fx%.0f, target %d,%d %dx%d\n",
+                       box.x, box.y, box.width, box.height, x, y, SIDE, SIDE);
+            }
+            if (trk_get_memory(session, &r->memory) == TRK_TRACKED) {
+                frames_before_init = r->memory.frames;
+            }
+            before_init = held();
+            result = trk_init(session, &frame, box);
+            if (result == TRK_BUDGET) {
+                fprintf(stderr, "target does not fit into %lu bytes\n", (unsigned long)budget);
+                status = 1;
+                goto done;
+            }
+            if (result != TRK_TRACKED) {
+                fprintf(stderr, "init failed\n");
+                status = 2;
+                goto done;
+            }
+        } else {
+            unsigned long before = allocated();
+            double start = now_ms();
+            int result = trk_update(session, &frame, &box);
+            double dx, dy, d;
+            unsigned long count;
+            times[n - 1] = now_ms() - start;
+            count = allocated() - before;
+            r->ms += times[n - 1];
+            if (result == TRK_ERROR) {
+                fprintf(stderr, "update failed at frame %d\n", n);
+                status = 2;
+                goto done;
+            }
+            if (result == TRK_LOST) {
+                r->lost++;
+            }
+            if (n == frames / 2 && trk_get_stats(session, &r->stats) == TRK_TRACKED) {
+                growths = r->stats.scratch_growths;
+            }
+            /* the model is updated in place, what a frame allocates is freed before trk_update returns */
+            if (n == frames / 2 && trk_get_memory(session, &r->memory) == TRK_TRACKED) {
+                r->tracker_held = held() - before_init - (long)(r->memory.frames - frames_before_init);
+                r->tracker_estimate = r->memory.tracker;
+            }
+            /* steady state footprint and allocations over the second half */
+            if (n >= frames / 2) {
+                if (trk_get_memory(session, &r->memory) == TRK_TRACKED) {
+                    r->steady += r->memory.total / (size_t)(frames - frames / 2);
+                }
+                r->allocations += count;
+                if (count > r->worst_allocations) {
+                    r->worst_allocations = count;
+                }
+            }
+            dx = box.x + box.width / 2 - (x + SIDE / 2);
+            dy = box.y + box.height / 2 - (y + SIDE / 2);
+            d = sqrt(dx * dx + dy * dy);
+            r->error += d;
+            if (d > r->worst) {
+                r->worst = d;
+            }
+        }
+    }
+
+    /* frame time spread, steady state only (first tenth is warm up) */
+    for (n = (frames - 1) / 10; n < frames - 1; n++) {
+        mean += times[n];
+    }
+    mean /= (frames - 1) - (frames - 1) / 10;
+    for (n = (frames - 1) / 10; n < frames - 1; n++) {
+        variance += (times[n] - mean) * (times[n] - mean);
+    }
+    r->stddev = sqrt(variance / ((frames - 1) - (frames - 1) / 10));
+    qsort(times, frames - 1, sizeof(double), compare);
+    r->p50 = times[(frames - 1) / 2];
+    r->p99 = times[(frames - 1) * 99 / 100];
+    trk_get_stats(session, &r->stats);
+    trk_get_memory(session, &r->memory);
+    r->growths = r->stats.scratch_growths - growths;
+
+done:
+    trk_destroy(session);
+    free(times);
+    free(data);
+    return status;
+}
+
+static void print_run(const char *name, const run_result *r, int frames) {
+    printf("%-9s frame time p50 %.2f ms, p99 %.2f ms, stddev %.3f ms", name, r->p50, r->p99, r->stddev);
+#ifdef COUNTS_ALLOCATIONS
+    printf(", heap allocations per steady frame %.2f max %lu",
+           (double)r->allocations / (frames - frames / 2), r->worst_allocations);
+#else
+    (void)frames;
+#endif
+    printf(", scratch growths %lu\n", r->growths);
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 300;
+    int width = argc > 2 ? atoi(argv[2]) : 1280;
+    int height = argc > 3 ? atoi(argv[3]) : 720;
+    size_t budget = argc > 4 ? (size_t)atol(argv[4]) : 0;
+    run_result pooled, heap;
+    int status, failed = 0;
+
+    if (frames < 2) {
+        fprintf(stderr, "at least 2 frames are needed\n");
+        return 2;
+    }
+    if (trk_abi_version() != TRK_ABI_VERSION) {
+        fprintf(stderr, "engine abi %d, harness %d\n", trk_abi_version(), TRK_ABI_VERSION);
+        return 2;
+    }
+    status = run(frames, width, height, budget, 1, 1, &pooled);
+    if (status) {
+        return status;
+    }
+    printf("frames %d, %dx%d, %.2f ms per frame, center error mean %.1f px max %.1f px, lost %d\n",
+           frames - 1, width, height, pooled.ms / (frames - 1), pooled.error / (frames - 1), pooled.worst, pooled.lost);
+    printf("scratch arena %lu bytes, peak %lu, growths %lu\n", (unsigned long)pooled.stats.scratch_capacity,
+           (unsigned long)pooled.stats.scratch_peak, pooled.stats.scratch_growths);
+    printf("memory steady %lu bytes (frames %lu, tracker %lu, telemetry %lu), peak %lu, budget %lu%s\n",
+           (unsigned long)pooled.steady, (unsigned long)pooled.memory.frames, (unsigned long)pooled.memory.tracker,
+           (unsigned long)pooled.memory.telemetry, (unsigned long)pooled.memory.peak,
+           (unsigned long)pooled.memory.budget, pooled.memory.over ? ", over budget" : "");
+#ifdef COUNTS_ALLOCATIONS
+    /* the session's own buffers beyond the arena count too, the estimate should stay at or above this */
+    printf("tracker estimate %lu bytes, heap held %ld bytes, error %+.0f%%\n", (unsigned long)pooled.tracker_estimate,
+           pooled.tracker_held, pooled.tracker_held > 0
+           ? 100.0 * ((double)pooled.tracker_estimate - pooled.tracker_held) / pooled.tracker_held : 0.0);
+#endif
+
+    status = run(frames, width, height, budget, 0, 0, &heap);
+    if (status) {
+        return status;
+    }
+    print_run("arena", &pooled, frames);
+    print_run("no arena", &heap, frames);
+
+    if (pooled.worst >= SIDE / 2 || pooled.lost) {
+        printf("FAIL target lost\n");
+        failed = 1;
+    }
+    /* the engine's own scratch: no new blocks and fewer calls than with it on the heap,
+       what is left is OpenCV's own work inside the tracker */
+    if (pooled.growths) {
+        printf("FAIL %lu scratch growths in the steady state\n", pooled.growths);
+        failed = 1;
+    }
+#ifdef COUNTS_ALLOCATIONS
+    if (pooled.allocations >= heap.allocations) {
+        printf("FAIL the arena does not take engine allocations off the heap\n");
+        failed = 1;
+    }
+    /* the budget is kept against the estimate, a tracker that takes more than a quarter over it breaks it */
+    if ((double)pooled.tracker_held > pooled.tracker_estimate * 1.25) {
+        printf("FAIL the tracker holds %ld bytes, %lu estimated\n", pooled.tracker_held,
+               (unsigned long)pooled.tracker_estimate);
+        failed = 1;
+    }
+#endif
+    return failed;
+}
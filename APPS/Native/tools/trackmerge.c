@@ -0,0 +1,200 @@
+/*
+ *  trackmerge.c
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Joins a tracking sidecar (.track, written by the apps while recording) with the decoded frames of its video
+ *  every frame gets the record with the nearest pts within the tolerance, frames the tracker skipped get none
+ *
+ *  usage: trackmerge clip.track [--pts=frames.txt] [--fps=30] [--tolerance=ms] [--raw=WxH]
+ *  frame times (seconds, one per line, the decoder's order):
+ *    ffprobe -v error -select_streams v:0 -show_entries frame=pts_time -of csv=p=0 clip.mov > frames.txt
+ *  without --pts frame n is at n / fps
+ *  csv per frame on stdout:
+ *    trackmerge clip.track --pts=frames.txt > clip.csv
+ *  boxes drawn into rgb24 frames, stdin to stdout:
+ *    ffmpeg -i clip.mov -f rawvideo -pix_fmt rgb24 - | trackmerge clip.track --pts=frames.txt --raw=1920x1080 |
+ *    ffmpeg -f rawvideo -pix_fmt rgb24 -s 1920x1080 -r 30 -i - boxes.mp4
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "track_sidecar.h"
+
+static const char *STATUS[] = { "none", "lost", "tracked" };
+
+static tsc_record *records;
+static size_t count;
+
+static int load(const char *path, tsc_header *header) {
+    size_t capacity = 1024;
+    tsc_record record;
+    int result;
+    tsc_reader *reader = tsc_open(path, header);
+    if (!reader) {
+        return -1;
+    }
+    records = malloc(capacity * sizeof(*records));
+    while (records && (result = tsc_read(reader, &record)) == 1) {
+        if (count && record.pts <= records[count - 1].pts) {
+            fprintf(stderr, "record %lu out of pts order, skipped\n", (unsigned long)count);
+            continue;
+        }
+        if (count == capacity) {
+            tsc_record *grown = realloc(records, 2 * capacity * sizeof(*records));
+            if (!grown) {
+                break;
+            }
+            records = grown;
+            capacity *= 2;
+        }
+        records[count++] = record;
+    }
+    tsc_free(reader);
+    return records ? 0 : -1;
+}
+
+/* record nearest to pts, NULL when the closest one is further than tolerance */
+static const tsc_record *nearest(int64_t pts, int64_t tolerance) {
+    size_t low = 0, high = count;
+    const tsc_record *best = NULL;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (records[middle].pts < pts) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < count) {
+        best = &records[low];
+    }
+    if (low > 0 && (!best || pts - records[low - 1].pts < best->pts - pts)) {
+        best = &records[low - 1];
+    }
+    if (best && llabs(best->pts - pts) > tolerance) {
+        return NULL;
+    }
+    return best;
+}
+
+/* 3 px outline, green tracked, red lost */
+static void draw(uint8_t *rgb, int width, int height, const tsc_record *r, double sx, double sy) {
+    int x0 = (int)(r->x * sx), y0 = (int)(r->y * sy);
+    int x1 = (int)((r->x + r->width) * sx), y1 = (int)((r->y + r->height) * sy);
+    uint8_t color[3] = { 255, 0, 0 };
+    int x, y;
+    if (r->status == TSC_TRACKED) {
+        color[0] = 0;
+        color[1] = 255;
+    }
+    for (y = y0 < 0 ? 0 : y0; y <= y1 && y < height; y++) {
+        for (x = x0 < 0 ? 0 : x0; x <= x1 && x < width; x++) {
+            if (x - x0 < 3 || x1 - x < 3 || y - y0 < 3 || y1 - y < 3) {
+                memcpy(rgb + ((size_t)y * width + x) * 3, color, 3);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *track = NULL, *ptsfile = NULL;
+    double fps = 30, tolerance = -1;
+    int width = 0, height = 0, i;
+    long frame = 0, matched = 0;
+    tsc_header header;
+    FILE *pts = NULL;
+    uint8_t *rgb = NULL;
+    size_t framesize = 0;
+    int64_t scale;
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--pts=", 6) == 0) {
+            ptsfile = argv[i] + 6;
+        } else if (strncmp(argv[i], "--fps=", 6) == 0) {
+            fps = atof(argv[i] + 6);
+        } else if (strncmp(argv[i], "--tolerance=", 12) == 0) {
+            tolerance = atof(argv[i] + 12) / 1000;
+        } else if (strncmp(argv[i], "--raw=", 6) == 0) {
+            if (sscanf(argv[i] + 6, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "--raw needs WxH\n");
+                return 2;
+            }
+        } else if (argv[i][0] != '-' && !track) {
+            track = argv[i];
+        } else {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!track || fps <= 0) {
+        fprintf(stderr, "usage: trackmerge clip.track [--pts=frames.txt] [--fps=30] [--tolerance=ms] [--raw=WxH]\n");
+        return 2;
+    }
+    if (load(track, &header) != 0) {
+        fprintf(stderr, "cannot read sidecar %s\n", track);
+        return 2;
+    }
+    if (ptsfile && !(pts = fopen(ptsfile, "r"))) {
+        fprintf(stderr, "cannot open %s\n", ptsfile);
+        return 2;
+    }
+    /* half a frame, a record can not belong to two frames */
+    if (tolerance < 0) {
+        tolerance = 0.5 / fps;
+    }
+    scale = header.timescale;
+    if (width) {
+        framesize = (size_t)width * height * 3;
+        rgb = malloc(framesize);
+        if (!rgb) {
+            return 2;
+        }
+    } else {
+        printf("frame,time,status,x,y,width,height,rate\n");
+    }
+
+    for (;;) {
+        double time = frame / fps;
+        const tsc_record *r;
+        if (pts) {
+            if (fscanf(pts, "%lf", &time) != 1) {
+                break;
+            }
+        } else if (!rgb && (count == 0 || time * scale > records[count - 1].pts + tolerance * scale)) {
+            break;
+        }
+        if (rgb && fread(rgb, framesize, 1, stdin) != 1) {
+            break;
+        }
+        r = nearest((int64_t)llround(time * scale), (int64_t)llround(tolerance * scale));
+        matched += r != NULL;
+        if (rgb) {
+            if (r && r->status != TSC_NONE && header.width && header.height) {
+                draw(rgb, width, height, r, (double)width / header.width, (double)height / header.height);
+            }
+            if (fwrite(rgb, framesize, 1, stdout) != 1) {
+                return 1;
+            }
+        } else if (r) {
+            printf("%ld,%.6f,%s,%.1f,%.1f,%.1f,%.1f,%.4f\n", frame, time,
+                   STATUS[r->status <= TSC_TRACKED ? r->status : 0], r->x, r->y, r->width, r->height, r->rate);
+        } else {
+            printf("%ld,%.6f,,,,,,\n", frame, time);
+        }
+        frame++;
+    }
+
+    fprintf(stderr, "%ld frames, %ld with results, %lu records, tracked at %ux%u\n",
+            frame, matched, (unsigned long)count, header.width, header.height);
+    if (pts) {
+        fclose(pts);
+    }
+    free(rgb);
+    free(records);
+    return 0;
+}
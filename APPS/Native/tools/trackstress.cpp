@@ -0,0 +1,317 @@
+//
+//  trackstress.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Deterministic load generator: many tracking sessions on synthetic sequences, driven faster than real time
+//
+//  usage: trackstress [--sessions=16 --threads=hardware --seconds=60 --interval=10 --width=640 --height=360]
+//                     [--speed=4 --occlusion=0.1 --noise=12 --seed=1 --max-growth=0]
+//  speed in pixels per frame, occlusion is the part of frames where a bar covers the target, noise is the
+//  amplitude of per frame noise. The same seed gives the same frames for every run.
+//  First intervals ramp threads 1, 2, 4 .. threads (throughput saturation), the rest soaks at full load.
+//  Every interval prints frames per second, update latency tail, resident memory and engine memory;
+//  at the end memory growth per hour after warm up and one summary line of the soak to keep as a baseline,
+//  exit code 1 when the growth is over --max-growth MB/h or the engine returned errors.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "tracking.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Settings {
+    int sessions = 16;
+    int threads = 1;
+    int seconds = 60;
+    int interval = 10;
+    int width = 640, height = 360;
+    double speed = 4;
+    double occlusion = 0.1;
+    int noise = 12;
+    unsigned seed = 1;
+    double maxGrowth = 0; // MB per hour, 0 - no limit
+};
+
+const int SIDE = 60;
+const int NOISE_TABLE = 1 << 16;
+
+unsigned next(unsigned &state) {
+    state = state * 1103515245u + 12345u;
+    return state >> 16;
+}
+
+// one camera with one target bouncing around, everything follows from the seed
+struct Sequence {
+    Settings cfg;
+    std::vector<uint8_t> background, frame, noise;
+    double x, y, vx, vy;
+    long index = 0;
+    unsigned state;
+
+    Sequence(const Settings &settings, unsigned seed) : cfg(settings), state(seed) {
+        size_t bytes = (size_t)cfg.width * cfg.height * 4;
+        background.resize(bytes);
+        frame.resize(bytes);
+        for (size_t i = 0; i < bytes; i += 4) {
+            uint8_t v = (uint8_t)(40 + next(state) % 32);
+            background[i] = background[i + 1] = background[i + 2] = v;
+            background[i + 3] = 255;
+        }
+        // per frame noise is a window into this table at a random offset, cheap and repeatable
+        noise.resize(NOISE_TABLE + (size_t)cfg.width);
+        for (uint8_t &n : noise) n = (uint8_t)(cfg.noise ? next(state) % (cfg.noise + 1) : 0);
+        x = next(state) % (cfg.width - SIDE);
+        y = next(state) % (cfg.height - SIDE);
+        double angle = (next(state) % 628) / 100.0;
+        vx = cfg.speed * std::cos(angle);
+        vy = cfg.speed * std::sin(angle);
+    }
+
+    // next frame, returns the true box
+    trk_box render() {
+        if (index++ > 0) {
+            x += vx;
+            y += vy;
+            if (x < 0 || x > cfg.width - SIDE) { vx = -vx; x = std::max(0.0, std::min(x, (double)cfg.width - SIDE)); }
+            if (y < 0 || y > cfg.height - SIDE) { vy = -vy; y = std::max(0.0, std::min(y, (double)cfg.height - SIDE)); }
+        }
+        memcpy(frame.data(), background.data(), frame.size());
+        int ix = (int)x, iy = (int)y;
+        for (int j = 0; j < SIDE; j++) {
+            uint8_t *row = frame.data() + ((size_t)(iy + j) * cfg.width + ix) * 4;
+            for (int i = 0; i < SIDE; i++) {
+                uint8_t v = (uint8_t)((i / 10 + j / 10) % 2 ? 230 : 150);
+                row[i * 4] = row[i * 4 + 1] = row[i * 4 + 2] = v;
+            }
+        }
+        // occluder: a bar over the target in the given part of a 100 frame cycle
+        if (index % 100 < cfg.occlusion * 100) {
+            int bar = std::min(cfg.width, SIDE * 2);
+            int bx = std::max(0, std::min(cfg.width - bar, ix - SIDE / 2));
+            for (int j = 0; j < cfg.height; j++) {
+                memset(frame.data() + ((size_t)j * cfg.width + bx) * 4, 90, (size_t)bar * 4);
+            }
+        }
+        if (cfg.noise) {
+            for (int j = 0; j < cfg.height; j++) {
+                const uint8_t *n = noise.data() + next(state) % NOISE_TABLE;
+                uint8_t *row = frame.data() + (size_t)j * cfg.width * 4;
+                for (int i = 0; i < cfg.width; i++) {
+                    row[i * 4] = (uint8_t)std::min(255, row[i * 4] + n[i]);
+                }
+            }
+        }
+        trk_box truth = { (double)ix, (double)iy, (double)SIDE, (double)SIDE };
+        return truth;
+    }
+};
+
+struct Session {
+    Sequence sequence;
+    trk_session *engine;
+    int lostRun = 0;
+    bool started = false;
+
+    Session(const Settings &cfg, unsigned seed) : sequence(cfg, seed), engine(trk_create()) {
+        trk_start(engine, cfg.width, cfg.height, 4);
+    }
+    ~Session() { trk_destroy(engine); }
+};
+
+struct Totals {
+    long frames = 0, lost = 0, reinit = 0, errors = 0;
+    std::vector<double> latencies; // ms of trk_update
+};
+
+// one worker drives its sessions round robin as fast as it can until the end of the interval
+void drive(const Settings &cfg, std::vector<Session *> sessions, Clock::time_point end, Totals &totals) {
+    while (Clock::now() < end) {
+        for (Session *s : sessions) {
+            trk_box truth = s->sequence.render();
+            trk_frame frame = { s->sequence.frame.data(), (size_t)cfg.width * 4, cfg.width, cfg.height, 4 };
+            // start and reacquire after a long loss (occlusion) at the true position
+            if (!s->started || s->lostRun > 30) {
+                if (trk_init(s->engine, &frame, truth) != TRK_TRACKED) totals.errors++;
+                if (s->started) totals.reinit++;
+                s->started = true;
+                s->lostRun = 0;
+                continue;
+            }
+            trk_box box;
+            auto start = Clock::now();
+            int result = trk_update(s->engine, &frame, &box);
+            totals.latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            totals.frames++;
+            if (result == TRK_ERROR) totals.errors++;
+            if (result == TRK_LOST) {
+                totals.lost++;
+                s->lostRun++;
+            } else {
+                s->lostRun = 0;
+            }
+        }
+    }
+}
+
+double residentMB() {
+    FILE *file = fopen("/proc/self/statm", "r");
+    long pages = 0, resident = 0;
+    if (file) {
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        fclose(file);
+    }
+    return resident * (double)sysconf(_SC_PAGESIZE) / 1e6;
+}
+
+double quantile(const std::vector<double> &sorted, double q) {
+    return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, (size_t)(q * sorted.size()))];
+}
+
+double arg(const char *a, const char *name, double value) {
+    size_t n = strlen(name);
+    if (strncmp(a, name, n) == 0 && a[n] == '=') {
+        return atof(a + n + 1);
+    }
+    return value;
+}
+
+void quiet(const char *) {}
+
+}
+
+int main(int argc, char **argv) {
+    Settings cfg;
+    cfg.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        cfg.sessions = (int)arg(a, "--sessions", cfg.sessions);
+        cfg.threads = (int)arg(a, "--threads", cfg.threads);
+        cfg.seconds = (int)arg(a, "--seconds", cfg.seconds);
+        cfg.interval = (int)arg(a, "--interval", cfg.interval);
+        cfg.width = (int)arg(a, "--width", cfg.width);
+        cfg.height = (int)arg(a, "--height", cfg.height);
+        cfg.speed = arg(a, "--speed", cfg.speed);
+        cfg.occlusion = arg(a, "--occlusion", cfg.occlusion);
+        cfg.noise = (int)arg(a, "--noise", cfg.noise);
+        cfg.seed = (unsigned)arg(a, "--seed", cfg.seed);
+        cfg.maxGrowth = arg(a, "--max-growth", cfg.maxGrowth);
+    }
+    if (cfg.sessions < 1 || cfg.threads < 1 || cfg.interval < 1 || cfg.width < SIDE * 2 || cfg.height < SIDE * 2) {
+        fprintf(stderr, "bad arguments\n");
+        return 2;
+    }
+    // quality changes of hundreds of sessions would flood the output
+    trk_set_log(&quiet);
+
+    std::vector<Session *> sessions;
+    for (int i = 0; i < cfg.sessions; i++) {
+        sessions.push_back(new Session(cfg, cfg.seed * 7919u + (unsigned)i));
+    }
+
+    // ramp 1, 2, 4 .. threads, then soak at full load
+    std::vector<int> plan;
+    for (int t = 1; t < cfg.threads; t *= 2) plan.push_back(t);
+    int intervals = std::max((int)plan.size() + 1, cfg.seconds / cfg.interval);
+    while ((int)plan.size() < intervals) plan.push_back(cfg.threads);
+
+    printf("%d sessions %dx%d, speed %.1f px/frame, occlusion %.2f, noise %d, seed %u\n",
+           cfg.sessions, cfg.width, cfg.height, cfg.speed, cfg.occlusion, cfg.noise, cfg.seed);
+    printf("%6s %7s %9s %8s %8s %8s %8s %9s %9s %6s %6s\n", "time", "threads", "fps", "p50 ms", "p99 ms",
+           "p999 ms", "max ms", "rss MB", "engine MB", "lost", "reinit");
+
+    std::vector<double> times, rss, p99s, fpss;
+    std::vector<std::pair<int, double>> saturation;
+    long errors = 0, lost = 0, frames = 0;
+    auto begin = Clock::now();
+    for (int threads : plan) {
+        threads = std::min(threads, cfg.sessions);
+        std::vector<Totals> totals(threads);
+        std::vector<std::thread> workers;
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(cfg.interval);
+        for (int t = 0; t < threads; t++) {
+            std::vector<Session *> own;
+            for (int i = t; i < cfg.sessions; i += threads) own.push_back(sessions[i]);
+            workers.emplace_back(drive, std::cref(cfg), own, end, std::ref(totals[t]));
+        }
+        for (std::thread &worker : workers) worker.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        Totals all;
+        for (Totals &t : totals) {
+            all.frames += t.frames;
+            all.lost += t.lost;
+            all.reinit += t.reinit;
+            all.errors += t.errors;
+            all.latencies.insert(all.latencies.end(), t.latencies.begin(), t.latencies.end());
+        }
+        std::sort(all.latencies.begin(), all.latencies.end());
+        size_t engineBytes = 0;
+        for (Session *s : sessions) {
+            trk_memory memory;
+            if (trk_get_memory(s->engine, &memory) == TRK_TRACKED) engineBytes += memory.total;
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+        double fps = all.frames / seconds;
+        times.push_back(elapsed);
+        rss.push_back(residentMB());
+        p99s.push_back(quantile(all.latencies, 0.99));
+        fpss.push_back(fps);
+        errors += all.errors;
+        lost += all.lost;
+        frames += all.frames;
+        if (saturation.empty() || saturation.back().first != threads) saturation.push_back({threads, fps});
+        printf("%6.0f %7d %9.0f %8.2f %8.2f %8.2f %8.2f %9.1f %9.1f %6ld %6ld%s\n", elapsed, threads, fps,
+               quantile(all.latencies, 0.5), quantile(all.latencies, 0.99), quantile(all.latencies, 0.999),
+               all.latencies.empty() ? 0 : all.latencies.back(), rss.back(), engineBytes / 1e6, all.lost, all.reinit,
+               all.errors ? "  errors" : "");
+        fflush(stdout);
+    }
+
+    printf("saturation:");
+    for (auto &point : saturation) {
+        printf(" %d threads %.0f fps (%.2fx)", point.first, point.second, point.second / saturation[0].second);
+    }
+    printf("\n");
+
+    // least squares slope of resident memory over the soak part (ramp and first soak interval are warm up)
+    size_t from = std::min(times.size() - 1, saturation.size() + 1);
+    double growth = 0;
+    if (times.size() - from >= 2) {
+        double n = (double)(times.size() - from), st = 0, sr = 0, stt = 0, str = 0;
+        for (size_t i = from; i < times.size(); i++) {
+            st += times[i]; sr += rss[i]; stt += times[i] * times[i]; str += times[i] * rss[i];
+        }
+        growth = (n * str - st * sr) / (n * stt - st * st) * 3600;
+        printf("memory growth %.1f MB/h over %.0f s of soak\n", growth, times.back() - times[from]);
+    } else {
+        printf("memory growth: soak too short, run with more --seconds\n");
+    }
+
+    // soak part only, worst interval of the tail so a slow interval is not averaged away
+    double soakFps = 0, soakP99 = 0;
+    for (size_t i = from; i < times.size(); i++) {
+        soakFps += fpss[i] / (times.size() - from);
+        soakP99 = std::max(soakP99, p99s[i]);
+    }
+    printf("baseline: %d sessions %dx%d, %d threads, %.0f fps, worst p99 %.2f ms, %.1f MB/h, lost %.1f%%, errors %ld\n",
+           cfg.sessions, cfg.width, cfg.height, std::min(cfg.threads, cfg.sessions), soakFps, soakP99, growth,
+           frames ? 100.0 * lost / frames : 0.0, errors);
+
+    for (Session *s : sessions) delete s;
+    return errors || (cfg.maxGrowth > 0 && growth > cfg.maxGrowth) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+//
+//  FrameArena.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Per-frame bump allocator for short lived scratch data of the engine stages
+
+#ifndef FrameArena_hpp
+#define FrameArena_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace track {
+
+// memory is handed out by moving a pointer and taken back all at once in reset() at frame end
+// when a frame needs more than the block, extra blocks are allocated and on reset the block grows
+// to the peak, so after the first frames there are no allocations at all
+class FrameArena {
+public:
+    explicit FrameArena(size_t initial = 1 << 20) : size(initial), block(new uint8_t[initial]) {}
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        size_t start = (offset + align - 1) & ~(align - 1);
+        if (pooling && start + bytes <= size) {
+            offset = start + bytes;
+            used += bytes;
+            return block.get() + start;
+        }
+        //block is full, extra memory lives until reset
+        growths++;
+        used += bytes;
+        extra.emplace_back(new uint8_t[bytes + align]);
+        uintptr_t p = reinterpret_cast<uintptr_t>(extra.back().get());
+        return reinterpret_cast<void *>((p + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    // frame end, everything allocated since the last reset is invalid after this
+    void reset() {
+        if (used > peakUsed) {
+            peakUsed = used;
+        }
+        if (!extra.empty()) {
+            extra.clear();
+            //room for the whole peak frame plus alignment padding
+            if (pooling) {
+                size = peakUsed + peakUsed / 4;
+                block.reset(new uint8_t[size]);
+            }
+        }
+        offset = 0;
+        used = 0;
+    }
+
+    // after reset: smaller block when frames got smaller (lower resolution), peak is measured again
+    void trim(size_t bytes) {
+        if (bytes < size && extra.empty()) {
+            size = bytes;
+            block.reset(new uint8_t[size]);
+            peakUsed = 0;
+        }
+    }
+
+    // off: every allocation is a heap block freed in reset, what the stages did before the arena (comparisons)
+    void setPooling(bool on) { pooling = on; }
+
+    size_t capacity() const { return size; }
+    size_t peak() const { return peakUsed; }
+    // blocks allocated because a frame did not fit, stays constant in steady state
+    unsigned long growthCount() const { return growths; }
+
+private:
+    size_t size;
+    std::unique_ptr<uint8_t[]> block;
+    std::vector<std::unique_ptr<uint8_t[]>> extra;
+    size_t offset = 0;
+    size_t used = 0;
+    size_t peakUsed = 0;
+    unsigned long growths = 0;
+    bool pooling = true;
+};
+
+// std allocator over the arena (like std::pmr::polymorphic_allocator, which iOS libc++ does not have),
+// deallocate does nothing, memory comes back in FrameArena::reset
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+private:
+    template <typename U> friend class ArenaAllocator;
+    FrameArena *arena;
+};
+
+// scratch list of one frame: ScratchVector<Rect2d> boxes(ArenaAllocator<Rect2d>(arena))
+template <typename T>
+using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+
+#endif /* FrameArena_hpp */
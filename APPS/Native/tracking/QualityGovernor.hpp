@@ -0,0 +1,104 @@
+//
+//  QualityGovernor.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Steps tracker quality down when the phone gets slow (thermal throttling) and back up
+
+#ifndef QualityGovernor_hpp
+#define QualityGovernor_hpp
+
+namespace gov {
+
+enum Backend { KCF, MOSSE };
+
+struct Level {
+    int scale;        // frame downscale for the tracker
+    int skip;         // tracker runs on every skip-th frame
+    Backend backend;  // MOSSE is a lot cheaper than KCF but less stable
+};
+
+// best quality first
+static const Level LEVELS[] = {
+    {3, 1, KCF},
+    {4, 1, KCF},
+    {4, 2, KCF},
+    {4, 2, MOSSE},
+    {5, 3, MOSSE},
+};
+static const int LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+class QualityGovernor {
+public:
+    // duty = processing time / time between frames, kept between low and high
+    explicit QualityGovernor(double high = 0.7, double low = 0.35)
+        : high(high), low(low) { reset(); }
+
+    void reset() {
+        current = 0;
+        floor = 0;
+        fast = slow = 0;
+        over = under = 0;
+        samples = 0;
+    }
+
+    // called once per frame, returns true when the level changed
+    bool update(double procMs, double intervalMs) {
+        if (intervalMs <= 0) return false;
+        double duty = procMs / intervalMs;
+        // fast average reacts to throttling, slow one decides when it is safe to go back
+        if (samples++ == 0) {
+            fast = slow = duty;
+        } else {
+            fast += FAST_ALPHA * (duty - fast);
+            slow += SLOW_ALPHA * (duty - slow);
+        }
+        over = fast > high ? over + 1 : 0;
+        under = slow < low ? under + 1 : 0;
+
+        if (over >= DOWN_FRAMES && current < LEVEL_COUNT - 1) {
+            step(current + 1);
+            return true;
+        }
+        if (under >= UP_FRAMES && current > floor) {
+            step(current - 1);
+            return true;
+        }
+        return false;
+    }
+
+    // best level allowed (memory budget), a better current level is moved down to it
+    void setFloor(int level) {
+        floor = level < 0 ? 0 : level >= LEVEL_COUNT ? LEVEL_COUNT - 1 : level;
+        if (current < floor) step(floor);
+    }
+
+    const Level &level() const { return LEVELS[current]; }
+    int index() const { return current; }
+    double duty() const { return fast; }
+
+private:
+    static constexpr double FAST_ALPHA = 0.2;
+    static constexpr double SLOW_ALPHA = 0.02;
+    static const int DOWN_FRAMES = 15;   // half a second at 30 fps
+    static const int UP_FRAMES = 150;    // going up is slow so levels do not oscillate
+
+    void step(int to) {
+        current = to;
+        over = under = 0;
+        // new level has different cost, measure it from scratch
+        samples = 0;
+    }
+
+    double high, low;
+    int current;
+    int floor;
+    double fast, slow;
+    int over, under;
+    int samples;
+};
+
+}
+
+#endif /* QualityGovernor_hpp */
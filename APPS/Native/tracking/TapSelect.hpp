@@ -0,0 +1,116 @@
+//
+//  TapSelect.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  Tight box around the object under a tap, from detections the app already has or from the gray frame
+
+#ifndef TapSelect_hpp
+#define TapSelect_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace track {
+
+struct TapBox {
+    int x, y, width, height;
+};
+
+// smallest detection containing the tap is the tightest one around what the user meant, -1 when none
+// boxes are x, y, width, height in the same units as the tap
+template <typename Box>
+int detectionAt(const Box *boxes, int count, double x, double y) {
+    int best = -1;
+    double bestArea = 0;
+    for (int i = 0; i < count; i++) {
+        const Box &b = boxes[i];
+        if (x < b.x || y < b.y || x > b.x + b.width || y > b.y + b.height) continue;
+        double area = b.width * b.height;
+        if (best < 0 || area < bestArea) {
+            best = i;
+            bestArea = area;
+        }
+    }
+    return best;
+}
+
+// gray levels between the mean of object and background, less is noise
+const int MIN_CONTRAST = 30;
+
+// segment of the tapped object in a small gray frame:
+// a window around the tap is split into two classes by Otsu threshold, the class of the tap point
+// is flood filled from it, its bounding box is the object. Fails (false) on low contrast, when the
+// segment is tiny or reaches the window on 3 sides (tap on background), then the caller uses a default box
+// mask has w * h bytes and queue w * h ints of scratch memory (frame arena)
+inline bool segmentAt(const uint8_t *gray, size_t step, int w, int h, int tx, int ty,
+                      uint8_t *mask, int *queue, TapBox &out) {
+    if (tx < 0 || ty < 0 || tx >= w || ty >= h) return false;
+    // window of a third of the frame, objects bigger than that are not tapped for tracking
+    const int rw = std::max(8, w / 6), rh = std::max(8, h / 6);
+    const int x0 = std::max(0, tx - rw), x1 = std::min(w - 1, tx + rw);
+    const int y0 = std::max(0, ty - rh), y1 = std::min(h - 1, ty + rh);
+
+    int histogram[256] = {0};
+    int total = 0;
+    for (int y = y0; y <= y1; y++) {
+        const uint8_t *row = gray + (size_t)y * step;
+        for (int x = x0; x <= x1; x++) histogram[row[x]]++;
+        total += x1 - x0 + 1;
+    }
+    // otsu: threshold with the biggest variance between the two classes
+    double sumAll = 0;
+    for (int v = 0; v < 256; v++) sumAll += (double)v * histogram[v];
+    double sumLow = 0, bestVariance = -1, separation = 0;
+    int low = 0, threshold = 0;
+    for (int v = 0; v < 256; v++) {
+        low += histogram[v];
+        if (low == 0) continue;
+        if (low == total) break;
+        sumLow += (double)v * histogram[v];
+        double meanLow = sumLow / low, meanHigh = (sumAll - sumLow) / (total - low);
+        double variance = (double)low * (total - low) * (meanLow - meanHigh) * (meanLow - meanHigh);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            threshold = v;
+            separation = meanHigh - meanLow;
+        }
+    }
+    // noise or a flat area, nothing stands out
+    if (separation < MIN_CONTRAST) return false;
+    const bool bright = gray[(size_t)ty * step + tx] > threshold;
+
+    for (int y = y0; y <= y1; y++) std::fill(mask + (size_t)y * w + x0, mask + (size_t)y * w + x1 + 1, 0);
+    int head = 0, tail = 0, count = 0;
+    int minx = tx, maxx = tx, miny = ty, maxy = ty;
+    queue[tail++] = ty * w + tx;
+    mask[ty * w + tx] = 1;
+    while (head < tail) {
+        int p = queue[head++], x = p % w, y = p / w;
+        count++;
+        minx = std::min(minx, x); maxx = std::max(maxx, x);
+        miny = std::min(miny, y); maxy = std::max(maxy, y);
+        // 8 neighbours so textured objects (thin dark lines in a bright part) stay one segment
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = x + dx, ny = y + dy;
+                if (nx < x0 || nx > x1 || ny < y0 || ny > y1) continue;
+                int q = ny * w + nx;
+                if (mask[q] || (gray[(size_t)ny * step + nx] > threshold) != bright) continue;
+                mask[q] = 1;
+                queue[tail++] = q;
+            }
+        }
+    }
+    // background reaches the window on (almost) all sides, an object only where the window cuts it
+    int sides = (minx == x0) + (maxx == x1) + (miny == y0) + (maxy == y1);
+    if (count < 16 || sides >= 3) return false;
+    out = {minx, miny, maxx - minx + 1, maxy - miny + 1};
+    return true;
+}
+
+}
+
+#endif /* TapSelect_hpp */
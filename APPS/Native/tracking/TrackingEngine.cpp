@@ -0,0 +1,230 @@
+//
+//  TrackingEngine.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//
+
+#include "TrackingEngine.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <opencv2/imgproc.hpp>
+
+//OpenCV 4.5.1 moved MOSSE to cv::legacy, cv::Tracker works on integer boxes from there on and has no clear
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 1)))
+#define TRK_TRACKER_LEGACY 1
+#include <opencv2/tracking/tracking_legacy.hpp>
+#endif
+
+using namespace cv;
+using namespace std;
+
+namespace track {
+
+namespace {
+
+#ifdef TRK_TRACKER_LEGACY
+typedef Rect TrackerBox;
+#else
+typedef Rect2d TrackerBox;
+#endif
+
+//what OpenCV keeps for a target of this size (tracker frame pixels), from the default parameters:
+//KCF pads the box 2.5 times and resizes the patch to at most 80x80, about 40 floats per patch pixel
+//(color names features, their spectra, model and kernel), MOSSE keeps 3 complex filters and a window
+//trackharness prints this against the heap a real session holds ("tracker estimate"), it fails when the session holds over 25% more
+size_t trackerBytes(double width, double height, gov::Backend backend) {
+    double area = width * height;
+    if (backend == gov::KCF) {
+        return (size_t)(std::min(area * 3.5 * 3.5, 80.0 * 80.0) * 40 * sizeof(float));
+    }
+    return (size_t)(area * 7 * sizeof(float));
+}
+
+}
+
+Engine::Engine(LogFn log) : log(log) {
+    tracker = createTracker();
+}
+
+Ptr<Tracker> Engine::createTracker() const {
+    if (governor.level().backend == gov::MOSSE) {
+#ifdef TRK_TRACKER_LEGACY
+        return legacy::upgradeTrackingAPI(legacy::TrackerMOSSE::create());
+#else
+        return TrackerMOSSE::create();
+#endif
+    }
+    return TrackerKCF::create();
+}
+
+//camera frame to small gray frame for the tracker, the gray frame lives in the frame arena
+void Engine::preprocess(const Mat &frame, Mat &gray) {
+    gray = Mat(h, w, CV_8UC1, arena.allocate((size_t)w * h, 64));
+    if (frame.cols / scale != w || frame.rows / scale != h) {
+        //size changed since start, scale to tracker size like before, the color step is in the arena too
+        Mat small(h, w, CV_8UC(frame.channels()), arena.allocate((size_t)w * h * frame.channels(), 64));
+        resize(frame, small, cv::Size(w, h));
+        cvtColor(small, gray, COLOR_BGR2GRAY);
+        return;
+    }
+    downscale(frame.data, frame.step, frame.cols, frame.rows, frame.channels(), scale, gray.data, gray.step);
+}
+
+void Engine::start(int width, int height, int channels) {
+    srcw = width;
+    srch = height;
+    srcc = channels;
+    governor.reset();
+    scale = governor.level().scale;
+    w = srcw / scale;
+    h = srch / scale;
+    downscale = prep::selectDownscale(srcw, srch, srcc, scale);
+}
+
+//tracker works on the small frame, bbox is kept in full size
+void Engine::initScaled(const Mat &frame) {
+    TrackerBox small = Rect2d(bbox.x / scale, bbox.y / scale, bbox.width / scale, bbox.height / scale);
+    Mat gray; preprocess(frame, gray);
+    tracker->init(gray, small);
+}
+
+void Engine::init(const Mat &frame, const Rect2d &box) {
+    bbox = box;
+    initScaled(frame);
+    framecount = 0;
+    lastok = true;
+    active = true;
+    arena.reset();
+    enforceBudget(frame);
+}
+
+//a new tracker releases the model of the old one
+void Engine::reset() {
+    tracker = createTracker();
+    lastok = false;
+    active = false;
+    procent = 50;
+}
+
+Rect2d Engine::select(const Mat &frame, double x, double y, const Rect2d *detections, int count) {
+    int found = detectionAt(detections, count, x, y);
+    if (found >= 0) {
+        return detections[found];
+    }
+    Mat gray; preprocess(frame, gray);
+    ScratchVector<uint8_t> mask((size_t)w * h, 0, ArenaAllocator<uint8_t>(arena));
+    ScratchVector<int> queue((size_t)w * h, 0, ArenaAllocator<int>(arena));
+    TapBox small;
+    bool ok = segmentAt(gray.data, gray.step, w, h, (int)(x / scale), (int)(y / scale), mask.data(), queue.data(), small);
+    arena.reset();
+    if (!ok) {
+        //nothing stands out under the tap, the old default box size around it
+        double side = frame.cols * 0.2;
+        return Rect2d(x - side / 2, y - side / 2, side, side) & Rect2d(0, 0, frame.cols, frame.rows);
+    }
+    //a little background around the segment keeps its edges inside the tracker window
+    double padx = small.width * scale * 0.1, pady = small.height * scale * 0.1;
+    Rect2d box(small.x * scale - padx, small.y * scale - pady, small.width * scale + 2 * padx, small.height * scale + 2 * pady);
+    return box & Rect2d(0, 0, frame.cols, frame.rows);
+}
+
+Footprint Engine::footprint() const {
+    Footprint bytes;
+    bytes.frames = arena.capacity();
+    if (active) {
+        bytes.tracker = trackerBytes(bbox.width / scale, bbox.height / scale, governor.level().backend);
+    }
+    bytes.other = otherBytes;
+    return bytes;
+}
+
+bool Engine::fits(const Rect2d &box) const {
+    if (!budget) {
+        return true;
+    }
+    //lowest level, the arena holds the gray frame plus a quarter for scratch
+    const gov::Level &lowest = gov::LEVELS[gov::LEVEL_COUNT - 1];
+    size_t frame = (size_t)(srcw / lowest.scale) * (srch / lowest.scale);
+    size_t bytes = frame + frame / 4 + otherBytes
+                   + trackerBytes(box.width / lowest.scale, box.height / lowest.scale, lowest.backend);
+    return bytes <= budget;
+}
+
+//over budget: one level lower per frame, the arena block is made smaller at the end of the frame
+void Engine::enforceBudget(const Mat &frame) {
+    peakBytes = max(peakBytes, footprint().total());
+    if (!budget || footprint().total() <= budget || governor.index() == gov::LEVEL_COUNT - 1) {
+        return;
+    }
+    int from = governor.index();
+    governor.setFloor(from + 1);
+    if (log) {
+        char message[96];
+        snprintf(message, sizeof(message), "memory: %zu bytes over budget %zu, lowering resolution",
+                 footprint().total(), budget);
+        log(message);
+    }
+    applyLevel(frame, from);
+    trimArena = true;
+}
+
+//governor changed quality, move tracker to the new scale and backend keeping the full size box
+void Engine::applyLevel(const Mat &frame, int from) {
+    const gov::Level &level = governor.level();
+    if (log) {
+        char message[128];
+        snprintf(message, sizeof(message), "governor: level %d -> %d, duty %.2f, scale %d, skip %d, %s",
+                 from, governor.index(), governor.duty(), level.scale, level.skip,
+                 level.backend == gov::MOSSE ? "MOSSE" : "KCF");
+        log(message);
+    }
+    scale = level.scale;
+    w = srcw / scale;
+    h = srch / scale;
+    downscale = prep::selectDownscale(srcw, srch, srcc, scale);
+
+    tracker = createTracker();
+    initScaled(frame);
+}
+
+bool Engine::update(const Mat &frame, Rect2d &box) {
+    auto start = chrono::steady_clock::now();
+    bool ok = lastok;
+    //on skipped frames the last box stays
+    if (framecount++ % governor.level().skip == 0) {
+        Mat res_frame; preprocess(frame, res_frame);
+        //trackers leave the box untouched when they lose the target, it stays at the last position
+        TrackerBox small = Rect2d(bbox.x / scale, bbox.y / scale, bbox.width / scale, bbox.height / scale);
+        ok = tracker->update(res_frame, small);
+        if (ok) {
+            bbox = Rect2d(small.x * scale, small.y * scale, small.width * scale, small.height * scale);
+        }
+        lastok = ok;
+    }
+    procent = ok ? (int)((bbox.x + bbox.width / 2) * 100 / srcw) : 50;
+
+    //frame cost against time between frames for the governor
+    double procms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    double intervalms = framecount > 1 ? chrono::duration<double, milli>(start - lastframe).count() : 0;
+    lastframe = start;
+    int from = governor.index();
+    if (governor.update(procms, intervalms)) {
+        applyLevel(frame, from);
+    }
+
+    box = bbox;
+    enforceBudget(frame);
+    arena.reset();
+    if (trimArena) {
+        size_t gray = (size_t)w * h;
+        arena.trim(gray + gray / 4 + 64);
+        trimArena = false;
+    }
+    return ok;
+}
+
+}
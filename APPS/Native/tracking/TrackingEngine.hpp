@@ -0,0 +1,107 @@
+//
+//  TrackingEngine.hpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  One tracking session: preprocessing, OpenCV tracker and quality governor
+
+#ifndef TrackingEngine_hpp
+#define TrackingEngine_hpp
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/tracking.hpp>
+
+#include "FrameArena.hpp"
+#include "FramePreprocess.hpp"
+#include "QualityGovernor.hpp"
+#include "TapSelect.hpp"
+
+namespace track {
+
+typedef std::function<void(const std::string &)> LogFn;
+
+// bytes held by one session
+struct Footprint {
+    size_t frames = 0; // frame arena
+    size_t tracker = 0; // tracker model and features, estimated from the box and OpenCV defaults
+    size_t other = 0; // told by the owner with account() (controller, galleries of the app)
+    size_t total() const { return frames + tracker + other; }
+};
+
+class Engine {
+public:
+    explicit Engine(LogFn log = LogFn());
+
+    // camera frame size, called before the first init
+    void start(int width, int height, int channels);
+
+    // tight box around the object at the tap (full frame pixels) for init, one frame, no inference:
+    // the smallest of the app's detections containing the tap, else a segment of the preprocessed frame
+    cv::Rect2d select(const cv::Mat &frame, double x, double y, const cv::Rect2d *detections, int count);
+
+    // box in full frame pixels
+    void init(const cv::Mat &frame, const cv::Rect2d &box);
+
+    // returns false when the target is lost, box stays at the last position
+    bool update(const cv::Mat &frame, cv::Rect2d &box);
+
+    void reset();
+
+    // 0 - left, 50 - center, 100 - right
+    int position() const { return procent; }
+
+    const gov::QualityGovernor &quality() const { return governor; }
+
+    // scratch memory of the frame stages, reset after every frame
+    const FrameArena &scratch() const { return arena; }
+    // false puts the scratch on the heap every frame, for comparisons
+    void setArena(bool on) { arena.setPooling(on); }
+
+    long frames() const { return framecount; }
+
+    // 0 - no budget, over it the frame resolution goes down (quality governor floor)
+    void setBudget(size_t bytes) { budget = bytes; }
+    size_t memoryBudget() const { return budget; }
+    void account(size_t bytes) { otherBytes = bytes; }
+    Footprint footprint() const;
+    size_t peak() const { return peakBytes; }
+    // still over budget at the lowest resolution, only the owner can free more
+    bool overBudget() const { return budget && footprint().total() > budget; }
+    // false when a target of this size would not fit into the budget even at the lowest resolution
+    bool fits(const cv::Rect2d &box) const;
+
+private:
+    cv::Ptr<cv::Tracker> createTracker() const;
+    void preprocess(const cv::Mat &frame, cv::Mat &gray);
+    void initScaled(const cv::Mat &frame);
+    void applyLevel(const cv::Mat &frame, int from);
+    void enforceBudget(const cv::Mat &frame);
+
+    LogFn log;
+    FrameArena arena;
+    cv::Ptr<cv::Tracker> tracker;
+    cv::Rect2d bbox; // full frame pixels
+    int scale = 3;
+    int w = 0, h = 0; // tracker frame size
+    int srcw = 0, srch = 0, srcc = 0; // camera frame size
+    prep::DownscaleFn downscale = &prep::downscaleGrayGeneric; // chosen in start for camera size
+    gov::QualityGovernor governor;
+    long framecount = 0;
+    bool lastok = false;
+    bool active = false; // tracker holds a target
+    size_t budget = 0;
+    size_t otherBytes = 0;
+    size_t peakBytes = 0;
+    bool trimArena = false;
+    int procent = 50;
+    std::chrono::steady_clock::time_point lastframe;
+};
+
+}
+
+#endif /* TrackingEngine_hpp */
@@ -0,0 +1,365 @@
+//
+//  tracking.cpp
+//  Native
+//
+//  Created by Jakub Adamski on 17/10/2026.
+//  Copyright © 2026 Jakub Adamski. All rights reserved.
+//  C interface over track::Engine, no exception leaves this file
+
+#include "tracking.h"
+#include "TrackingEngine.hpp"
+#include "GimbalController.hpp"
+#include "track_sidecar.h"
+
+#include <cstdio>
+#include <exception>
+#include <new>
+#include <vector>
+
+namespace {
+
+void stderrlog(const char *message) {
+    fprintf(stderr, "tracking: %s\n", message);
+}
+
+trk_log_fn logfn = &stderrlog;
+
+//trk_target velocity smoothing, the board's loop feeds it forward and a slow one lags at every turn
+const double targetAlpha = 0.5;
+
+void logmessage(const std::string &message) {
+    if (logfn) {
+        logfn(message.c_str());
+    }
+}
+
+//frame memory is not copied, the Mat only points to it
+bool wrap(const trk_frame *frame, cv::Mat &mat) {
+    if (!frame || !frame->data || (frame->channels != 3 && frame->channels != 4)) {
+        return false;
+    }
+    mat = cv::Mat(frame->height, frame->width, CV_8UC(frame->channels), const_cast<uint8_t *>(frame->data), frame->stride);
+    return true;
+}
+
+}
+
+struct trk_session {
+    track::Engine engine{&logmessage};
+    ctrl::GimbalController controller;
+    bool started = false;
+    bool tracked = false; // result of the last update for the controller
+    unsigned updates = 0;
+    // trk_target, motion of the target in the frame
+    bool targetStarted = false;
+    unsigned targetUpdate = 0;
+    double targetTime = 0;
+    double targetBearing = 0;
+    double targetVelocity = 0;
+    size_t external = 0; // trk_account
+    int width = 0, height = 0;
+    // last results for the sidecar
+    tsc_record last{};
+    tsc_writer *sidecar = nullptr;
+
+    trk_session() {
+        engine.account(sizeof(controller));
+    }
+
+    ~trk_session() {
+        if (sidecar) {
+            tsc_close(sidecar);
+        }
+    }
+};
+
+extern "C" {
+
+int trk_abi_version(void) {
+    return TRK_ABI_VERSION;
+}
+
+void trk_set_log(trk_log_fn log) {
+    logfn = log ? log : &stderrlog;
+}
+
+trk_session *trk_create(void) {
+    try {
+        return new trk_session();
+    } catch (const std::exception &e) {
+        logmessage(std::string("create failed: ") + e.what());
+        return nullptr;
+    }
+}
+
+void trk_destroy(trk_session *session) {
+    delete session;
+}
+
+int trk_start(trk_session *session, int width, int height, int channels) {
+    if (!session || width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
+        return TRK_ERROR;
+    }
+    try {
+        session->engine.start(width, height, channels);
+    } catch (const std::exception &e) {
+        logmessage(std::string("start failed: ") + e.what());
+        return TRK_ERROR;
+    }
+    session->started = true;
+    session->width = width;
+    session->height = height;
+    return TRK_TRACKED;
+}
+
+int trk_init(trk_session *session, const trk_frame *frame, trk_box box) {
+    cv::Mat mat;
+    if (!session || !session->started || !wrap(frame, mat) || box.width <= 0 || box.height <= 0) {
+        return TRK_ERROR;
+    }
+    cv::Rect2d rect(box.x, box.y, box.width, box.height);
+    if (!session->engine.fits(rect)) {
+        logmessage("init refused, target does not fit into the memory budget");
+        return TRK_BUDGET;
+    }
+    try {
+        session->engine.init(mat, rect);
+        return TRK_TRACKED;
+    } catch (const std::exception &e) {
+        logmessage(std::string("init failed: ") + e.what());
+        return TRK_ERROR;
+    }
+}
+
+int trk_select(trk_session *session, const trk_frame *frame, double x, double y,
+               const trk_box *detections, int count, trk_box *box) {
+    cv::Mat mat;
+    if (!session || !session->started || !wrap(frame, mat) || !box || count < 0 || (count > 0 && !detections)) {
+        return TRK_ERROR;
+    }
+    try {
+        std::vector<cv::Rect2d> boxes;
+        for (int i = 0; i < count; i++) {
+            boxes.emplace_back(detections[i].x, detections[i].y, detections[i].width, detections[i].height);
+        }
+        cv::Rect2d result = session->engine.select(mat, x, y, boxes.data(), count);
+        box->x = result.x;
+        box->y = result.y;
+        box->width = result.width;
+        box->height = result.height;
+        return result.area() > 0 ? TRK_TRACKED : TRK_LOST;
+    } catch (const std::exception &e) {
+        logmessage(std::string("select failed: ") + e.what());
+        return TRK_ERROR;
+    }
+}
+
+int trk_update(trk_session *session, const trk_frame *frame, trk_box *box) {
+    cv::Mat mat;
+    if (!session || !session->started || !wrap(frame, mat) || !box) {
+        return TRK_ERROR;
+    }
+    try {
+        cv::Rect2d result;
+        bool ok = session->engine.update(mat, result);
+        box->x = result.x;
+        box->y = result.y;
+        box->width = result.width;
+        box->height = result.height;
+        session->tracked = ok;
+        session->updates++;
+        session->last.status = ok ? TSC_TRACKED : TSC_LOST;
+        session->last.x = (float)result.x;
+        session->last.y = (float)result.y;
+        session->last.width = (float)result.width;
+        session->last.height = (float)result.height;
+        return ok ? TRK_TRACKED : TRK_LOST;
+    } catch (const std::exception &e) {
+        logmessage(std::string("update failed: ") + e.what());
+        return TRK_ERROR;
+    }
+}
+
+void trk_reset(trk_session *session) {
+    if (!session) {
+        return;
+    }
+    try {
+        session->engine.reset();
+    } catch (const std::exception &e) {
+        logmessage(std::string("reset failed: ") + e.what());
+    }
+    session->tracked = false;
+    session->last = tsc_record{};
+}
+
+int trk_position(const trk_session *session) {
+    return session ? session->engine.position() : 50;
+}
+
+int trk_get_stats(const trk_session *session, trk_stats *stats) {
+    if (!session || !stats) {
+        return TRK_ERROR;
+    }
+    const track::FrameArena &arena = session->engine.scratch();
+    stats->frames = session->engine.frames();
+    stats->scratch_capacity = arena.capacity();
+    stats->scratch_peak = arena.peak();
+    stats->scratch_growths = arena.growthCount();
+    return TRK_TRACKED;
+}
+
+int trk_set_arena(trk_session *session, int enabled) {
+    if (!session) {
+        return TRK_ERROR;
+    }
+    session->engine.setArena(enabled != 0);
+    return TRK_TRACKED;
+}
+
+int trk_set_budget(trk_session *session, size_t bytes) {
+    if (!session) {
+        return TRK_ERROR;
+    }
+    session->engine.setBudget(bytes);
+    return TRK_TRACKED;
+}
+
+int trk_account(trk_session *session, size_t bytes) {
+    if (!session) {
+        return TRK_ERROR;
+    }
+    session->external = bytes;
+    session->engine.account(sizeof(session->controller) + bytes);
+    return TRK_TRACKED;
+}
+
+int trk_get_memory(const trk_session *session, trk_memory *memory) {
+    if (!session || !memory) {
+        return TRK_ERROR;
+    }
+    track::Footprint bytes = session->engine.footprint();
+    memory->frames = bytes.frames;
+    memory->tracker = bytes.tracker;
+    memory->telemetry = sizeof(session->controller);
+    memory->external = session->external;
+    memory->total = bytes.total();
+    memory->peak = session->engine.peak();
+    memory->budget = session->engine.memoryBudget();
+    memory->over = session->engine.overBudget();
+    return TRK_TRACKED;
+}
+
+void trk_control_defaults(trk_control_config *config) {
+    if (!config) {
+        return;
+    }
+    ctrl::ControllerConfig cfg;
+    config->kp = cfg.kp;
+    config->ki = cfg.ki;
+    config->kd = cfg.kd;
+    config->kff = cfg.kff;
+    config->max_rate = cfg.maxRate;
+    config->max_accel = cfg.maxAccel;
+    config->deadband = cfg.deadband;
+    config->latency = cfg.latency;
+}
+
+int trk_set_control(trk_session *session, const trk_control_config *config) {
+    if (!session || !config || config->max_rate <= 0 || config->max_accel <= 0) {
+        return TRK_ERROR;
+    }
+    ctrl::ControllerConfig cfg;
+    cfg.kp = config->kp;
+    cfg.ki = config->ki;
+    cfg.kd = config->kd;
+    cfg.kff = config->kff;
+    cfg.maxRate = config->max_rate;
+    cfg.maxAccel = config->max_accel;
+    cfg.deadband = config->deadband;
+    cfg.latency = config->latency;
+    session->controller.configure(cfg);
+    return TRK_TRACKED;
+}
+
+double trk_control(trk_session *session, double time) {
+    if (!session) {
+        return 0;
+    }
+    double rate = session->controller.update(time, session->engine.position(), session->tracked);
+    session->last.rate = (float)rate;
+    return rate;
+}
+
+int trk_target(trk_session *session, double time, double *bearing, double *velocity) {
+    if (!session || !bearing || !velocity) {
+        return TRK_ERROR;
+    }
+    *bearing = 0;
+    *velocity = 0;
+    if (!session->tracked || session->width <= 0) {
+        session->targetStarted = false;
+        return TRK_LOST;
+    }
+    //box center, finer than trk_position percent
+    double now = (session->last.x + session->last.width / 2) / session->width - 0.5;
+    double dt = time - session->targetTime;
+    if (session->targetStarted && session->targetUpdate == session->updates) {
+        //no new result since the last call
+        *bearing = session->targetBearing;
+        *velocity = session->targetVelocity;
+        return TRK_TRACKED;
+    }
+    if (session->targetStarted && dt > 0 && dt < 1) {
+        session->targetVelocity += targetAlpha * ((now - session->targetBearing) / dt - session->targetVelocity);
+    } else {
+        session->targetVelocity = 0;
+    }
+    session->targetStarted = true;
+    session->targetUpdate = session->updates;
+    session->targetTime = time;
+    session->targetBearing = now;
+    *bearing = now;
+    *velocity = session->targetVelocity;
+    return TRK_TRACKED;
+}
+
+int trk_record_open(trk_session *session, const char *path, int32_t timescale) {
+    if (!session || !path || timescale <= 0) {
+        return TRK_ERROR;
+    }
+    trk_record_close(session);
+    tsc_header header = {(uint32_t)timescale, (uint32_t)session->width, (uint32_t)session->height};
+    session->sidecar = tsc_create(path, &header);
+    if (!session->sidecar) {
+        logmessage(std::string("cannot create sidecar ") + path);
+        return TRK_ERROR;
+    }
+    return TRK_TRACKED;
+}
+
+int trk_record(trk_session *session, int64_t pts) {
+    if (!session) {
+        return TRK_ERROR;
+    }
+    if (!session->sidecar) {
+        return TRK_LOST;
+    }
+    session->last.pts = pts;
+    return tsc_write(session->sidecar, &session->last) == 0 ? TRK_TRACKED : TRK_ERROR;
+}
+
+int trk_record_close(trk_session *session) {
+    if (!session || !session->sidecar) {
+        return session ? TRK_LOST : TRK_ERROR;
+    }
+    int status = tsc_close(session->sidecar);
+    session->sidecar = nullptr;
+    if (status != 0) {
+        logmessage("sidecar write failed");
+        return TRK_ERROR;
+    }
+    return TRK_TRACKED;
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ *  tracking.h
+ *  Native
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  C interface of the tracking engine - used from Objective-C++ (iOS), JNI (Android) and C tools
+ */
+
+#ifndef tracking_h
+#define tracking_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on every incompatible change of this header
+   2: trk_init can return TRK_BUDGET; stats, arena switch, memory budget, controller, target,
+      tap selection and sidecar calls added */
+#define TRK_ABI_VERSION 2
+
+typedef struct trk_session trk_session;
+
+/* interleaved 8 bit frame, 3 or 4 channels, channel 0 is treated as blue */
+typedef struct {
+    const uint8_t *data;
+    size_t stride;
+    int width;
+    int height;
+    int channels;
+} trk_frame;
+
+/* box in frame pixels */
+typedef struct {
+    double x;
+    double y;
+    double width;
+    double height;
+} trk_box;
+
+enum {
+    TRK_BUDGET = -2, /* trk_init: the target does not fit into the memory budget */
+    TRK_ERROR = -1,
+    TRK_LOST = 0,
+    TRK_TRACKED = 1
+};
+
+typedef void (*trk_log_fn)(const char *message);
+
+/* counters of one session */
+typedef struct {
+    long frames;
+    size_t scratch_capacity; /* per-frame arena */
+    size_t scratch_peak;
+    unsigned long scratch_growths; /* allocations because a frame did not fit, constant in steady state */
+} trk_stats;
+
+/* bytes held by one session */
+typedef struct {
+    size_t frames; /* frame arena */
+    size_t tracker; /* tracker model and features, estimated */
+    size_t telemetry; /* controller history */
+    size_t external; /* told by the app with trk_account (galleries, embeddings) */
+    size_t total;
+    size_t peak;
+    size_t budget; /* 0 - no budget */
+    int over; /* over budget even at the lowest resolution, the app should free what it accounted */
+} trk_memory;
+
+/* gimbal controller, see control/GimbalController.hpp for units */
+typedef struct {
+    double kp;
+    double ki;
+    double kd;
+    double kff;
+    double max_rate;
+    double max_accel;
+    double deadband;
+    double latency;
+} trk_control_config;
+
+int trk_abi_version(void);
+
+/* log messages of all sessions (quality changes, errors), default is stderr */
+void trk_set_log(trk_log_fn log);
+
+trk_session *trk_create(void);
+void trk_destroy(trk_session *session);
+
+/* camera frame size, picks preprocessing kernels and resets quality level */
+int trk_start(trk_session *session, int width, int height, int channels);
+
+/* starts tracking box on frame */
+int trk_init(trk_session *session, const trk_frame *frame, trk_box box);
+
+/* box around the object at tap point (x, y) in frame pixels, ready for trk_init, within one frame:
+   the smallest of detections (count may be 0) containing the tap, else a segment of the frame */
+int trk_select(trk_session *session, const trk_frame *frame, double x, double y,
+               const trk_box *detections, int count, trk_box *box);
+
+/* tracks on the next frame, box is the current position (also when lost) */
+int trk_update(trk_session *session, const trk_frame *frame, trk_box *box);
+
+/* drops the target, trk_init starts again */
+void trk_reset(trk_session *session);
+
+/* horizontal position of the target 0 - left, 50 - center (or lost), 100 - right */
+int trk_position(const trk_session *session);
+
+int trk_get_stats(const trk_session *session, trk_stats *stats);
+/* 0 gives the per-frame scratch back to the heap after every frame instead of reusing it, for comparisons */
+int trk_set_arena(trk_session *session, int enabled);
+
+/* hard memory limit of the session in bytes, 0 turns it off
+   over it the frame resolution goes down and trk_init refuses targets that would not fit (TRK_BUDGET) */
+int trk_set_budget(trk_session *session, size_t bytes);
+/* memory the app holds for this session (galleries, embeddings), counted into the budget */
+int trk_account(trk_session *session, size_t bytes);
+int trk_get_memory(const trk_session *session, trk_memory *memory);
+
+void trk_control_defaults(trk_control_config *config);
+int trk_set_control(trk_session *session, const trk_control_config *config);
+
+/* gimbal rate setpoint from the last trk_update result, time in seconds of any monotonic clock
+   positive turns right, in frame widths per second */
+double trk_control(trk_session *session, double time);
+
+/* the target for a board that runs the control loop itself (GP_TRACK): bearing from the center of the frame
+   in frame widths, positive is right, and its velocity in the frame in frame widths per second from the
+   trk_update results so far, TRK_LOST and zeros when the target is lost */
+int trk_target(trk_session *session, double time, double *bearing, double *velocity);
+
+/* sidecar file with the results of this session next to a recorded video (record/track_sidecar.h),
+   timescale is pts units per second, an open sidecar is replaced */
+int trk_record_open(trk_session *session, const char *path, int32_t timescale);
+/* appends the last trk_update result and trk_control rate for the video frame shown at pts,
+   call once per tracked frame with increasing pts, no-op without an open sidecar */
+int trk_record(trk_session *session, int64_t pts);
+/* flushes and closes, TRK_ERROR when some records did not reach the file */
+int trk_record_close(trk_session *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tracking_h */
@@ -25,10 +25,25 @@
 #include "gatt_db.h"
 
 #include "app.h"
+#include "motion_service.h"
+#include "scheduler.h"
+
+#if PLANNER_BENCHMARK
+#include "em_device.h"
+#include "planner_bench.h"
+#endif
+
+/* Handle one stack event */
+static void handleEvent(struct gecko_cmd_packet *evt);
 
 /* Print boot message */
 static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt);
 
+#if PLANNER_BENCHMARK
+/* Time the planner scenarios with the cycle counter */
+static void plannerBenchmark(void);
+#endif
+
 /* Flag for indicating DFU Reset must be performed */
 static uint8_t boot_to_dfu = 0;
 
@@ -45,88 +60,139 @@ void appMain(gecko_configuration_t *pconfig)
   /* Initialize stack */
   gecko_init(pconfig);
 
+  sched_init();
+  motion_init();
 
   while (1) {
 
-    /* Event pointer for handling events */
-    struct gecko_cmd_packet* evt;
+    /* Check for stack event without blocking (UG136), tasks run between the events */
+    struct gecko_cmd_packet* evt = gecko_peek_event();
 
-    /* if there are no events pending then the next call to gecko_wait_event() may cause
-     * device go to deep sleep. Make sure that debug prints are flushed before going to sleep */
-    if (!gecko_event_pending()) {
-      flushLog();
+    if (evt) {
+      handleEvent(evt);
     }
 
-    /* Check for stack event. This is a blocking event listener. If you want non-blocking please see UG136. */
-    evt = gecko_wait_event();
-
-    /* Handle events */
-    switch (BGLIB_MSG_ID(evt->header)) {
-      /* This boot event is generated when the system boots up after reset.
-       * Do not call any stack commands before receiving the boot event.
-       * Here the system is set to start advertising immediately after boot procedure. */
-      case gecko_evt_system_boot_id:
-
-        bootMessage(&(evt->data.evt_system_boot));
-        printLog("boot event - starting advertising\r\n");
-
-        /* Set advertising parameters. 100ms advertisement interval.
-         * The first parameter is advertising set handle
-         * The next two parameters are minimum and maximum advertising interval, both in
-         * units of (milliseconds * 1.6).
-         * The last two parameters are duration and maxevents left as default. */
-        gecko_cmd_le_gap_set_advertise_timing(0, 160, 160, 0, 0);
-
-        /* Start general advertising and enable connections. */
-        gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
-        break;
-
-      case gecko_evt_le_connection_opened_id:
-
-        printLog("connection opened\r\n");
-
-        break;
+    /* One event and one due task per pass, so neither a burst of writes nor a task starves the other */
+    if (!sched_dispatch() && !evt) {
+      /* Nothing to do: flush debug prints and sleep (EM2) until the next task release or stack event */
+      flushLog();
+      sched_sleep();
+    }
+  }
+}
 
-      case gecko_evt_le_connection_closed_id:
+/* Stack events of appMain */
+static void handleEvent(struct gecko_cmd_packet *evt)
+{
+  switch (BGLIB_MSG_ID(evt->header)) {
+    /* This boot event is generated when the system boots up after reset.
+     * Do not call any stack commands before receiving the boot event.
+     * Here the system is set to start advertising immediately after boot procedure. */
+    case gecko_evt_system_boot_id:
+
+      bootMessage(&(evt->data.evt_system_boot));
+#if PLANNER_BENCHMARK
+      plannerBenchmark();
+#endif
+      printLog("boot event - starting advertising\r\n");
 
-        printLog("connection closed, reason: 0x%2.2x\r\n", evt->data.evt_le_connection_closed.reason);
+      /* Set advertising parameters. 100ms advertisement interval.
+       * The first parameter is advertising set handle
+       * The next two parameters are minimum and maximum advertising interval, both in
+       * units of (milliseconds * 1.6).
+       * The last two parameters are duration and maxevents left as default. */
+      gecko_cmd_le_gap_set_advertise_timing(0, 160, 160, 0, 0);
 
-        /* Check if need to boot to OTA DFU mode */
-        if (boot_to_dfu) {
-          /* Enter to OTA DFU mode */
-          gecko_cmd_system_reset(2);
-        } else {
-          /* Restart advertising after client has disconnected */
-          gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
-        }
-        break;
+      /* Start general advertising and enable connections. */
+      gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+      break;
 
-      /* Events related to OTA upgrading
-         ----------------------------------------------------------------------------- */
+    case gecko_evt_le_connection_opened_id:
 
-      /* Check if the user-type OTA Control Characteristic was written.
-       * If ota_control was written, boot the device into Device Firmware Upgrade (DFU) mode. */
-      case gecko_evt_gatt_server_user_write_request_id:
+      printLog("connection opened\r\n");
+      motion_connection_opened(evt->data.evt_le_connection_opened.connection);
 
-        if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_ota_control) {
-          /* Set flag to enter to OTA mode */
-          boot_to_dfu = 1;
-          /* Send response to Write Request */
-          gecko_cmd_gatt_server_send_user_write_response(
-            evt->data.evt_gatt_server_user_write_request.connection,
-            gattdb_ota_control,
-            bg_err_success);
+      break;
 
-          /* Close connection to enter to DFU OTA mode */
-          gecko_cmd_le_connection_close(evt->data.evt_gatt_server_user_write_request.connection);
-        }
-        break;
+    case gecko_evt_le_connection_closed_id:
 
-      /* Add additional event handlers as your application requires */
+      printLog("connection closed, reason: 0x%2.2x\r\n", evt->data.evt_le_connection_closed.reason);
+      /* no phone, no setpoints - the gimbal must not keep turning */
+      motion_connection_closed();
 
-      default:
-        break;
-    }
+      /* Check if need to boot to OTA DFU mode */
+      if (boot_to_dfu) {
+        /* Enter to OTA DFU mode */
+        gecko_cmd_system_reset(2);
+      } else {
+        /* Restart advertising after client has disconnected */
+        gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+      }
+      break;
+
+    /* Events related to OTA upgrading
+       ----------------------------------------------------------------------------- */
+
+    /* Check if the user-type OTA Control Characteristic was written.
+     * If ota_control was written, boot the device into Device Firmware Upgrade (DFU) mode. */
+    case gecko_evt_gatt_server_user_write_request_id:
+
+      /* Motion setpoint is written without response: decoded and applied here, nothing to answer */
+      if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_motion_setpoint) {
+        motion_setpoint_written(evt->data.evt_gatt_server_user_write_request.value.data,
+                                evt->data.evt_gatt_server_user_write_request.value.len);
+      } else if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_motion_config) {
+        motion_config_written(evt->data.evt_gatt_server_user_write_request.connection,
+                              evt->data.evt_gatt_server_user_write_request.value.data,
+                              evt->data.evt_gatt_server_user_write_request.value.len);
+      } else if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_motion_gains) {
+        motion_gains_written(evt->data.evt_gatt_server_user_write_request.connection,
+                             evt->data.evt_gatt_server_user_write_request.value.data,
+                             evt->data.evt_gatt_server_user_write_request.value.len);
+      } else if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_ota_control) {
+        /* Set flag to enter to OTA mode */
+        boot_to_dfu = 1;
+        /* Send response to Write Request */
+        gecko_cmd_gatt_server_send_user_write_response(
+          evt->data.evt_gatt_server_user_write_request.connection,
+          gattdb_ota_control,
+          bg_err_success);
+
+        /* Close connection to enter to DFU OTA mode */
+        gecko_cmd_le_connection_close(evt->data.evt_gatt_server_user_write_request.connection);
+      }
+      break;
+
+    /* Events related to motion control
+       ----------------------------------------------------------------------------- */
+
+    case gecko_evt_gatt_server_user_read_request_id:
+
+      if (evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_motion_config) {
+        motion_config_read(evt->data.evt_gatt_server_user_read_request.connection);
+      } else if (evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_motion_gains) {
+        motion_gains_read(evt->data.evt_gatt_server_user_read_request.connection);
+      }
+      break;
+
+    /* Phone enabled or disabled status notifications */
+    case gecko_evt_gatt_server_characteristic_status_id:
+
+      if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_motion_status
+          && evt->data.evt_gatt_server_characteristic_status.status_flags == gatt_server_client_config) {
+        motion_status_config(evt->data.evt_gatt_server_characteristic_status.connection,
+                             evt->data.evt_gatt_server_characteristic_status.client_config_flags);
+      }
+      break;
+
+    /* Scheduler wakeup (SCHED_SIGNAL), the due tasks run after this event */
+    case gecko_evt_system_external_signal_id:
+      break;
+
+    /* Add additional event handlers as your application requires */
+
+    default:
+      break;
   }
 }
 
@@ -147,3 +213,30 @@ static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt)
   printLog("%2.2x\r\n", local_addr.addr[0]);
 #endif
 }
+
+#if PLANNER_BENCHMARK
+static uint32_t cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+static void plannerBenchmark(void)
+{
+  pb_result result;
+  int i;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  for (i = 0; i < PB_SCENARIOS; i++) {
+    pb_run(i, cycles, NULL, &result);
+    /* the hash has to be the one simulation/plansim computes, the board rounds the same way */
+    printLog("planner %s: %lu cycles per slice, %lu per step, worst fill %lu, hash %s\r\n", result.name,
+             (unsigned long)(result.cycles / (result.slices ? result.slices : 1)),
+             (unsigned long)(result.cycles / (result.steps ? result.steps : 1)),
+             (unsigned long)result.cycles_max, result.hash == pb_expected[i] ? "ok" : "DIFFERENT");
+    flushLog();
+  }
+}
+#endif
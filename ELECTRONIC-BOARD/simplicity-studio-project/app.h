@@ -25,6 +25,9 @@
 /* Set this value to 1 if you want to disable deep sleep completely */
 #define DISABLE_SLEEP 0
 
+/* Set this value to 1 to time the motion planner at boot (planner_bench.h), results are debug prints */
+#define PLANNER_BENCHMARK 0
+
 #if DEBUG_LEVEL
 #include "retargetserial.h"
 #include <stdio.h>
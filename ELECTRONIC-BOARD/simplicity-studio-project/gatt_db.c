@@ -34,11 +34,65 @@ GATT_DATA(const uint8_t bg_gattdb_data_uuidtable_128_map [])=
 {
 0xf0, 0x19, 0x21, 0xb4, 0x47, 0x8f, 0xa4, 0xbf, 0xa1, 0x4f, 0x63, 0xfd, 0xee, 0xd6, 0x14, 0x1d, 
 0x63, 0x60, 0x32, 0xe0, 0x37, 0x5e, 0xa4, 0x88, 0x53, 0x4e, 0x6d, 0xfb, 0x64, 0x35, 0xbf, 0xf7, 
+0x10, 0x5c, 0x4a, 0x0e, 0x6d, 0x3b, 0x21, 0x9f, 0x8e, 0x4c, 0x1b, 0x5e, 0x01, 0x00, 0xc3, 0xa7, 
+0x10, 0x5c, 0x4a, 0x0e, 0x6d, 0x3b, 0x21, 0x9f, 0x8e, 0x4c, 0x1b, 0x5e, 0x02, 0x00, 0xc3, 0xa7, 
+0x10, 0x5c, 0x4a, 0x0e, 0x6d, 0x3b, 0x21, 0x9f, 0x8e, 0x4c, 0x1b, 0x5e, 0x03, 0x00, 0xc3, 0xa7, 
+0x10, 0x5c, 0x4a, 0x0e, 0x6d, 0x3b, 0x21, 0x9f, 0x8e, 0x4c, 0x1b, 0x5e, 0x04, 0x00, 0xc3, 0xa7, 
+0x10, 0x5c, 0x4a, 0x0e, 0x6d, 0x3b, 0x21, 0x9f, 0x8e, 0x4c, 0x1b, 0x5e, 0x05, 0x00, 0xc3, 0xa7, 
 };
 
 
 
 
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_32 ) = {
+	.properties=0x0a,
+	.index=8,
+	.max_len=0,
+	.data=NULL,
+};
+
+GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_31 ) = {
+	.len=19,
+	.data={0x0a,0x21,0x00,0x10,0x5c,0x4a,0x0e,0x6d,0x3b,0x21,0x9f,0x8e,0x4c,0x1b,0x5e,0x05,0x00,0xc3,0xa7,}
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_30 ) = {
+	.properties=0x0a,
+	.index=7,
+	.max_len=0,
+	.data=NULL,
+};
+
+GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_29 ) = {
+	.len=19,
+	.data={0x0a,0x1f,0x00,0x10,0x5c,0x4a,0x0e,0x6d,0x3b,0x21,0x9f,0x8e,0x4c,0x1b,0x5e,0x04,0x00,0xc3,0xa7,}
+};
+uint8_t bg_gattdb_data_attribute_field_27_data[8]={0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_27 ) = {
+	.properties=0x12,
+	.index=6,
+	.max_len=8,
+	.data=bg_gattdb_data_attribute_field_27_data,
+};
+
+GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_26 ) = {
+	.len=19,
+	.data={0x12,0x1c,0x00,0x10,0x5c,0x4a,0x0e,0x6d,0x3b,0x21,0x9f,0x8e,0x4c,0x1b,0x5e,0x03,0x00,0xc3,0xa7,}
+};
+GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_25 ) = {
+	.properties=0x04,
+	.index=5,
+	.max_len=0,
+	.data=NULL,
+};
+
+GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_24 ) = {
+	.len=19,
+	.data={0x04,0x1a,0x00,0x10,0x5c,0x4a,0x0e,0x6d,0x3b,0x21,0x9f,0x8e,0x4c,0x1b,0x5e,0x02,0x00,0xc3,0xa7,}
+};
+GATT_DATA(const struct bg_gattdb_buffer_with_len	bg_gattdb_data_attribute_field_23 ) = {
+	.len=16,
+	.data={0x10,0x5c,0x4a,0x0e,0x6d,0x3b,0x21,0x9f,0x8e,0x4c,0x1b,0x5e,0x01,0x00,0xc3,0xa7,}
+};
 GATT_DATA(const struct bg_gattdb_attribute_chrvalue	bg_gattdb_data_attribute_field_22 ) = {
 	.properties=0x08,
 	.index=4,
@@ -170,6 +224,16 @@ GATT_DATA(const struct bg_gattdb_attribute bg_gattdb_data_attributes_map[])={
     {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_20},
     {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_21},
     {.uuid=0x8001,.permissions=0x802,.caps=0xffff,.datatype=0x07,.dynamicdata=&bg_gattdb_data_attribute_field_22},
+    {.uuid=0x0000,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_23},
+    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_24},
+    {.uuid=0x8003,.permissions=0x804,.caps=0xffff,.datatype=0x07,.dynamicdata=&bg_gattdb_data_attribute_field_25},
+    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_26},
+    {.uuid=0x8004,.permissions=0x801,.caps=0xffff,.datatype=0x01,.dynamicdata=&bg_gattdb_data_attribute_field_27},
+    {.uuid=0x000e,.permissions=0x807,.caps=0xffff,.datatype=0x03,.configdata={.flags=0x01,.index=0x06,.clientconfig_index=0x01}},
+    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_29},
+    {.uuid=0x8005,.permissions=0x803,.caps=0xffff,.datatype=0x07,.dynamicdata=&bg_gattdb_data_attribute_field_30},
+    {.uuid=0x0002,.permissions=0x801,.caps=0xffff,.datatype=0x00,.constdata=&bg_gattdb_data_attribute_field_31},
+    {.uuid=0x8006,.permissions=0x803,.caps=0xffff,.datatype=0x07,.dynamicdata=&bg_gattdb_data_attribute_field_32},
 };
 
 GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[])={
@@ -178,18 +242,22 @@ GATT_DATA(const uint16_t bg_gattdb_data_attributes_dynamic_mapping_map[])={
 	0x0008,
 	0x000b,
 	0x0017,
+	0x001a,
+	0x001c,
+	0x001f,
+	0x0021,
 };
 
 GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid16_map[])={0x0};
 GATT_DATA(const uint8_t bg_gattdb_data_adv_uuid128_map[])={0x0};
 GATT_HEADER(const struct bg_gattdb_def bg_gattdb_data)={
     .attributes=bg_gattdb_data_attributes_map,
-    .attributes_max=23,
+    .attributes_max=33,
     .uuidtable_16_size=15,
     .uuidtable_16=bg_gattdb_data_uuidtable_16_map,
-    .uuidtable_128_size=2,
+    .uuidtable_128_size=7,
     .uuidtable_128=bg_gattdb_data_uuidtable_128_map,
-    .attributes_dynamic_max=5,
+    .attributes_dynamic_max=9,
     .attributes_dynamic_mapping=bg_gattdb_data_attributes_dynamic_mapping_map,
     .adv_uuid16=bg_gattdb_data_adv_uuid16_map,
     .adv_uuid16_num=0,
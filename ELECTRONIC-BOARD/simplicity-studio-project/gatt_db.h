@@ -18,5 +18,9 @@ extern const struct bg_gattdb_def bg_gattdb_data;
 #define gattdb_client_support_features          8
 #define gattdb_device_name                     11
 #define gattdb_ota_control                     23
+#define gattdb_motion_setpoint                 26
+#define gattdb_motion_status                   28
+#define gattdb_motion_config                   31
+#define gattdb_motion_gains                    33
 
 #endif
@@ -0,0 +1,551 @@
+/*
+ *  motion_service.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Setpoints are decoded in the event handler of the write, no strings and no queue,
+ *  so a command takes effect in the connection event it arrived in
+ *  the timeout and the status notifications are scheduler tasks (scheduler.h)
+ *  the planner runs in the feed task, a few segments ahead of the motor, so the handlers only set targets
+ *
+ *  GP_TRACK: the loop timer interrupt keeps a history of the motor position, a frame is placed on it at
+ *  its capture time, the latency back from its arrival plus how much later than the quickest frame
+ *  of the last seconds it came (the phone stamps frames with its own clock), so the target's position
+ *  and velocity are known at capture; the control task extrapolates them to now. Float on the FPU
+ */
+
+#include <math.h>
+
+#include "bg_types.h"
+#include "native_gecko.h"
+#include "gatt_db.h"
+#include "nvm3.h"
+#include "sl_sleeptimer.h"
+
+#include "app.h"
+#include "motion_service.h"
+#include "planner.h"
+#include "scheduler.h"
+#include "step_table.h"
+#include "stepper.h"
+
+static const motion_config defaults = {
+  .max_velocity = 2000, /* two frame widths per second */
+  .timeout_ms = 2500,   /* phone repeats unchanged setpoints every second */
+  .flags = 0,
+};
+
+static const motion_gains gain_defaults = {
+  .kp = 8000,           /* an error of 1/10 frame width (53 steps) is closed at 427 steps/s */
+  .ki = 0,              /* the target keeps moving, a big integral winds up at every turn */
+  .kd = 0,
+  .kff = 1000,
+  .latency_ms = 100,    /* camera, tracker and the wait for a connection event */
+};
+
+/* loop period, ticks of the history */
+#define LOOP_TICKS (SCHED_TICKS_PER_S / MOTION_LOOP_HZ)
+/* motor positions kept, back to the oldest capture the latency allows */
+#define HISTORY 64
+#define MAX_LATENCY_MS 400
+/* frames delivered later than this after the quickest one are placed as if they were this late */
+#define MAX_EXCESS_MS 100
+/* the motor's velocity at a capture is taken over this, the phone filters its velocity too */
+#define VELOCITY_TICKS SCHED_MS(100)
+/* the target moves on from its last measurement at most this long */
+#define PREDICT_TICKS SCHED_MS(500)
+/* the least delay is found again every window, the phone's clock may drift */
+#define WINDOW_TICKS SCHED_MS(2000)
+/* the correction brakes to the target with half the planner's acceleration, kp alone overshoots big errors */
+#define BRAKE_ACCEL (MOTION_ACCEL / 2)
+/* a segment has 4 steps at least, slower commands would hold the motor at a crawl for seconds: they are
+   0 within SETTLED steps of the target and MIN_VELOCITY steps/s towards it further away */
+#define MIN_VELOCITY 60
+#define SETTLED 3
+/* steps in 1/1000 of a frame width */
+#define FRAME_STEPS ((float)MOTION_FRAME_DEGREES * MOTION_STEPS_PER_TURN / (360 * 1000))
+
+static motion_config config;
+static motion_gains gains;
+static motion_state state;
+static gp_receiver receiver;
+static uint8_t connection_handle = 0xff;
+static uint8_t notify = 0;
+static uint8_t changed = 0;
+
+static planner pl;
+/* the planner fills one segment while the stepper plays the other */
+static uint32_t segments[2][MOTION_SEGMENT];
+static uint8_t filling = 0;
+/* intervals in segments[filling] the stepper did not take yet */
+static uint32_t pending = 0;
+static int pending_direction = 1;
+
+static struct {
+  /* written by the loop timer interrupt, head is the newest sample; samples stays a slot short of HISTORY,
+     a reader the interrupt comes in on never reaches the slot it writes */
+  uint64_t tick[HISTORY];
+  int32_t position[HISTORY];
+  volatile uint8_t head;
+  volatile uint8_t samples;
+
+  /* target at the capture of the last frame, steps and steps/s */
+  uint8_t valid;
+  uint64_t capture;
+  float target;
+  float velocity;
+
+  float integral;
+  float error;
+  uint8_t started;
+
+  /* least delay of the phone's clock stamps in this window and the last, ms */
+  uint8_t synced;
+  uint64_t window;
+  uint16_t least;
+  uint16_t offset;
+} loop;
+
+static sl_sleeptimer_timer_handle_t loop_timer;
+
+static void timeout(void);
+static void telemetry(void);
+static void feed(void);
+static void control(void);
+
+/* a stop has to happen, status can wait for a connection event or two */
+static sched_task timeout_task = SCHED_TASK(timeout, 0, 0, SCHED_MS(5));
+static sched_task telemetry_task = SCHED_TASK(telemetry, 1, SCHED_MS(MOTION_TELEMETRY_MS), SCHED_MS(20));
+/* posted by the stepper, a segment lasts PL_SEGMENT_SLICES slices (31 ms) at least when the motor runs fast */
+static sched_task feed_task = SCHED_TASK(feed, 0, 0, SCHED_MS(5));
+/* posted by the loop timer, a late run acts on an older sample */
+static sched_task control_task = SCHED_TASK(control, 0, 0, SCHED_MS(5));
+
+static void put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+/* status value is kept in the database for reads and notified when enabled */
+static void publish(void)
+{
+  uint8_t status[MOTION_STATUS_SIZE];
+  status[0] = state.mode;
+  status[1] = state.seq;
+  put16(status + 2, (uint16_t)state.value);
+  put16(status + 4, state.accepted);
+  put16(status + 6, state.rejected);
+  changed = 0;
+  gecko_cmd_gatt_server_write_attribute_value(gattdb_motion_status, 0, sizeof(status), status);
+  if (notify && connection_handle != 0xff) {
+    gecko_cmd_gatt_server_send_characteristic_notification(connection_handle, gattdb_motion_status,
+                                                           sizeof(status), status);
+  }
+}
+
+/* GP_VELOCITY units to planner velocity */
+static int32_t velocity_steps(int32_t value)
+{
+  return (int32_t)((int64_t)value * MOTION_FRAME_DEGREES * MOTION_STEPS_PER_TURN * 65536
+                   / (360 * 1000 * PL_SLICE_HZ));
+}
+
+/* GP_POSITION units to planner position, 0 is where the motor was at boot */
+static int64_t position_steps(int32_t value)
+{
+  return (int64_t)value * MOTION_STEPS_PER_TURN * 65536 / 36000;
+}
+
+/* loop timer interrupt: the motor's position now, the control task acts on it */
+static void sample(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  uint8_t next = (uint8_t)((loop.head + 1) % HISTORY);
+  (void)handle;
+  (void)data;
+  loop.tick[next] = sched_now();
+  loop.position[next] = stepper_played();
+  loop.head = next;
+  if (loop.samples < HISTORY - 1) {
+    loop.samples++;
+  }
+  if (state.mode == GP_TRACK) {
+    sched_post(&control_task);
+  }
+}
+
+/* motor position at a past tick, between two samples on a line */
+static float position_at(uint64_t tick)
+{
+  uint8_t i = loop.head, samples = loop.samples, older, n;
+  if (samples == 0) {
+    return (float)stepper_played();
+  }
+  if (tick >= loop.tick[i]) {
+    return (float)loop.position[i];
+  }
+  for (n = 1; n < samples; n++) {
+    older = (uint8_t)((i + HISTORY - 1) % HISTORY);
+    if (loop.tick[older] <= tick) {
+      return loop.position[older] + (float)(loop.position[i] - loop.position[older])
+             * (float)(tick - loop.tick[older]) / (float)(loop.tick[i] - loop.tick[older]);
+    }
+    i = older;
+  }
+  return (float)loop.position[i];
+}
+
+/* a GP_TRACK frame: where the target was when the phone took its picture */
+static void measure(const gp_command *cmd)
+{
+  uint64_t now = sched_now(), capture;
+  uint16_t delay = (uint16_t)((uint16_t)(now * 1000 / SCHED_TICKS_PER_S) - cmd->time_ms);
+  int16_t excess;
+  float at;
+
+  if (!loop.synced) {
+    loop.synced = 1;
+    loop.least = delay;
+    loop.offset = delay;
+    loop.window = now;
+  } else if (now - loop.window >= WINDOW_TICKS) {
+    loop.offset = loop.least;
+    loop.least = delay;
+    loop.window = now;
+  }
+  /* stamps wrap, the delays are compared as differences */
+  if ((int16_t)(delay - loop.least) < 0) {
+    loop.least = delay;
+  }
+  if ((int16_t)(delay - loop.offset) < 0) {
+    loop.offset = delay;
+  }
+  excess = (int16_t)(delay - loop.offset);
+  if (excess > MAX_EXCESS_MS) {
+    excess = MAX_EXCESS_MS;
+  }
+
+  capture = now - SCHED_MS(gains.latency_ms + excess);
+  at = position_at(capture);
+  loop.target = at + cmd->value * FRAME_STEPS;
+  loop.velocity = cmd->velocity * FRAME_STEPS
+                  + (at - position_at(capture - VELOCITY_TICKS)) * SCHED_TICKS_PER_S / VELOCITY_TICKS;
+  loop.capture = capture;
+  loop.valid = 1;
+}
+
+/* PID on the predicted error plus the target's velocity, the planner ramps to the result */
+static void control(void)
+{
+  const float dt = (float)LOOP_TICKS / SCHED_TICKS_PER_S;
+  uint8_t head = loop.head;
+  float limit = config.max_velocity * FRAME_STEPS, ahead, error, derivative, correction, brake, command;
+  uint64_t since;
+
+  if (state.mode != GP_TRACK || !loop.valid || loop.samples == 0) {
+    return;
+  }
+  since = loop.tick[head] > loop.capture ? loop.tick[head] - loop.capture : 0;
+  ahead = (float)(since < PREDICT_TICKS ? since : PREDICT_TICKS) / SCHED_TICKS_PER_S;
+  error = loop.target + loop.velocity * ahead - loop.position[head];
+  derivative = loop.started ? (error - loop.error) / dt : 0;
+  loop.error = error;
+  loop.started = 1;
+
+  correction = gains.kp * error / 1000;
+  brake = sqrtf(2.0f * BRAKE_ACCEL * fabsf(error));
+  if (correction > brake) {
+    correction = brake;
+  } else if (correction < -brake) {
+    correction = -brake;
+  }
+  command = (gains.kff * loop.velocity + gains.ki * loop.integral + gains.kd * derivative) / 1000 + correction;
+  /* no integration while saturated, unless the error unwinds it */
+  if ((command < limit || error < 0) && (command > -limit || error > 0)) {
+    loop.integral += error * dt;
+  }
+  if (command > limit) {
+    command = limit;
+  } else if (command < -limit) {
+    command = -limit;
+  }
+  if (command < MIN_VELOCITY && command > -MIN_VELOCITY) {
+    command = fabsf(error) < SETTLED ? 0 : (error > 0 ? MIN_VELOCITY : -MIN_VELOCITY);
+  }
+  pl_velocity(&pl, (int32_t)(command * 65536 / PL_SLICE_HZ));
+  sched_post(&feed_task);
+}
+
+/* a new tracking session, nothing measured yet */
+static void track(void)
+{
+  loop.valid = 0;
+  loop.started = 0;
+  loop.integral = 0;
+}
+
+/* queues segments while the stepper has room for them, a segment it did not take (reversal, or the
+   running one too close to its end) is queued again when the stepper posts the task after its segment */
+static void feed(void)
+{
+  for (;;) {
+    int direction;
+    if (pending) {
+      int result = stepper_queue(segments[filling], pending, pending_direction);
+      /* tracking can not wait for the queued steps to play out before it turns back, the motor stops
+         where it is (a few steps per second are left by then) and the profile starts from rest there */
+      if (result == STEPPER_DIRECTION && state.mode == GP_TRACK) {
+        stepper_stop();
+        pl_hold(&pl, stepper_position());
+        pending = 0;
+        continue;
+      }
+      if (result != STEPPER_OK) {
+        return;
+      }
+      pending = 0;
+      filling ^= 1;
+    }
+    if (stepper_free() == 0 || pl_idle(&pl)) {
+      break;
+    }
+    if (!stepper_busy()) {
+      pl_restart(&pl);
+    }
+    /* the stepper takes the next segment while two intervals of the running one are left to load and
+       the first two of a move are loaded at its start, a segment may start a move after a reversal */
+    pending = pl_fill(&pl, segments[filling], MOTION_SEGMENT, 4, &direction);
+    pending_direction = direction;
+    st_timer_top(segments[filling], pending);
+  }
+  if (connection_handle == 0xff && !stepper_busy() && pl_idle(&pl)) {
+    stepper_enable(0);
+  }
+}
+
+/* new target for the planner, the motion changes with the next segment, GP_TRACK sets it every loop period */
+static void plan(void)
+{
+  if (state.mode == GP_TRACK) {
+    return;
+  }
+  if (state.mode == GP_POSITION) {
+    pl_position(&pl, position_steps(state.value));
+  } else {
+    pl_velocity(&pl, state.mode == GP_VELOCITY ? velocity_steps(state.value) : 0);
+  }
+  sched_post(&feed_task);
+}
+
+/* decelerates with the planner's limits, a stop right away would lose steps */
+static void stop(void)
+{
+  state.mode = GP_STOP;
+  state.value = 0;
+  sched_stop(&timeout_task);
+  plan();
+}
+
+static void timeout(void)
+{
+  printLog("setpoint timeout, stopping\r\n");
+  stop();
+  publish();
+}
+
+static void telemetry(void)
+{
+  if (changed) {
+    publish();
+  }
+}
+
+static void put_gains(uint8_t *p, const motion_gains *g)
+{
+  put16(p, g->kp);
+  put16(p + 2, g->ki);
+  put16(p + 4, g->kd);
+  put16(p + 6, g->kff);
+  put16(p + 8, g->latency_ms);
+}
+
+/* 0 - out of range, the history does not reach back further than MAX_LATENCY_MS */
+static int get_gains(const uint8_t *p, motion_gains *g)
+{
+  g->kp = get16(p);
+  g->ki = get16(p + 2);
+  g->kd = get16(p + 4);
+  g->kff = get16(p + 6);
+  g->latency_ms = get16(p + 8);
+  return g->kp != 0 && g->kff <= 2000 && g->latency_ms <= MAX_LATENCY_MS;
+}
+
+void motion_init(void)
+{
+  uint8_t stored[MOTION_GAINS_SIZE];
+  config = defaults;
+  if (nvm3_readData(nvm3_defaultHandle, MOTION_GAINS_KEY, stored, sizeof(stored)) != ECODE_NVM3_OK
+      || !get_gains(stored, &gains)) {
+    gains = gain_defaults;
+  }
+  state = (motion_state){ 0 };
+  loop.samples = 0;
+  gp_receiver_init(&receiver);
+  pl_init(&pl, velocity_steps(config.max_velocity), PL_ACCEL(MOTION_ACCEL), PL_JERK(MOTION_JERK),
+          STEPPER_TICK_HZ, STEPPER_MIN_INTERVAL);
+  sched_add(&timeout_task);
+  sched_add(&telemetry_task);
+  sched_add(&feed_task);
+  sched_add(&control_task);
+  stepper_init(&feed_task);
+}
+
+const motion_state *motion_current(void)
+{
+  return &state;
+}
+
+const motion_config *motion_get_config(void)
+{
+  return &config;
+}
+
+const motion_gains *motion_get_gains(void)
+{
+  return &gains;
+}
+
+void motion_connection_opened(uint8_t connection)
+{
+  connection_handle = connection;
+  notify = 0;
+  /* every phone session numbers its frames from 0 */
+  gp_receiver_init(&receiver);
+  loop.synced = 0;
+  sched_start(&telemetry_task, telemetry_task.period);
+  sl_sleeptimer_start_periodic_timer(&loop_timer, LOOP_TICKS, sample, NULL, 0, 0);
+  stepper_enable(1);
+}
+
+void motion_connection_closed(void)
+{
+  connection_handle = 0xff;
+  notify = 0;
+  stop();
+  sched_stop(&telemetry_task);
+  sl_sleeptimer_stop_timer(&loop_timer);
+  loop.samples = 0;
+  /* the motor is disabled by the feed once it stopped */
+}
+
+void motion_setpoint_written(const uint8_t *data, uint8_t len)
+{
+  gp_command cmd;
+  if (gp_receive(&receiver, data, len, &cmd) != GP_OK) {
+    state.rejected++;
+    changed = 1;
+    return;
+  }
+  if (cmd.type == GP_VELOCITY) {
+    if (cmd.value > config.max_velocity) {
+      cmd.value = config.max_velocity;
+    } else if (cmd.value < -config.max_velocity) {
+      cmd.value = (int16_t)-config.max_velocity;
+    }
+  }
+  if ((config.flags & MOTION_INVERT) && cmd.type != GP_STOP) {
+    cmd.value = (int16_t)-cmd.value;
+    cmd.velocity = (int16_t)-cmd.velocity;
+  }
+  if (cmd.type == GP_TRACK) {
+    if (state.mode != GP_TRACK) {
+      track();
+    }
+    measure(&cmd);
+  }
+  state.mode = cmd.type;
+  state.seq = cmd.seq;
+  state.value = cmd.type == GP_STOP ? 0 : cmd.value;
+  state.accepted++;
+  changed = 1;
+  plan();
+  if (cmd.type == GP_STOP || config.timeout_ms == 0) {
+    sched_stop(&timeout_task);
+  } else {
+    sched_start(&timeout_task, SCHED_MS(config.timeout_ms));
+  }
+  if (cmd.type == GP_STOP) {
+    publish();
+  }
+}
+
+void motion_config_read(uint8_t connection)
+{
+  uint8_t value[MOTION_CONFIG_SIZE];
+  put16(value, (uint16_t)config.max_velocity);
+  put16(value + 2, config.timeout_ms);
+  put16(value + 4, config.flags);
+  gecko_cmd_gatt_server_send_user_read_response(connection, gattdb_motion_config, bg_err_success,
+                                                sizeof(value), value);
+}
+
+void motion_config_written(uint8_t connection, const uint8_t *data, uint8_t len)
+{
+  motion_config next;
+  uint8_t result = bg_err_success;
+  if (len != MOTION_CONFIG_SIZE) {
+    result = (uint8_t)bg_err_att_invalid_att_length;
+  } else {
+    next.max_velocity = (int16_t)get16(data);
+    next.timeout_ms = get16(data + 2);
+    next.flags = get16(data + 4);
+    /* shorter timeouts would stop the gimbal between two connection events */
+    if (next.max_velocity <= 0 || (next.timeout_ms != 0 && next.timeout_ms < 100) || (next.flags & ~MOTION_INVERT)) {
+      result = (uint8_t)bg_err_att_value_not_allowed;
+    } else {
+      config = next;
+      pl_limits(&pl, velocity_steps(config.max_velocity), PL_ACCEL(MOTION_ACCEL), PL_JERK(MOTION_JERK));
+    }
+  }
+  gecko_cmd_gatt_server_send_user_write_response(connection, gattdb_motion_config, result);
+}
+
+void motion_status_config(uint8_t connection, uint16_t client_config_flags)
+{
+  connection_handle = connection;
+  notify = (client_config_flags & gatt_notification) != 0;
+  if (notify) {
+    publish();
+  }
+}
+
+void motion_gains_read(uint8_t connection)
+{
+  uint8_t value[MOTION_GAINS_SIZE];
+  put_gains(value, &gains);
+  gecko_cmd_gatt_server_send_user_read_response(connection, gattdb_motion_gains, bg_err_success,
+                                                sizeof(value), value);
+}
+
+void motion_gains_written(uint8_t connection, const uint8_t *data, uint8_t len)
+{
+  motion_gains next;
+  uint8_t result = bg_err_success;
+  if (len != MOTION_GAINS_SIZE) {
+    result = (uint8_t)bg_err_att_invalid_att_length;
+  } else if (!get_gains(data, &next)) {
+    result = (uint8_t)bg_err_att_value_not_allowed;
+  } else if (nvm3_writeData(nvm3_defaultHandle, MOTION_GAINS_KEY, data, len) != ECODE_NVM3_OK) {
+    printLog("gains not stored\r\n");
+    result = (uint8_t)bg_err_att_insufficient_resources;
+  } else {
+    gains = next;
+  }
+  gecko_cmd_gatt_server_send_user_write_response(connection, gattdb_motion_gains, result);
+}
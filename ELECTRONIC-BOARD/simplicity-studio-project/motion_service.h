@@ -0,0 +1,109 @@
+/*
+ *  motion_service.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Gimbal Motion GATT service (gatt.xml): binary setpoints, status notifications, configuration
+ *  setpoints are targets of the S-curve planner (planner.h), a feed task hands its step intervals to the
+ *  stepper driver (stepper.h) one segment at a time, two segments ahead at most
+ *  GP_TRACK frames are measurements, not targets: the board closes the loop itself, a periodic sleeptimer
+ *  samples the motor MOTION_LOOP_HZ times a second and a PID with velocity feed-forward sets the planner's
+ *  velocity from where the target should be by then (the phone's measurement is latency old)
+ *
+ *  status is published every MOTION_TELEMETRY_MS while connected if it changed, a stop right away
+ *  status (little endian, MOTION_STATUS_SIZE bytes):
+ *  0     mode, GP_STOP / GP_VELOCITY / GP_POSITION / GP_TRACK
+ *  1     sequence number of the active setpoint
+ *  2..3  value of the active setpoint, int16
+ *  4..5  accepted frames (wraps)
+ *  6..7  rejected frames (wraps)
+ *
+ *  config (little endian, MOTION_CONFIG_SIZE bytes):
+ *  0..1  velocity limit in GP_VELOCITY units, velocity setpoints are clamped to it
+ *  2..3  setpoint timeout in ms, the gimbal stops when no frame came for this long, 0 - off
+ *  4..5  flags, MOTION_INVERT
+ *
+ *  gains (little endian, MOTION_GAINS_SIZE bytes), kept in NVM3 and loaded at boot:
+ *  0..1  kp in 1/1000 steps/s per step of error
+ *  2..3  ki in 1/1000 steps/s per step second of error
+ *  4..5  kd in 1/1000 steps/s per step/s of error change
+ *  6..7  feed-forward of the target's velocity in 1/1000
+ *  8..9  latency in ms from the camera frame to the phone's write, when the write is delivered at once
+ */
+
+#ifndef MOTION_SERVICE_H_
+#define MOTION_SERVICE_H_
+
+#include <stdint.h>
+
+#include "gimbal_protocol.h"
+
+#define MOTION_STATUS_SIZE 8
+#define MOTION_CONFIG_SIZE 6
+#define MOTION_GAINS_SIZE 10
+
+/* NVM3 object of the gains, the Bluetooth stack keeps its own from 0x40000 */
+#define MOTION_GAINS_KEY 0x00100
+
+/* GP_TRACK control loop rate, the phone measures 30 times a second */
+#define MOTION_LOOP_HZ 100
+
+/* status notifications are merged into one per period, a setpoint comes every connection interval */
+#define MOTION_TELEMETRY_MS 100
+
+/* 200 step motor at 16 microsteps turning the camera directly, GP_VELOCITY frame widths are its field of view */
+#define MOTION_STEPS_PER_TURN 3200
+#define MOTION_FRAME_DEGREES 60
+/* steps/s^2 and steps/s^3, full acceleration after 0.1 s */
+#define MOTION_ACCEL 2000
+#define MOTION_JERK 20000
+/* intervals per segment, a segment also ends after PL_SEGMENT_SLICES slices */
+#define MOTION_SEGMENT 128
+
+/* motor mounted the other way round, positive setpoints turn left */
+#define MOTION_INVERT 0x0001
+
+typedef struct {
+  int16_t max_velocity;
+  uint16_t timeout_ms;
+  uint16_t flags;
+} motion_config;
+
+typedef struct {
+  uint16_t kp;
+  uint16_t ki;
+  uint16_t kd;
+  uint16_t kff;
+  uint16_t latency_ms;
+} motion_gains;
+
+/* active setpoint, value already clamped and inverted */
+typedef struct {
+  uint8_t mode;
+  uint8_t seq;
+  int16_t value;
+  uint16_t accepted;
+  uint16_t rejected;
+} motion_state;
+
+/* adds the timeout, telemetry, feed and control tasks, sets up the stepper and loads the gains,
+   after sched_init and gecko_init (NVM3) */
+void motion_init(void);
+const motion_state *motion_current(void);
+const motion_config *motion_get_config(void);
+const motion_gains *motion_get_gains(void);
+
+/* handlers of the stack events in appMain */
+void motion_connection_opened(uint8_t connection);
+void motion_connection_closed(void);
+/* setpoint frame written without response, applied before returning */
+void motion_setpoint_written(const uint8_t *data, uint8_t len);
+void motion_config_read(uint8_t connection);
+void motion_config_written(uint8_t connection, const uint8_t *data, uint8_t len);
+void motion_status_config(uint8_t connection, uint16_t client_config_flags);
+/* written gains are stored before they are answered, a failed store keeps the old ones */
+void motion_gains_read(uint8_t connection);
+void motion_gains_written(uint8_t connection, const uint8_t *data, uint8_t len);
+
+#endif
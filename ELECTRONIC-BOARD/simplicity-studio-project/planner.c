@@ -0,0 +1,244 @@
+/*
+ *  planner.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Every slice the acceleration goes up by the jerk, stays or goes down, whichever is the strongest
+ *  that can still settle on the target velocity by ramping the acceleration back to 0.
+ *  Towards a position target the same choice is checked against the distance of the quickest stop
+ *  after the slice, so the move brakes as late as it can and does not overshoot
+ */
+
+#include "planner.h"
+#include "step_table.h"
+
+static int32_t clamp(int32_t value, int32_t limit)
+{
+  return value > limit ? limit : value < -limit ? -limit : value;
+}
+
+/* velocity change while the acceleration accel * jerk ramps down to 0 */
+static int64_t settle(int32_t accel, int32_t jerk)
+{
+  int64_t change = (int64_t)accel * accel * (jerk / 2);
+  return accel < 0 ? -change : change;
+}
+
+/* next acceleration (in jerks) towards the target velocity, without passing it */
+static int32_t choose(const planner *pl, int32_t target)
+{
+  int32_t accel = pl->accel, next;
+  int s, k;
+  if (target == pl->velocity) {
+    return accel > 0 ? accel - 1 : accel < 0 ? accel + 1 : 0;
+  }
+  s = target > pl->velocity ? 1 : -1;
+  for (k = 1; k >= -1; k--) {
+    int64_t after;
+    next = accel + s * k;
+    if (next > pl->ramp || next < -pl->ramp) {
+      continue;
+    }
+    after = pl->velocity + (int64_t)(accel + next) * (pl->jerk / 2) + settle(next, pl->jerk);
+    if ((target - after) * s >= 0) {
+      return next;
+    }
+  }
+  return clamp(accel - s, pl->ramp);
+}
+
+/* 6 x the distance of a stop from velocity v > 0 and acceleration accel * jerk: the acceleration goes
+   down to -k jerks, stays there as long as the velocity left needs and comes back to 0 */
+static int64_t braking6(const planner *pl, int64_t v, int32_t accel)
+{
+  int64_t j = pl->jerk, need = v + j * accel * accel / 2, k, hold, t, a, d6;
+  int32_t least = accel < 0 ? -accel : 0;
+  if (need <= 0) {
+    return 0;
+  }
+  k = st_isqrt64((uint64_t)(need / j));
+  k = k < least ? least : k > pl->ramp ? pl->ramp : k;
+  if (k == 0) {
+    k = 1;
+  }
+  /* velocity shed while holding -k, the hold lasts hold / (j k) slices */
+  hold = need > j * k * k ? need - j * k * k : 0;
+  t = accel + k;
+  a = (int64_t)accel * j;
+  d6 = 6 * v * t + 3 * a * t * t - j * t * t * t;
+  v += a * t - j * t * t / 2;
+  d6 += (6 * v * hold - 3 * hold * hold) / (j * k);
+  v -= hold;
+  d6 += 6 * v * k - 2 * j * k * k * k;
+  /* slices are whole, the hold ends up to one slice late at the speed of the last ramp */
+  return d6 + 3 * j * k * k;
+}
+
+/* next acceleration towards the target position: the strongest that can still stop at it without
+   turning back, when none can the hardest braking that does not turn back */
+static int32_t approach(const planner *pl)
+{
+  int64_t distance = pl->target - pl->position;
+  int s = distance > 0 || (distance == 0 && pl->velocity < 0) ? 1 : -1, k;
+  int64_t v = s * (int64_t)pl->velocity, j = pl->jerk;
+  int32_t accel = s * pl->accel, next, fallback = accel - 1 < -pl->ramp ? -pl->ramp : accel - 1;
+  distance *= s;
+  for (k = 1; k >= -1; k--) {
+    int64_t after, settled, advance6;
+    next = accel + k;
+    if (next > pl->ramp || next < -pl->ramp) {
+      continue;
+    }
+    after = v + (accel + next) * (j / 2);
+    settled = after + settle(next, pl->jerk);
+    if (settled > pl->v_max || (settled < 0 && v >= 0)) {
+      continue;
+    }
+    advance6 = 6 * v + 3 * accel * j + (next - accel) * j;
+    if (after <= 0 || advance6 + braking6(pl, after, next) <= 6 * distance) {
+      return s * next;
+    }
+    fallback = next;
+  }
+  return s * fallback;
+}
+
+void pl_init(planner *pl, int32_t v_max, int32_t a_max, int32_t jerk, uint32_t tick_hz, uint32_t min_interval)
+{
+  *pl = (planner){ 0 };
+  pl->tick_hz = tick_hz;
+  pl->min_interval = min_interval;
+  pl->slice_ticks = tick_hz / PL_SLICE_HZ;
+  pl->mode = PL_VELOCITY_MODE;
+  pl_limits(pl, v_max, a_max, jerk);
+}
+
+void pl_limits(planner *pl, int32_t v_max, int32_t a_max, int32_t jerk)
+{
+  /* a step every min_interval at most */
+  int64_t fastest = (int64_t)pl->tick_hz * 65536 / PL_SLICE_HZ / pl->min_interval;
+  pl->v_max = v_max > fastest ? (int32_t)fastest : v_max;
+  pl->jerk = jerk < 2 ? 2 : jerk & ~1;
+  pl->ramp = a_max / pl->jerk < 1 ? 1 : a_max / pl->jerk;
+  pl->v_target = clamp(pl->v_target, pl->v_max);
+}
+
+void pl_velocity(planner *pl, int32_t velocity)
+{
+  pl->mode = PL_VELOCITY_MODE;
+  pl->v_target = clamp(velocity, pl->v_max);
+}
+
+void pl_position(planner *pl, int64_t position)
+{
+  pl->mode = PL_POSITION_MODE;
+  pl->target = position;
+}
+
+int pl_idle(const planner *pl)
+{
+  if (pl->velocity != 0 || pl->accel != 0) {
+    return 0;
+  }
+  return pl->mode == PL_VELOCITY_MODE ? pl->v_target == 0 : pl->position == pl->target;
+}
+
+void pl_restart(planner *pl)
+{
+  pl->last_tick = pl->slice_end;
+}
+
+void pl_hold(planner *pl, int64_t step)
+{
+  pl->step = step;
+  pl->position = step * 65536 + 32768;
+  pl->position_from = pl->position;
+  pl->velocity = 0;
+  pl->accel = 0;
+}
+
+void pl_slice(planner *pl)
+{
+  int32_t target = pl->v_target;
+  int32_t next = pl->mode == PL_POSITION_MODE ? approach(pl) : choose(pl, target);
+  int32_t from = pl->accel * pl->jerk, to = next * pl->jerk;
+
+  pl->position_from = pl->position;
+  pl->slice_end += pl->slice_ticks;
+  /* constant jerk over the slice, from and to are even */
+  pl->position += pl->velocity + from / 2 + (to - from) / 6;
+  pl->velocity += (from + to) / 2;
+  pl->accel = next;
+  pl->slices++;
+
+  /* the last bit of velocity is below one jerk slice, a step of less than a jerk */
+  if (pl->mode == PL_VELOCITY_MODE && pl->accel == 0 && target - pl->velocity < pl->jerk && pl->velocity - target < pl->jerk) {
+    pl->velocity = target;
+  }
+  /* within 1/16 step at crawling speed the target is taken, braking any further would hunt around it,
+     at rest closer than the shortest move (one jerk up and down) it is taken too */
+  if (pl->mode == PL_POSITION_MODE
+      && ((pl->target - pl->position < 4096 && pl->position - pl->target < 4096
+           && pl->velocity <= pl->ramp * pl->jerk && -pl->velocity <= pl->ramp * pl->jerk)
+          || (pl->velocity == 0 && pl->accel == 0
+              && pl->target - pl->position < 65536 && pl->position - pl->target < 65536))) {
+    pl->position = pl->target;
+    pl->velocity = 0;
+    pl->accel = 0;
+  }
+}
+
+/* next whole step crossed in the current slice, its direction and time, 0 - none left */
+static int crossing(const planner *pl, uint64_t *tick)
+{
+  int64_t from = pl->position_from, to = pl->position, edge;
+  uint64_t start = pl->slice_end - pl->slice_ticks;
+  if (to > from) {
+    edge = (pl->step + 1) * 65536;
+    if (edge > to) {
+      return 0;
+    }
+    *tick = start + (uint64_t)(((edge - from) * pl->slice_ticks + (to - from) / 2) / (to - from));
+    return 1;
+  }
+  if (to < from) {
+    edge = pl->step * 65536;
+    if (edge <= to) {
+      return 0;
+    }
+    *tick = start + (uint64_t)(((from - edge) * pl->slice_ticks + (from - to) / 2) / (from - to));
+    return -1;
+  }
+  return 0;
+}
+
+uint32_t pl_fill(planner *pl, uint32_t *intervals, uint32_t size, uint32_t min_steps, int *direction)
+{
+  uint32_t count = 0, slices = 0;
+  int heading = 0;
+  while (count < size) {
+    uint64_t tick;
+    int next = crossing(pl, &tick);
+    if (next) {
+      if (heading && next != heading) {
+        break;
+      }
+      heading = next;
+      pl->step += next;
+      if (tick < pl->last_tick + pl->min_interval) {
+        tick = pl->last_tick + pl->min_interval;
+      }
+      intervals[count++] = (uint32_t)(tick - pl->last_tick);
+      pl->last_tick = tick;
+      continue;
+    }
+    if (pl_idle(pl) || (slices >= PL_SEGMENT_SLICES && count >= min_steps)) {
+      break;
+    }
+    pl_slice(pl);
+    slices++;
+  }
+  *direction = heading < 0 ? -1 : 1;
+  return count;
+}
@@ -0,0 +1,87 @@
+/*
+ *  planner.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Jerk limited (S-curve) motion planner in Q16.16 fixed point, turns a target velocity or position
+ *  into step intervals for the stepper driver (stepper.h) a segment at a time
+ *
+ *  the profile advances in slices of 1/PL_SLICE_HZ s, acceleration changes by at most the jerk per
+ *  slice, velocity and position follow exactly; steps are where the position crosses whole steps,
+ *  interpolated linearly inside a slice (error a/8 steps, below 0.01 step for the gimbal's limits)
+ *  units are steps per slice: velocity Q16.16 steps/slice, acceleration steps/slice^2, jerk steps/slice^3,
+ *  PL_VELOCITY & co. convert from steps per second
+ *  integer only, the board and the host (simulation/plansim.c) compute the same intervals bit for bit
+ */
+
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+#include <stdint.h>
+
+#define PL_SLICE_HZ 256
+/* a segment ends after this many slices when it has steps, a new setpoint is in the stream that soon */
+#define PL_SEGMENT_SLICES 8
+
+#define PL_VELOCITY(steps_per_s) ((int32_t)((int64_t)(steps_per_s) * 65536 / PL_SLICE_HZ))
+#define PL_ACCEL(steps_per_s2) ((int32_t)((int64_t)(steps_per_s2) * 65536 / PL_SLICE_HZ / PL_SLICE_HZ))
+#define PL_JERK(steps_per_s3) ((int32_t)((int64_t)(steps_per_s3) * 65536 / PL_SLICE_HZ / PL_SLICE_HZ / PL_SLICE_HZ))
+#define PL_POSITION(steps) ((int64_t)(steps) * 65536)
+
+enum {
+  PL_VELOCITY_MODE = 0,
+  PL_POSITION_MODE
+};
+
+typedef struct {
+  /* limits: jerk even, acceleration a whole number of jerk slices */
+  int32_t v_max;
+  int32_t jerk;
+  int32_t ramp;             /* slices from 0 to the acceleration limit */
+  uint32_t tick_hz;         /* timer clock of the intervals */
+  uint32_t min_interval;
+
+  uint8_t mode;
+  int32_t v_target;
+  int64_t target;
+
+  /* profile at the end of the current slice, acceleration is accel * jerk */
+  int64_t position;
+  int32_t velocity;
+  int32_t accel;
+
+  /* current slice, its steps are emitted from position_from to position */
+  int64_t position_from;
+  uint64_t slice_end;
+  uint32_t slice_ticks;
+  int64_t step;             /* whole steps the motor is at, floor of the emitted position */
+  uint64_t last_tick;       /* time of the last step */
+  uint32_t slices;
+} planner;
+
+/* limits in Q16.16 per slice units, v_max at most PL_VELOCITY(40000) */
+void pl_init(planner *pl, int32_t v_max, int32_t a_max, int32_t jerk, uint32_t tick_hz, uint32_t min_interval);
+/* new limits, the motion goes on from where it is */
+void pl_limits(planner *pl, int32_t v_max, int32_t a_max, int32_t jerk);
+
+/* target velocity, clamped to v_max */
+void pl_velocity(planner *pl, int32_t velocity);
+/* target position, reached and held with velocity 0 */
+void pl_position(planner *pl, int64_t position);
+
+/* no motion left: at rest and at the target */
+int pl_idle(const planner *pl);
+/* the motor starts from rest now, the first interval counts from the current slice */
+void pl_restart(planner *pl);
+/* the motor was stopped at step, the profile goes on from rest half a step past it */
+void pl_hold(planner *pl, int64_t step);
+
+/* one slice of the profile, pl_fill runs these as it needs steps */
+void pl_slice(planner *pl);
+
+/* up to size step intervals of one direction (+1 / -1 in direction), returns how many,
+   stops early at a reversal, when idle, or after PL_SEGMENT_SLICES slices with min_steps steps */
+uint32_t pl_fill(planner *pl, uint32_t *intervals, uint32_t size, uint32_t min_steps, int *direction);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *  planner_bench.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Scenarios are setpoints at fixed slices, the planner is filled in segments like motion_service does
+ */
+
+#include <stddef.h>
+
+#include "planner_bench.h"
+#include "stepper.h"
+
+#define SEGMENT 128
+#define MAX_SLICES (60 * PL_SLICE_HZ)
+
+enum { VELOCITY, POSITION, END };
+
+typedef struct {
+  uint32_t slice;
+  int kind;
+  int32_t value;            /* steps/s or steps */
+} setpoint;
+
+typedef struct {
+  const char *name;
+  uint32_t v_max, a_max, jerk;   /* steps/s, /s^2, /s^3 */
+  setpoint setpoints[10];
+} scenario;
+
+static const scenario scenarios[PB_SCENARIOS] = {
+  { "pan and reverse", 1067, 2000, 20000,
+    { { 0, VELOCITY, 1067 }, { 512, VELOCITY, -800 }, { 1024, VELOCITY, 0 }, { 1280, END, 0 } } },
+  { "frame to frame", 1067, 2000, 20000,
+    { { 0, POSITION, 800 }, { 768, POSITION, -3200 }, { 2304, POSITION, -3190 }, { 2560, END, 0 } } },
+  { "fast move", 40000, 50000, 1000000,
+    { { 0, POSITION, 20000 }, { 512, POSITION, 0 }, { 1024, END, 0 } } },
+  { "tracking", 1067, 2000, 20000,
+    { { 0, VELOCITY, 300 }, { 26, VELOCITY, 420 }, { 51, VELOCITY, 390 }, { 77, VELOCITY, -150 },
+      { 102, VELOCITY, -600 }, { 128, POSITION, 0 }, { 640, VELOCITY, 5 }, { 1024, VELOCITY, 0 }, { 1152, END, 0 } } },
+};
+
+/* recorded with simulation/plansim */
+const uint32_t pb_expected[PB_SCENARIOS] = { 0xe48ecaa6, 0x89f26859, 0x31b146ed, 0x84155b6d };
+
+static uint32_t fnv(uint32_t hash, uint32_t value)
+{
+  int i;
+  for (i = 0; i < 4; i++) {
+    hash = (hash ^ (value & 0xff)) * 16777619u;
+    value >>= 8;
+  }
+  return hash;
+}
+
+void pb_run(int scenario_index, pb_cycles_fn cycles, pb_observe_fn observe, pb_result *result)
+{
+  static uint32_t intervals[SEGMENT];
+  const scenario *s = &scenarios[scenario_index];
+  const setpoint *next = s->setpoints;
+  planner pl;
+  uint32_t i;
+
+  pl_init(&pl, PL_VELOCITY(s->v_max), PL_ACCEL(s->a_max), PL_JERK(s->jerk), STEPPER_TICK_HZ, STEPPER_MIN_INTERVAL);
+  *result = (pb_result){ s->name, 0, 0, 0, 0, 2166136261u, 0, 0 };
+
+  while (pl.slices < MAX_SLICES) {
+    uint32_t count, start = 0;
+    int direction;
+    while (next->kind != END && next->slice <= pl.slices) {
+      if (next->kind == VELOCITY) {
+        pl_velocity(&pl, PL_VELOCITY(next->value));
+      } else {
+        pl_position(&pl, PL_POSITION(next->value));
+      }
+      next++;
+    }
+    if (next->kind == END && pl_idle(&pl)) {
+      break;
+    }
+    if (cycles) {
+      start = cycles();
+    }
+    count = pl_fill(&pl, intervals, SEGMENT, 1, &direction);
+    if (cycles) {
+      uint32_t spent = cycles() - start;
+      result->cycles += spent;
+      if (spent > result->cycles_max) {
+        result->cycles_max = spent;
+      }
+    }
+    if (observe) {
+      observe(&pl, intervals, count, direction);
+    }
+    result->fills++;
+    result->steps += count;
+    for (i = 0; i < count; i++) {
+      result->hash = fnv(result->hash, intervals[i] * (uint32_t)direction);
+    }
+    /* idle until the next setpoint */
+    if (pl_idle(&pl) && next->kind != END) {
+      pl.slices = next->slice;
+      pl_restart(&pl);
+    }
+  }
+  result->position = (int32_t)pl.step;
+  result->slices = pl.slices;
+}
@@ -0,0 +1,41 @@
+/*
+ *  planner_bench.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Fixed planner scenarios for cycle counts on the board (PLANNER_BENCHMARK in app.h) and the
+ *  host check (simulation/plansim.c): both hash the intervals they produce and compare the hash with
+ *  pb_expected, recorded on the host, so a board build that rounds differently shows up
+ */
+
+#ifndef PLANNER_BENCH_H_
+#define PLANNER_BENCH_H_
+
+#include <stdint.h>
+
+#include "planner.h"
+
+#define PB_SCENARIOS 4
+
+typedef struct {
+  const char *name;
+  uint32_t steps;
+  int32_t position;         /* whole steps at the end */
+  uint32_t slices;
+  uint32_t fills;
+  uint32_t hash;            /* FNV-1a of the intervals and their directions */
+  uint32_t cycles;          /* spent in pl_fill, 0 without a counter */
+  uint32_t cycles_max;      /* worst pl_fill */
+} pb_result;
+
+/* hashes of the scenarios as the host computes them */
+extern const uint32_t pb_expected[PB_SCENARIOS];
+
+/* cycles - free running counter or NULL, observe - every pl_fill result or NULL */
+typedef uint32_t (*pb_cycles_fn)(void);
+typedef void (*pb_observe_fn)(const planner *pl, const uint32_t *intervals, uint32_t count, int direction);
+
+void pb_run(int scenario, pb_cycles_fn cycles, pb_observe_fn observe, pb_result *result);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ *  scheduler.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  A handful of tasks, so a plain list is searched on every dispatch, no heap and no preemption
+ */
+
+#include "native_gecko.h"
+#include "sl_sleeptimer.h"
+
+#include "scheduler.h"
+
+static sched_task *tasks = NULL;
+static sl_sleeptimer_timer_handle_t wakeup;
+
+/* sleeptimer interrupt, the stack leaves its sleep on an external signal */
+static void woken(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  gecko_external_signal(SCHED_SIGNAL);
+}
+
+void sched_init(void)
+{
+  tasks = NULL;
+  sl_sleeptimer_init();
+}
+
+void sched_add(sched_task *task)
+{
+  task->armed = 0;
+  task->posted = 0;
+  task->runs = 0;
+  task->misses = 0;
+  task->latency_max = 0;
+  task->next = tasks;
+  tasks = task;
+}
+
+void sched_start(sched_task *task, uint32_t delay)
+{
+  task->release = sched_now() + delay;
+  task->armed = 1;
+}
+
+void sched_stop(sched_task *task)
+{
+  task->armed = 0;
+  task->posted = 0;
+}
+
+void sched_post(sched_task *task)
+{
+  if (!task->posted) {
+    task->posted_at = sched_now();
+    task->posted = 1;
+  }
+  gecko_external_signal(SCHED_SIGNAL);
+}
+
+uint64_t sched_now(void)
+{
+  return sl_sleeptimer_get_tick_count64();
+}
+
+const sched_task *sched_tasks(void)
+{
+  return tasks;
+}
+
+int sched_dispatch(void)
+{
+  uint64_t now = sched_now(), release = 0, due = 0;
+  sched_task *task, *best = NULL;
+  uint32_t latency;
+
+  for (task = tasks; task; task = task->next) {
+    uint64_t r, d;
+    if (task->posted) {
+      r = task->posted_at;
+    } else if (task->armed && task->release <= now) {
+      r = task->release;
+    } else {
+      continue;
+    }
+    d = task->deadline ? r + task->deadline : UINT64_MAX;
+    if (!best || task->priority < best->priority || (task->priority == best->priority && d < due)) {
+      best = task;
+      release = r;
+      due = d;
+    }
+  }
+  if (!best) {
+    return 0;
+  }
+
+  if (best->posted) {
+    /* cleared first, a post from an interrupt during the run makes another one */
+    best->posted = 0;
+  } else if (best->period) {
+    /* releases that passed while the loop was busy are dropped and count as misses */
+    uint64_t late = (now - best->release) / best->period;
+    best->misses += (uint32_t)late;
+    best->release += (late + 1) * best->period;
+  } else {
+    best->armed = 0;
+  }
+
+  latency = now - release > UINT32_MAX ? UINT32_MAX : (uint32_t)(now - release);
+  if (latency > best->latency_max) {
+    best->latency_max = latency;
+  }
+  if (best->deadline && latency > best->deadline) {
+    best->misses++;
+  }
+  best->runs++;
+  best->run();
+  return 1;
+}
+
+void sched_sleep(void)
+{
+  uint64_t now = sched_now(), next = UINT64_MAX;
+  uint32_t ms = UINT32_MAX;
+  const sched_task *task;
+
+  for (task = tasks; task; task = task->next) {
+    if (task->posted) {
+      return;
+    }
+    if (task->armed && task->release < next) {
+      next = task->release;
+    }
+  }
+  if (next <= now) {
+    return;
+  }
+  sl_sleeptimer_stop_timer(&wakeup);
+  if (next != UINT64_MAX) {
+    uint64_t ticks = next - now;
+    if (ticks > INT32_MAX) {
+      ticks = INT32_MAX;
+    }
+    sl_sleeptimer_start_timer(&wakeup, (uint32_t)ticks, woken, NULL, 0, 0);
+    /* rounded up, the sleeptimer ends the sleep on the exact tick */
+    ms = (uint32_t)((ticks * 1000 + SCHED_TICKS_PER_S - 1) / SCHED_TICKS_PER_S);
+  }
+  gecko_sleep_for_ms(ms);
+}
@@ -0,0 +1,71 @@
+/*
+ *  scheduler.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Run-to-completion tasks in the Bluetooth event loop of appMain
+ *
+ *  appMain takes stack events with gecko_peek_event and runs one due task between two events,
+ *  the task with the lowest priority number goes first, the earlier deadline breaks ties.
+ *  When nothing is due the loop sleeps (EM2 unless sleep is disabled) until the next release,
+ *  a sleeptimer wakes it up through a stack external signal.
+ *  A task must return quickly, every task and event handler delays the others by its run time.
+ *
+ *  times are sleep clock ticks (32768 Hz), SCHED_MS converts
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+
+/* external signal bit that wakes the loop, system_external_signal events carrying it need no handling */
+#define SCHED_SIGNAL 0x80000000u
+
+#define SCHED_TICKS_PER_S 32768u
+#define SCHED_MS(ms) ((uint32_t)((uint64_t)(ms) * SCHED_TICKS_PER_S / 1000))
+
+typedef void (*sched_fn)(void);
+
+typedef struct sched_task {
+  const char *name;
+  sched_fn run;
+  uint8_t priority;         /* 0 runs first */
+  uint32_t period;          /* ticks between releases, 0 - runs once per sched_start */
+  uint32_t deadline;        /* ticks after the release the task has to start by, 0 - no deadline */
+
+  /* scheduler state */
+  uint64_t release;
+  uint8_t armed;
+  volatile uint8_t posted;
+  volatile uint64_t posted_at;
+  struct sched_task *next;
+
+  /* statistics, latency is from the release (or post) to the start of the run */
+  uint32_t runs;
+  uint32_t misses;
+  uint32_t latency_max;
+} sched_task;
+
+#define SCHED_TASK(fn, priority, period, deadline) { #fn, fn, priority, period, deadline, 0, 0, 0, 0, 0, 0, 0, 0 }
+
+void sched_init(void);
+/* once per task, before it is started */
+void sched_add(sched_task *task);
+/* first release delay ticks from now, a running task is moved */
+void sched_start(sched_task *task, uint32_t delay);
+void sched_stop(sched_task *task);
+/* makes the task due now, safe in interrupts, posts before the run are merged into one */
+void sched_post(sched_task *task);
+
+/* runs the most urgent due task, 0 when nothing was due */
+int sched_dispatch(void);
+/* sleeps until the next release, a post or a stack event */
+void sched_sleep(void);
+
+uint64_t sched_now(void);
+/* added tasks, for statistics */
+const sched_task *sched_tasks(void);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *  step_table.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Step n of a ramp is at t(n) = (sqrt(v0^2 + 2 a n) - v0) / a, cruise step n at n / v, intervals are
+ *  differences of rounded times so their sum never drifts from the exact move time
+ */
+
+#include "step_table.h"
+
+uint32_t st_isqrt64(uint64_t x)
+{
+  uint64_t root = 0, bit = (uint64_t)1 << 62;
+  while (bit > x) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+/* ticks from the start of the ramp to its step n, rounded */
+static uint64_t ramp_time(const st_profile *p, uint32_t n)
+{
+  uint64_t x = (uint64_t)p->start_rate * p->start_rate + 2 * (uint64_t)p->accel * n;
+  uint64_t root = st_isqrt64(x << 32); /* sqrt(x) in Q16 */
+  uint64_t num = (root - ((uint64_t)p->start_rate << 16)) * p->tick_hz;
+  uint64_t den = (uint64_t)p->accel << 16;
+  return (num + den / 2) / den;
+}
+
+static uint64_t cruise_time(const st_profile *p, uint32_t n)
+{
+  return ((uint64_t)n * p->tick_hz + p->max_rate / 2) / p->max_rate;
+}
+
+uint32_t st_ramp_steps(const st_profile *p)
+{
+  uint64_t top = (uint64_t)p->max_rate * p->max_rate, bottom = (uint64_t)p->start_rate * p->start_rate;
+  if (p->max_rate <= p->start_rate) {
+    return 0;
+  }
+  return (uint32_t)((top - bottom + 2 * (uint64_t)p->accel - 1) / (2 * (uint64_t)p->accel));
+}
+
+uint32_t st_trapezoid(const st_profile *p, uint32_t steps, uint32_t from, uint32_t *intervals, uint32_t size)
+{
+  uint32_t full, ramp, i;
+  if (p->max_rate == 0 || p->max_rate > ST_MAX_RATE || p->accel == 0 || p->tick_hz == 0 || from >= steps) {
+    return 0;
+  }
+  full = st_ramp_steps(p);
+  ramp = full * 2 > steps ? steps / 2 : full;
+  if (size > steps - from) {
+    size = steps - from;
+  }
+  for (i = 0; i < size; i++) {
+    uint32_t k = from + i + 1, j;
+    if (k <= ramp) {
+      j = k;
+    } else if (k > steps - ramp) {
+      j = steps + 1 - k;
+    } else if (ramp < full) {
+      /* odd short move, the middle step still accelerates */
+      j = ramp + 1;
+    } else {
+      intervals[i] = (uint32_t)(cruise_time(p, k - ramp) - cruise_time(p, k - ramp - 1));
+      continue;
+    }
+    intervals[i] = (uint32_t)(ramp_time(p, j) - ramp_time(p, j - 1));
+  }
+  return size;
+}
+
+void st_timer_top(uint32_t *intervals, uint32_t count)
+{
+  uint32_t i;
+  for (i = 0; i < count; i++) {
+    intervals[i]--;
+  }
+}
+
+uint32_t st_check(const st_profile *p, const uint32_t *intervals, uint32_t count, uint32_t min_interval)
+{
+  /* rate is steps per interval, taken at the middle of the interval: exact for a constant acceleration */
+  double f = p->tick_hz, limit = p->accel * 1.01;
+  uint32_t i;
+  for (i = 0; i < count; i++) {
+    if (intervals[i] < min_interval) {
+      return i + 1;
+    }
+    if (i > 0) {
+      double a = intervals[i - 1], b = intervals[i], d = a > b ? a - b : b - a;
+      if (d > 2 && 2 * f * f * (d - 2) / (a * b * (a + b)) > limit) {
+        return i + 1;
+      }
+    }
+  }
+  return 0;
+}
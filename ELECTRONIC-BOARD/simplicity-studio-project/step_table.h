@@ -0,0 +1,47 @@
+/*
+ *  step_table.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Step interval tables for the stepper driver (stepper.h), integer only so the board and the host
+ *  (simulation/steptable.c) compute the same tables
+ *
+ *  interval k is the time in timer ticks from step k - 1 (or the start) to step k,
+ *  a move ramps up from start_rate at constant acceleration, cruises at max_rate and ramps down
+ *  the same way, short moves never reach max_rate and turn around in the middle
+ */
+
+#ifndef STEP_TABLE_H_
+#define STEP_TABLE_H_
+
+#include <stdint.h>
+
+/* X = v0^2 + 2 a n has to fit 32 bits */
+#define ST_MAX_RATE 65000u
+
+typedef struct {
+  uint32_t tick_hz;     /* timer clock the intervals count */
+  uint32_t start_rate;  /* steps/s the motor starts from and stops at, 0 - from standstill */
+  uint32_t max_rate;    /* steps/s, at most ST_MAX_RATE */
+  uint32_t accel;       /* steps/s^2, not 0 */
+} st_profile;
+
+/* floor of the square root, the planner (planner.h) uses it too */
+uint32_t st_isqrt64(uint64_t x);
+
+/* steps spent accelerating from start_rate to max_rate */
+uint32_t st_ramp_steps(const st_profile *p);
+
+/* intervals from..from + size - 1 of a move of steps steps, returns how many were written,
+   a long move is built chunk by chunk into a small buffer with the same result as in one go */
+uint32_t st_trapezoid(const st_profile *p, uint32_t steps, uint32_t from, uint32_t *intervals, uint32_t size);
+
+/* interval - 1 in place: the top value of a timer that counts from 0 */
+void st_timer_top(uint32_t *intervals, uint32_t count);
+
+/* 0 when the table is playable, otherwise 1 + the index of the first interval shorter than min_interval
+   or one that changes the rate by more than the acceleration allows (rounding of both intervals tolerated) */
+uint32_t st_check(const st_profile *p, const uint32_t *intervals, uint32_t count, uint32_t min_interval);
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ *  stepper.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Registers are programmed directly for the LDMA, em_ldma is not part of this SDK tree
+ *
+ *  step k comes at overflow k of TIMER0, the period before it is interval k - 1 of the stream of all
+ *  queued segments. TOP and TOPB are loaded with the first two intervals before the start, then the
+ *  overflow request of every step makes the LDMA write the interval after the next one into TOPB:
+ *    segment descriptors   intervals 2.. of the first segment, all of the queued ones
+ *    tail descriptor       a long TOPB for the period after the last step
+ *    stop descriptor       compare value 0 (output held low) from the overflow after the last step on,
+ *                          its interrupt stops the timer
+ *  TIMER0 and the LDMA do not run in EM2, sleep is blocked at EM1 while the motor turns
+ *  a move is counted over this whole stream: every overflow loads one element, TOP and TOPB hold the
+ *  two after the played steps, so the steps played are the elements loaded (preloads included) less two
+ */
+
+#include <stddef.h>
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "em_timer.h"
+#include "sleep.h"
+
+#include "stepper.h"
+
+#define CHANNEL_MASK (1u << STEPPER_DMA_CHANNEL)
+#define CHANNEL (&LDMA->CH[STEPPER_DMA_CHANNEL])
+
+/* descriptors: two segment slots, the tail and the stop */
+#define TAIL 2
+#define STOP 3
+
+/* 1 ms after the last step, the stop interrupt has all of it */
+#define TAIL_TICKS (STEPPER_TICK_HZ / 1000 - 1)
+
+typedef struct {
+  const uint32_t *intervals;
+  uint32_t count;
+  int direction;
+  int slot;                 /* segment descriptor, -1 - the first two intervals were the whole segment */
+} segment;
+
+static DMA_DESCRIPTOR_TypeDef descriptors[4];
+static const uint32_t tail_top = TAIL_TICKS;
+static const uint32_t no_pulse = 0;
+
+/* [0] runs, [1] follows it */
+static segment queue[2];
+static volatile int queued = 0;
+/* the timer plays steps until the stop descriptor, the last two after their segment left the queue */
+static volatile int running = 0;
+/* where the running move started, all steps when idle */
+static volatile int32_t position = 0;
+static int moving = 1;
+/* intervals of the running move's segments that left the queue */
+static volatile uint32_t finished = 0;
+static sched_task *done_task = NULL;
+
+static void describe(int index, const volatile void *src, volatile void *dst, uint32_t count, int done, int next)
+{
+  descriptors[index].CTRL = LDMA_CH_CTRL_STRUCTTYPE_TRANSFER
+                            | ((count - 1) << _LDMA_CH_CTRL_XFERCNT_SHIFT)
+                            | LDMA_CH_CTRL_BLOCKSIZE_UNIT1
+                            | LDMA_CH_CTRL_REQMODE_BLOCK
+                            | (done ? LDMA_CH_CTRL_DONEIEN : 0)
+                            | LDMA_CH_CTRL_SRCINC_ONE
+                            | LDMA_CH_CTRL_SIZE_WORD
+                            | LDMA_CH_CTRL_DSTINC_NONE
+                            | LDMA_CH_CTRL_SRCMODE_ABSOLUTE
+                            | LDMA_CH_CTRL_DSTMODE_ABSOLUTE;
+  descriptors[index].SRC = (void *)src;
+  descriptors[index].DST = dst;
+  descriptors[index].LINK = next < 0 ? 0 : (void *)((uint32_t)&descriptors[next] | LDMA_CH_LINK_LINK);
+}
+
+/* the channel still reads this segment's table */
+static int reading(const segment *s)
+{
+  const uint32_t *src = (const uint32_t *)CHANNEL->SRC;
+  return s->slot >= 0 && src >= s->intervals && src < s->intervals + s->count;
+}
+
+/* elements of the running move's stream the LDMA loaded */
+static uint32_t loaded(void)
+{
+  const uint32_t *src = (const uint32_t *)CHANNEL->SRC;
+  uint32_t n = finished;
+  int i;
+  /* the segment the channel reads, the ones before it are loaded whole */
+  for (i = 0; i < queued; i++) {
+    if (reading(&queue[i])) {
+      return n + (uint32_t)(src - queue[i].intervals);
+    }
+    n += queue[i].count;
+  }
+  /* tail and stop, the tail is preloaded for a one step move */
+  if (src == &tail_top + 1 || src == &no_pulse) {
+    n += 1;
+  } else if (src == &no_pulse + 1) {
+    n += 2;
+  }
+  return n;
+}
+
+/* steps of the running move played by now */
+static int32_t played(void)
+{
+  uint32_t n = loaded();
+  return n < 2 ? 0 : (int32_t)(n - 2);
+}
+
+static void pop(void)
+{
+  finished += queue[0].count;
+  queue[0] = queue[1];
+  queued--;
+}
+
+static void halt(void)
+{
+  TIMER0->CMD = TIMER_CMD_STOP;
+  LDMA->CHDIS = CHANNEL_MASK;
+  LDMA->CHDONE_CLR = CHANNEL_MASK;
+  LDMA->IF_CLR = CHANNEL_MASK;
+  running = 0;
+  SLEEP_SleepBlockEnd(sleepEM2);
+}
+
+static void start(const uint32_t *intervals, uint32_t count, int direction)
+{
+  int first = count == 1 ? STOP : TAIL;
+  if (direction > 0) {
+    GPIO_PinOutSet(STEPPER_DIR_PORT, STEPPER_DIR_PIN);
+  } else {
+    GPIO_PinOutClear(STEPPER_DIR_PORT, STEPPER_DIR_PIN);
+  }
+  TIMER0->CMD = TIMER_CMD_STOP;
+  TIMER0->CNT = 0;
+  TIMER0->TOP = intervals[0];
+  TIMER0->TOPB = count > 1 ? intervals[1] : TAIL_TICKS;
+  TIMER0->CC[0].OC = STEPPER_PULSE_TICKS;
+  TIMER0->CC[0].OCB = STEPPER_PULSE_TICKS;
+
+  queue[0].intervals = intervals;
+  queue[0].count = count;
+  queue[0].direction = direction;
+  queue[0].slot = -1;
+  if (count > 2) {
+    describe(0, intervals + 2, &TIMER0->TOPB, count - 2, 1, TAIL);
+    queue[0].slot = 0;
+    first = 0;
+  }
+  queued = 1;
+  running = 1;
+  moving = direction;
+  finished = 0;
+
+  SLEEP_SleepBlockBegin(sleepEM2);
+  LDMA->REQCLEAR = CHANNEL_MASK;
+  LDMA->CHDONE_CLR = CHANNEL_MASK;
+  LDMA->IF_CLR = CHANNEL_MASK;
+  CHANNEL->LINK = (uint32_t)&descriptors[first] & _LDMA_CH_LINK_LINKADDR_MASK;
+  LDMA->LINKLOAD = CHANNEL_MASK;
+  TIMER0->IF_CLR = TIMER_IF_OF;
+  TIMER0->CMD = TIMER_CMD_START;
+}
+
+/* the running segment's descriptor is in the channel registers already, its link is changed there */
+static int append(const uint32_t *intervals, uint32_t count)
+{
+  segment *next = &queue[1];
+  uint32_t left = (CHANNEL->CTRL & _LDMA_CH_CTRL_XFERCNT_MASK) >> _LDMA_CH_CTRL_XFERCNT_SHIFT;
+  /* one more transfer after this one at least, the link is not being loaded while it is written */
+  if (!reading(&queue[0]) || left < 1) {
+    return STEPPER_TOO_LATE;
+  }
+  next->intervals = intervals;
+  next->count = count;
+  next->direction = queue[0].direction;
+  next->slot = queue[0].slot ^ 1;
+  describe(next->slot, intervals, &TIMER0->TOPB, count, 1, TAIL);
+  CHANNEL->LINK = (uint32_t)&descriptors[next->slot] | LDMA_CH_LINK_LINK;
+  queued = 2;
+  return STEPPER_OK;
+}
+
+void LDMA_IRQHandler(void)
+{
+  uint32_t flags = LDMA->IF & CHANNEL_MASK;
+  if (!flags) {
+    return;
+  }
+  LDMA->IF_CLR = flags;
+  if (LDMA->CHDONE & CHANNEL_MASK) {
+    /* stop descriptor: no more pulses, the timer is in the tail period */
+    position += moving * played();
+    halt();
+    queued = 0;
+  } else {
+    /* a segment descriptor, more than one when the interrupt came late */
+    while (queued && !reading(&queue[0])) {
+      pop();
+    }
+  }
+  if (done_task) {
+    sched_post(done_task);
+  }
+}
+
+void stepper_init(sched_task *segment_done)
+{
+  TIMER_Init_TypeDef timer = TIMER_INIT_DEFAULT;
+  TIMER_InitCC_TypeDef cc = TIMER_INITCC_DEFAULT;
+
+  done_task = segment_done;
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  GPIO_PinModeSet(STEPPER_STEP_PORT, STEPPER_STEP_PIN, gpioModePushPull, 0);
+  GPIO_PinModeSet(STEPPER_DIR_PORT, STEPPER_DIR_PIN, gpioModePushPull, 0);
+  GPIO_PinModeSet(STEPPER_ENABLE_PORT, STEPPER_ENABLE_PIN, gpioModePushPull, 1);
+
+  /* output set at overflow, cleared at the compare value: a pulse at the start of every period */
+  cc.mode = timerCCModePWM;
+  TIMER_InitCC(TIMER0, 0, &cc);
+  timer.enable = false;
+  timer.prescale = timerPrescale16;
+  timer.dmaClrAct = true;
+  TIMER_Init(TIMER0, &timer);
+  GPIO->TIMERROUTE[0].CC0ROUTE = (STEPPER_STEP_PORT << _GPIO_TIMER_CC0ROUTE_PORT_SHIFT)
+                                 | (STEPPER_STEP_PIN << _GPIO_TIMER_CC0ROUTE_PIN_SHIFT);
+  GPIO->TIMERROUTE[0].ROUTEEN = GPIO_TIMER_ROUTEEN_CC0PEN;
+
+  describe(TAIL, &tail_top, &TIMER0->TOPB, 1, 0, STOP);
+  describe(STOP, &no_pulse, &TIMER0->CC[0].OCB, 1, 1, -1);
+
+  LDMA->EN = LDMA_EN_EN;
+  LDMAXBAR->CH[STEPPER_DMA_CHANNEL].REQSEL = LDMAXBAR_CH_REQSEL_SOURCESEL_TIMER0
+                                             | LDMAXBAR_CH_REQSEL_SIGSEL_TIMER0UFOF;
+  CHANNEL->CFG = LDMA_CH_CFG_ARBSLOTS_ONE;
+  CHANNEL->LOOP = 0;
+  LDMA->IEN_SET = CHANNEL_MASK;
+  NVIC_ClearPendingIRQ(LDMA_IRQn);
+  NVIC_EnableIRQ(LDMA_IRQn);
+}
+
+void stepper_enable(int on)
+{
+  if (on) {
+    GPIO_PinOutClear(STEPPER_ENABLE_PORT, STEPPER_ENABLE_PIN);
+  } else {
+    GPIO_PinOutSet(STEPPER_ENABLE_PORT, STEPPER_ENABLE_PIN);
+  }
+}
+
+int stepper_queue(const uint32_t *intervals, uint32_t count, int direction)
+{
+  int result = STEPPER_OK;
+  CORE_DECLARE_IRQ_STATE;
+
+  if (!intervals || count == 0 || count > STEPPER_MAX_SEGMENT || (direction != 1 && direction != -1)) {
+    return STEPPER_INVALID;
+  }
+  CORE_ENTER_ATOMIC();
+  if (queued == 0 && running) {
+    result = STEPPER_TOO_LATE;
+  } else if (queued == 0) {
+    start(intervals, count, direction);
+  } else if (queued == 2) {
+    result = STEPPER_BUSY;
+  } else if (direction != queue[0].direction) {
+    result = STEPPER_DIRECTION;
+  } else {
+    result = append(intervals, count);
+  }
+  CORE_EXIT_ATOMIC();
+  return result;
+}
+
+void stepper_stop(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (running) {
+    position += moving * played();
+    halt();
+    queued = 0;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+int stepper_busy(void)
+{
+  return running;
+}
+
+int stepper_free(void)
+{
+  return 2 - queued;
+}
+
+int32_t stepper_position(void)
+{
+  return position;
+}
+
+int32_t stepper_played(void)
+{
+  int32_t steps;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  steps = running ? position + moving * played() : position;
+  CORE_EXIT_ATOMIC();
+  return steps;
+}
@@ -0,0 +1,71 @@
+/*
+ *  stepper.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  STEP/DIR stepper driver: TIMER0 compare channel 0 in PWM mode makes the STEP pulses, LDMA loads
+ *  the next interval from a RAM table (step_table.h) into the buffered top value at every overflow,
+ *  so the CPU does nothing per step, only once per segment
+ *
+ *  a segment is a table of intervals (timer ticks before each step) in one direction, the table has to
+ *  stay untouched until the segment finished; a second segment can be queued behind the running one
+ *  and follows it without a gap. The LDMA copies the table as it is and a timer period is TOP + 1 ticks,
+ *  st_timer_top turns a step_table.h table into TOP values before it is queued
+ */
+
+#ifndef STEPPER_H_
+#define STEPPER_H_
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+/* pins of the driver board */
+#define STEPPER_STEP_PORT    gpioPortB
+#define STEPPER_STEP_PIN     0
+#define STEPPER_DIR_PORT     gpioPortB
+#define STEPPER_DIR_PIN      1
+#define STEPPER_ENABLE_PORT  gpioPortC  /* active low */
+#define STEPPER_ENABLE_PIN   0
+
+/* LDMA channel, DMADRV is not used in this project */
+#define STEPPER_DMA_CHANNEL  7
+
+/* 38.4 MHz HFXO divided by 16 */
+#define STEPPER_TICK_HZ      2400000u
+/* drivers want at least 1.9 us high */
+#define STEPPER_PULSE_TICKS  6
+/* 40 kHz steps, the LDMA has to serve the overflow request before the next one */
+#define STEPPER_MIN_INTERVAL 60
+/* LDMA transfer count limit */
+#define STEPPER_MAX_SEGMENT  2048
+
+enum {
+  STEPPER_OK = 0,
+  STEPPER_BUSY,        /* two segments queued already */
+  STEPPER_TOO_LATE,    /* running segment too close to its end to queue behind it, queue after it ends */
+  STEPPER_DIRECTION,   /* a queued segment can not reverse */
+  STEPPER_INVALID
+};
+
+/* segment_done is posted (from the LDMA interrupt) when a segment has been handed to the timer and when
+   the last step played, NULL - none */
+void stepper_init(sched_task *segment_done);
+void stepper_enable(int on);
+
+/* direction +1 or -1, starts right away when idle, otherwise queues behind the running segment */
+int stepper_queue(const uint32_t *intervals, uint32_t count, int direction);
+/* stops after the current step, queued segments are dropped */
+void stepper_stop(void);
+
+/* steps still playing, a new move can start when it is 0 */
+int stepper_busy(void);
+/* free places for segments, 0 - 2 */
+int stepper_free(void);
+/* steps of finished moves, where the running one started; exact after stepper_stop */
+int32_t stepper_position(void);
+/* steps played by now, counted from the intervals the LDMA loaded, safe in interrupts */
+int32_t stepper_played(void);
+
+#endif
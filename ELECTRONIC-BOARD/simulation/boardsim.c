@@ -0,0 +1,581 @@
+/*
+ *  boardsim.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Runs the board application on Linux against the simulated stack (gecko_sim.c)
+ *  usage: boardsim [--script=file] [--trace] [--budget-us=50] [--cpu-scale=1]
+ *  without a script a phone session is simulated (gimbal_protocol sender, bad frames, config writes,
+ *  a silent phone, disconnect) and the results are checked, exit 1 when the firmware got something wrong;
+ *  the motor (stepper_sim.c) has to keep to the velocity and acceleration limits, start every move from
+ *  rest, get its tables untouched while it plays them and end stopped and disabled;
+ *  a second session tracks a target swinging in front of the camera with GP_TRACK frames: the phone
+ *  measures it against the motor 30 times a second and its writes arrive late, first only waiting for a
+ *  connection event, then also retransmitted, the on-board loop has to keep the target near the center
+ *  both times; the gains written over GATT have to be in NVM3 when motion_service starts again
+ *  script lines: <ms> connect <conn> | disconnect <conn> <reason> | write <char> <hex> | request <char> <hex> |
+ *                read <char> | notify <char> on|off    (char: setpoint, status, config, gains or a handle)
+ *  virtual time follows the host cpu time of the firmware times --cpu-scale, so the scheduler sees event
+ *  handlers and tasks take time and reports its worst task latency; the board's core is a few tens of
+ *  times slower than a desktop one
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gecko_sim.h"
+#include "gatt_db.h"
+#include "motion_service.h"
+#include "scheduler.h"
+#include "stepper.h"
+#include "stepper_sim.h"
+
+#define CONNECTION 1
+#define MAX_EVENTS 16
+
+/* tracking session: two phases of TRACK_PHASE ms, the error is taken over the last period of each */
+#define TRACK_FROM 6000.0
+#define TRACK_PHASE 6000.0
+#define TRACK_END (TRACK_FROM + 200 + 2 * TRACK_PHASE)
+/* target swings TRACK_AMPLITUDE degrees to both sides every TRACK_PERIOD ms */
+#define TRACK_AMPLITUDE 40.0
+#define TRACK_PERIOD 4500.0
+/* camera frame to the phone's write, the write waits for the next 30 ms connection event */
+#define PHONE_LATENCY 60
+#define PHONE_CLOCK 51000   /* the phone's clock is ahead of the board's */
+#define PHONE_ALPHA 0.5     /* velocity smoothing of trk_target */
+#define STEPS_PER_DEGREE ((double)MOTION_STEPS_PER_TURN / 360)
+
+static int trace = 0;
+static double budget_us = 50;
+static double cpu_scale = 1;
+
+/* per event type cpu time */
+static struct {
+  uint32_t id;
+  const char *name;
+  double *us;
+  size_t count, capacity;
+  size_t over;
+} stats[MAX_EVENTS];
+
+/* what the phone saw */
+static int16_t max_notified = 0;
+static double limit_from_ms = 1e9;
+static int16_t limit = 0;
+static double stopped_ms = -1;
+static uint16_t accepted = 0, rejected = 0;
+static uint8_t config_errors[4];
+static int config_responses = 0;
+static int advertising = 0;
+static uint8_t gains_errors[2];
+static int gains_responses = 0;
+static uint8_t gains_read[MOTION_GAINS_SIZE];
+static int gains_read_len = -1;
+
+/* kp 8, ki 0.5, kd 0, feed-forward 1, latency PHONE_LATENCY ms; a latency of 900 ms is refused */
+static const uint8_t bad_gains[MOTION_GAINS_SIZE] = { 0x40, 0x1f, 0xf4, 0x01, 0, 0, 0xe8, 0x03, 0x84, 0x03 };
+static const uint8_t good_gains[MOTION_GAINS_SIZE] = { 0x40, 0x1f, 0xf4, 0x01, 0, 0, 0xe8, 0x03, PHONE_LATENCY, 0 };
+
+/* the phone's camera in the tracking session */
+static struct {
+  gp_sender sender;
+  double base;              /* target's center, steps */
+  double bearing;           /* last measurement, frame widths */
+  double velocity;
+  double delivered;         /* the link keeps the order of writes */
+  uint32_t random;
+  int started, sent, lost;
+  double squares[2];        /* error over the last period of each phase, degrees */
+  double worst[2];
+  int samples[2];
+} camera;
+
+static const char *event_name(uint32_t id)
+{
+  switch (id) {
+    case gecko_evt_system_boot_id: return "boot";
+    case gecko_evt_le_connection_opened_id: return "connection opened";
+    case gecko_evt_le_connection_closed_id: return "connection closed";
+    case gecko_evt_gatt_server_user_write_request_id: return "user write";
+    case gecko_evt_gatt_server_user_read_request_id: return "user read";
+    case gecko_evt_gatt_server_characteristic_status_id: return "characteristic status";
+    case gecko_evt_hardware_soft_timer_id: return "soft timer";
+    case gecko_evt_system_external_signal_id: return "external signal";
+    default: return "other";
+  }
+}
+
+static void on_handled(uint32_t id, double ms, double cpu_us)
+{
+  int i;
+  for (i = 0; i < MAX_EVENTS && stats[i].name && stats[i].id != id; i++) {
+  }
+  if (i == MAX_EVENTS) {
+    return;
+  }
+  if (!stats[i].name) {
+    stats[i].id = id;
+    stats[i].name = event_name(id);
+  }
+  if (stats[i].count == stats[i].capacity) {
+    stats[i].capacity = stats[i].capacity ? stats[i].capacity * 2 : 64;
+    stats[i].us = realloc(stats[i].us, stats[i].capacity * sizeof(double));
+    if (!stats[i].us) {
+      exit(2);
+    }
+  }
+  stats[i].us[stats[i].count++] = cpu_us;
+  if (cpu_us > budget_us) {
+    stats[i].over++;
+    if (trace) {
+      printf("%9.3f ms  %s took %.1f us, over budget\n", ms, stats[i].name, cpu_us);
+    }
+  }
+}
+
+static void on_output(const sim_output *out)
+{
+  int i;
+  switch (out->kind) {
+    case SIM_ADVERTISE:
+      advertising++;
+      if (trace) {
+        printf("%9.3f ms  advertising\n", out->ms);
+      }
+      break;
+    case SIM_NOTIFY:
+      if (out->characteristic == gattdb_motion_status && out->len == MOTION_STATUS_SIZE) {
+        uint8_t mode = out->data[0];
+        int16_t value = (int16_t)(out->data[2] | out->data[3] << 8);
+        accepted = (uint16_t)(out->data[4] | out->data[5] << 8);
+        rejected = (uint16_t)(out->data[6] | out->data[7] << 8);
+        if (out->ms >= limit_from_ms && abs(value) > max_notified) {
+          max_notified = (int16_t)abs(value);
+        }
+        if (mode == GP_STOP && stopped_ms < 0) {
+          stopped_ms = out->ms;
+        }
+        if (mode != GP_STOP) {
+          stopped_ms = -1;
+        }
+        if (trace) {
+          printf("%9.3f ms  status mode %u seq %u value %d accepted %u rejected %u\n",
+                 out->ms, mode, out->data[1], value, accepted, rejected);
+        }
+      }
+      break;
+    case SIM_READ_RESPONSE:
+    case SIM_WRITE_RESPONSE:
+      if (out->characteristic == gattdb_motion_config && out->kind == SIM_WRITE_RESPONSE && config_responses < 4) {
+        config_errors[config_responses++] = out->error;
+      }
+      if (out->characteristic == gattdb_motion_gains && out->kind == SIM_WRITE_RESPONSE && gains_responses < 2) {
+        gains_errors[gains_responses++] = out->error;
+      }
+      if (out->characteristic == gattdb_motion_gains && out->kind == SIM_READ_RESPONSE) {
+        gains_read_len = out->len;
+        memcpy(gains_read, out->data, out->len < MOTION_GAINS_SIZE ? out->len : MOTION_GAINS_SIZE);
+      }
+      if (trace) {
+        printf("%9.3f ms  %s response, characteristic %u, error 0x%02x,", out->ms,
+               out->kind == SIM_READ_RESPONSE ? "read" : "write", out->characteristic, out->error);
+        for (i = 0; i < out->len; i++) {
+          printf(" %02x", out->data[i]);
+        }
+        printf("\n");
+      }
+      break;
+    case SIM_CLOSE:
+    case SIM_RESET:
+      if (trace) {
+        printf("%9.3f ms  %s\n", out->ms, out->kind == SIM_CLOSE ? "connection closed by the board" : "reset");
+      }
+      break;
+  }
+}
+
+static int compare(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+static void report(void)
+{
+  int i;
+  printf("event handling cpu time (budget %.0f us):\n", budget_us);
+  for (i = 0; i < MAX_EVENTS && stats[i].name; i++) {
+    size_t n = stats[i].count;
+    qsort(stats[i].us, n, sizeof(double), compare);
+    printf("  %-22s %6lu events, p50 %6.2f us, p99 %6.2f us, max %7.2f us, over budget %lu\n",
+           stats[i].name, (unsigned long)n, stats[i].us[n / 2], stats[i].us[n * 99 / 100], stats[i].us[n - 1],
+           (unsigned long)stats[i].over);
+  }
+}
+
+/* release (or post) to start of run, measured by the scheduler in sleep clock ticks */
+static int motor_report(void)
+{
+  const stepper_sim_stats *motor = stepper_sim();
+  /* default velocity limit, the conversion of motion_service.c */
+  double limit_rate = 2000.0 * MOTION_FRAME_DEGREES * MOTION_STEPS_PER_TURN / 360 / 1000;
+  int failed = 0;
+  printf("motor %lu steps in %lu moves, at %ld, max %.0f steps/s, %.0f steps/s^2, shortest period %lu ticks,"
+         " %lu segments queued again\n", (unsigned long)motor->steps, (unsigned long)motor->moves,
+         (long)motor->position, motor->max_rate, motor->max_accel, (unsigned long)motor->min_interval,
+         (unsigned long)motor->rejected);
+  if (motor->max_rate > limit_rate * 1.01 || motor->max_rate < limit_rate / 2) {
+    printf("FAIL: step rate %.0f steps/s, limit %.0f\n", motor->max_rate, limit_rate);
+    failed = 1;
+  }
+  /* rates of 8 step windows, the planner keeps to its limit exactly */
+  if (motor->max_accel > MOTION_ACCEL * 1.1) {
+    printf("FAIL: acceleration %.0f steps/s^2, limit %d\n", motor->max_accel, MOTION_ACCEL);
+    failed = 1;
+  }
+  if (motor->max_start_rate > 100) {
+    printf("FAIL: a move started at %.0f steps/s, the feed fell behind\n", motor->max_start_rate);
+    failed = 1;
+  }
+  if (motor->min_interval < STEPPER_MIN_INTERVAL || motor->changed || motor->disabled_steps) {
+    printf("FAIL: shortest period %lu ticks, %lu tables changed while played, %lu steps while disabled\n",
+           (unsigned long)motor->min_interval, (unsigned long)motor->changed, (unsigned long)motor->disabled_steps);
+    failed = 1;
+  }
+  if (stepper_busy() || motor->enabled || stepper_position() != motor->position) {
+    printf("FAIL: motor not stopped and disabled at the end, driver at %ld\n", (long)stepper_position());
+    failed = 1;
+  }
+  return failed;
+}
+
+static uint32_t tasks_report(void)
+{
+  const sched_task *task;
+  uint32_t misses = 0;
+  printf("task latency (cpu scale %g):\n", cpu_scale);
+  for (task = sched_tasks(); task; task = task->next) {
+    printf("  %-22s %6lu runs, worst latency %7.1f us, deadline %7.1f us, misses %lu\n", task->name,
+           (unsigned long)task->runs, task->latency_max * 1e6 / SCHED_TICKS_PER_S,
+           task->deadline * 1e6 / SCHED_TICKS_PER_S, (unsigned long)task->misses);
+    misses += task->misses;
+  }
+  return misses;
+}
+
+static uint16_t characteristic(const char *name)
+{
+  if (strcmp(name, "setpoint") == 0) {
+    return gattdb_motion_setpoint;
+  }
+  if (strcmp(name, "status") == 0) {
+    return gattdb_motion_status;
+  }
+  if (strcmp(name, "config") == 0) {
+    return gattdb_motion_config;
+  }
+  if (strcmp(name, "gains") == 0) {
+    return gattdb_motion_gains;
+  }
+  return (uint16_t)strtoul(name, NULL, 0);
+}
+
+/* returns the time of the last event or -1 */
+static double load(const char *path)
+{
+  char line[1024], event[32], name[32];
+  double last = 0;
+  int number = 0;
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), file)) {
+    double ms;
+    int used = 0;
+    number++;
+    if (line[0] == '#' || sscanf(line, "%lf %31s %n", &ms, event, &used) < 2) {
+      continue;
+    }
+    if (ms > last) {
+      last = ms;
+    }
+    if (strcmp(event, "connect") == 0) {
+      sim_connect(ms, (uint8_t)atoi(line + used));
+    } else if (strcmp(event, "disconnect") == 0) {
+      unsigned conn = 0, reason = 0;
+      sscanf(line + used, "%u %i", &conn, &reason);
+      sim_disconnect(ms, (uint8_t)conn, (uint16_t)reason);
+    } else if (strcmp(event, "write") == 0 || strcmp(event, "request") == 0) {
+      uint8_t data[255];
+      int len = 0, n = 0;
+      const char *p = line + used;
+      unsigned byte;
+      if (sscanf(p, "%31s %n", name, &n) < 1) {
+        fprintf(stderr, "%s:%d: characteristic missing\n", path, number);
+        fclose(file);
+        return -1;
+      }
+      p += n;
+      while (len < 255 && sscanf(p, "%2x%n", &byte, &n) == 1) {
+        data[len++] = (uint8_t)byte;
+        p += n;
+        while (*p == ' ') {
+          p++;
+        }
+      }
+      sim_write(ms, CONNECTION, characteristic(name),
+                event[0] == 'w' ? gatt_write_command : gatt_write_request, data, (uint8_t)len);
+    } else if (strcmp(event, "read") == 0 && sscanf(line + used, "%31s", name) == 1) {
+      sim_read(ms, CONNECTION, characteristic(name));
+    } else if (strcmp(event, "notify") == 0 && sscanf(line + used, "%31s %31s", name, event) == 2) {
+      sim_client_config(ms, CONNECTION, characteristic(name), strcmp(event, "on") == 0 ? gatt_notification : 0);
+    } else {
+      fprintf(stderr, "%s:%d: unknown event\n", path, number);
+      fclose(file);
+      return -1;
+    }
+  }
+  fclose(file);
+  return last;
+}
+
+/* phone side like the apps: one sender poll per 30 ms connection interval */
+static void phone(double from, double to, double *last_write, int *sent)
+{
+  gp_sender sender;
+  uint8_t frame[GP_MAX_FRAME_SIZE];
+  double ms;
+  size_t size;
+  gp_sender_init(&sender, 20, 30, 1000);
+  for (ms = from; ms < to; ms += 30) {
+    gp_sender_set(&sender, GP_VELOCITY, (int16_t)(1800 * sin((ms - from) / 600)));
+    if ((size = gp_sender_poll(&sender, (uint32_t)ms, frame)) != 0) {
+      sim_write(ms, CONNECTION, gattdb_motion_setpoint, gatt_write_command, frame, (uint8_t)size);
+      *last_write = ms;
+      (*sent)++;
+    }
+  }
+}
+
+static double target_steps(double ms)
+{
+  return camera.base + TRACK_AMPLITUDE * STEPS_PER_DEGREE * sin(2 * M_PI * (ms - TRACK_FROM) / TRACK_PERIOD);
+}
+
+/* up to three retransmissions, a quarter of the writes is late */
+static int retransmissions(void)
+{
+  camera.random = camera.random * 1103515245u + 12345u;
+  return (camera.random >> 16) % 4 == 0 ? 1 + (int)((camera.random >> 20) % 3) : 0;
+}
+
+
+/* a camera frame: the target against where the motor points now, the write goes out PHONE_LATENCY
+   later at the next connection event; the phone filters the velocity like trk_target */
+static void camera_frame(void)
+{
+  double ms = sim_now_ms(), motor = stepper_played(), bearing, error, at;
+  uint8_t frame[GP_MAX_FRAME_SIZE];
+  size_t size;
+  int phase = ms < TRACK_FROM + 200 + TRACK_PHASE ? 0 : 1;
+
+  if (ms >= TRACK_END) {
+    return;
+  }
+  if (!camera.started) {
+    camera.started = 1;
+    camera.base = motor;
+    camera.random = 1;
+    gp_sender_init(&camera.sender, 2, 30, 1000);
+  }
+  error = (target_steps(ms) - motor) / STEPS_PER_DEGREE;
+  if (fmod(ms - TRACK_FROM - 200, TRACK_PHASE) >= TRACK_PHASE - TRACK_PERIOD) {
+    camera.squares[phase] += error * error;
+    camera.samples[phase]++;
+    if (fabs(error) > camera.worst[phase]) {
+      camera.worst[phase] = fabs(error);
+    }
+  }
+  bearing = error / MOTION_FRAME_DEGREES;
+  if (fabs(bearing) > 0.5) {
+    camera.lost++;
+    gp_sender_set(&camera.sender, GP_STOP, 0);
+  } else {
+    if (camera.sent) {
+      camera.velocity += PHONE_ALPHA * ((bearing - camera.bearing) * 30 - camera.velocity);
+    }
+    camera.bearing = bearing;
+    gp_sender_set_track(&camera.sender, (int16_t)lround(bearing * 1000), (int16_t)lround(camera.velocity * 1000));
+  }
+  at = ms + PHONE_LATENCY;
+  if ((size = gp_sender_poll(&camera.sender, (uint32_t)(at + PHONE_CLOCK), frame)) == 0) {
+    return;
+  }
+  at = ceil(at / 30) * 30;
+  if (phase) {
+    at += 30 * retransmissions();
+  }
+  if (at < camera.delivered) {
+    at = camera.delivered;
+  }
+  camera.delivered = at;
+  camera.sent++;
+  sim_write(at, CONNECTION, gattdb_motion_setpoint, gatt_write_command, frame, (uint8_t)size);
+}
+
+static int tracking_report(void)
+{
+  double rms[2];
+  int i, failed = 0;
+  for (i = 0; i < 2; i++) {
+    rms[i] = camera.samples[i] ? sqrt(camera.squares[i] / camera.samples[i]) : 1e9;
+    printf("tracking %s: error rms %.2f deg, worst %.2f deg over %d frames\n",
+           i ? "with retransmissions" : "on time", rms[i], camera.worst[i], camera.samples[i]);
+  }
+  printf("tracking frames sent %d, target out of frame %d times\n", camera.sent, camera.lost);
+  if (camera.lost || rms[0] > 3.5 || camera.worst[0] > 8) {
+    printf("FAIL: target not kept in the center\n");
+    failed = 1;
+  }
+  if (rms[1] > rms[0] * 1.5 + 1) {
+    printf("FAIL: late frames spoil the tracking\n");
+    failed = 1;
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  static gecko_configuration_t config;
+  const char *script = NULL;
+  double last_write = 0, end_ms = 6000, last;
+  int i, sent = 0, failed = 0;
+  const motion_state *state;
+  const motion_config *current;
+
+  for (i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--script=", 9) == 0) {
+      script = argv[i] + 9;
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      trace = 1;
+    } else if (strncmp(argv[i], "--budget-us=", 12) == 0) {
+      budget_us = atof(argv[i] + 12);
+    } else if (strncmp(argv[i], "--cpu-scale=", 12) == 0) {
+      cpu_scale = atof(argv[i] + 12);
+    } else {
+      fprintf(stderr, "usage: boardsim [--script=file] [--trace] [--budget-us=50] [--cpu-scale=1]\n");
+      return 2;
+    }
+  }
+  sim_on_output(on_output);
+  sim_on_handled(on_handled);
+  sim_cpu_scale(cpu_scale);
+
+  if (script) {
+    if ((last = load(script)) < 0) {
+      return 2;
+    }
+    /* a second for timeouts after the last event, periodic tasks would run for ever */
+    sim_run(&config, last + 1000);
+    report();
+    tasks_report();
+    return 0;
+  }
+
+  {
+    static const uint8_t bad_config[MOTION_CONFIG_SIZE] = { 0xb0, 0x04, 50, 0, 0, 0 };    /* 50 ms timeout */
+    static const uint8_t good_config[MOTION_CONFIG_SIZE] = { 0xb0, 0x04, 0xf4, 0x01, 0, 0 }; /* 1200, 500 ms */
+    uint8_t frame[GP_MAX_FRAME_SIZE];
+    gp_command cmd = { GP_VELOCITY, 200, 0, 100, 0 };
+    size_t size;
+
+    sim_connect(20, CONNECTION);
+    sim_client_config(60, CONNECTION, gattdb_motion_status, gatt_notification);
+    sim_read(80, CONNECTION, gattdb_motion_config);
+    phone(100, 3000, &last_write, &sent);
+    /* an old frame replayed and a corrupted one */
+    size = gp_encode(&cmd, frame);
+    sim_write(1000, CONNECTION, gattdb_motion_setpoint, gatt_write_command, frame, (uint8_t)size);
+    frame[3] ^= 0x40;
+    sim_write(1500, CONNECTION, gattdb_motion_setpoint, gatt_write_command, frame, (uint8_t)size);
+    sim_write(2000, CONNECTION, gattdb_motion_config, gatt_write_request, bad_config, MOTION_CONFIG_SIZE);
+    sim_write(2100, CONNECTION, gattdb_motion_config, gatt_write_request, good_config, MOTION_CONFIG_SIZE);
+    limit_from_ms = 2100;
+    limit = 1200;
+    /* phone goes silent after 3 s, then disconnects */
+    sim_disconnect(5000, CONNECTION, 0x13);
+
+    sim_connect(TRACK_FROM, CONNECTION);
+    sim_write(TRACK_FROM + 50, CONNECTION, gattdb_motion_gains, gatt_write_request, bad_gains, MOTION_GAINS_SIZE);
+    sim_write(TRACK_FROM + 100, CONNECTION, gattdb_motion_gains, gatt_write_request, good_gains, MOTION_GAINS_SIZE);
+    sim_read(TRACK_FROM + 150, CONNECTION, gattdb_motion_gains);
+    sim_every(TRACK_FROM + 200, 1000.0 / 30, camera_frame);
+    cmd = (gp_command){ GP_STOP, 0, 0, 0, 0 };
+    size = gp_encode(&cmd, frame);
+    sim_write(TRACK_END + 100, CONNECTION, gattdb_motion_setpoint, gatt_write_command, frame, (uint8_t)size);
+    sim_disconnect(TRACK_END + 1500, CONNECTION, 0x13);
+    end_ms = TRACK_END + 3000;
+    sim_run(&config, end_ms);
+  }
+
+  state = motion_current();
+  current = motion_get_config();
+  printf("frames sent %d, accepted %u, rejected %u\n", sent, accepted, rejected);
+  if (accepted != sent || rejected != 2) {
+    printf("FAIL: expected %d accepted and 2 rejected frames\n", sent);
+    failed = 1;
+  }
+  if (config_responses != 2 || config_errors[0] != (uint8_t)bg_err_att_value_not_allowed || config_errors[1] != 0) {
+    printf("FAIL: config writes answered %d times, errors 0x%02x 0x%02x\n", config_responses,
+           config_errors[0], config_errors[1]);
+    failed = 1;
+  }
+  if (max_notified > limit || current->max_velocity != limit) {
+    printf("FAIL: velocity %d over the configured limit %d\n", max_notified, limit);
+    failed = 1;
+  }
+  /* last write at last_write ms, the timeout stop must come 500 ms later, one sleep clock tick tolerance */
+  if (stopped_ms < 0 || fabs(stopped_ms - (last_write + 500)) > 0.1) {
+    printf("FAIL: stop after silence at %.3f ms, expected %.3f ms\n", stopped_ms, last_write + 500);
+    failed = 1;
+  } else {
+    printf("stopped %.3f ms after the last frame\n", stopped_ms - last_write);
+  }
+  if (state->mode != GP_STOP || advertising < 2) {
+    printf("FAIL: after disconnect mode %u, advertising started %d times\n", state->mode, advertising);
+    failed = 1;
+  }
+  if (motor_report()) {
+    failed = 1;
+  }
+  if (tracking_report()) {
+    failed = 1;
+  }
+  if (gains_responses != 2 || gains_errors[0] != (uint8_t)bg_err_att_value_not_allowed || gains_errors[1] != 0
+      || gains_read_len != MOTION_GAINS_SIZE || memcmp(gains_read, good_gains, MOTION_GAINS_SIZE) != 0) {
+    printf("FAIL: gains writes answered %d times, errors 0x%02x 0x%02x, read back %d bytes\n", gains_responses,
+           gains_errors[0], gains_errors[1], gains_read_len);
+    failed = 1;
+  }
+  report();
+  if (tasks_report() != 0) {
+    printf("FAIL: tasks missed their deadlines\n");
+    failed = 1;
+  }
+  /* the gains come back from NVM3 at the next boot */
+  sched_init();
+  motion_init();
+  if (motion_get_gains()->kp != 8000 || motion_get_gains()->latency_ms != PHONE_LATENCY) {
+    printf("FAIL: gains not kept, kp %u latency %u ms after init\n", motion_get_gains()->kp,
+           motion_get_gains()->latency_ms);
+    failed = 1;
+  }
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed;
+}
@@ -0,0 +1,760 @@
+/*
+ *  gecko_sim.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Only the commands the application uses are simulated, a missing one is a link error
+ *  sleeptimer callbacks are the only interrupts, they run when virtual time passes their timeout
+ *  NVM3 is a RAM table of objects, it keeps them when the application is initialized again
+ *  cpu time is the thread's, the host running something else does not move virtual time
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "app.h"
+#include "gecko_sim.h"
+#include "nvm3.h"
+#include "sl_sleeptimer.h"
+
+#define MAX_TIMERS 8
+#define MAX_SLEEPTIMERS 8
+#define MAX_ATTRIBUTES 64
+#define MAX_OBJECTS 16
+
+typedef struct {
+  uint64_t at;
+  uint32_t order;
+  uint32_t id;
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t opcode;
+  uint16_t value; /* flags or reason */
+  uint8_t len;
+  uint8_t data[255];
+} scripted;
+
+typedef struct {
+  uint64_t at;
+  uint32_t period; /* 0 - single shot */
+  uint8_t active;
+} timer;
+
+/* command and response buffers of the stack, the SDK header casts them to gecko_cmd_packet */
+static uint32_t cmdbuf[(sizeof(struct gecko_cmd_packet) + 256) / 4 + 1];
+static uint32_t rspbuf[(sizeof(struct gecko_cmd_packet) + 256) / 4 + 1];
+void *gecko_cmd_msg_buf = cmdbuf;
+void *gecko_rsp_msg_buf = rspbuf;
+
+static uint32_t evtbuf[(sizeof(struct gecko_cmd_packet) + 256) / 4 + 1];
+static struct gecko_cmd_packet *const evt = (struct gecko_cmd_packet *)evtbuf;
+
+static scripted *script;
+static size_t count, capacity, next;
+static uint32_t orders;
+/* events were added while running, the ones after next are sorted before the next look at them */
+static int running, unsorted;
+static timer timers[MAX_TIMERS];
+static uint64_t now, end;
+static int booted;
+static jmp_buf finished;
+
+static struct {
+  sl_sleeptimer_timer_handle_t *handle;
+  uint64_t at;
+} sleeptimers[MAX_SLEEPTIMERS];
+static uint32_t signals;
+
+static double cpu_scale = 0;
+static double cpu_carry = 0;
+static struct timespec cpu_since;
+
+static struct {
+  uint8_t used;
+  uint8_t len;
+  uint8_t data[255];
+} attributes[MAX_ATTRIBUTES];
+
+static struct {
+  uint8_t used;
+  nvm3_ObjectKey_t key;
+  size_t len;
+  uint8_t data[NVM3_MAX_OBJECT_SIZE];
+} objects[MAX_OBJECTS];
+
+static nvm3_Handle_t nvm3_default;
+nvm3_Handle_t *nvm3_defaultHandle = &nvm3_default;
+
+static sl_sleeptimer_timer_handle_t harness;
+
+static sim_output_fn output_fn;
+static sim_handled_fn handled_fn;
+static uint32_t handling_id;
+static double handling_ms;
+static struct timespec handling_start;
+
+static struct gecko_cmd_packet *command(void)
+{
+  return (struct gecko_cmd_packet *)gecko_cmd_msg_buf;
+}
+
+static struct gecko_cmd_packet *response(void)
+{
+  memset(rspbuf, 0, sizeof(rspbuf));
+  return (struct gecko_cmd_packet *)gecko_rsp_msg_buf;
+}
+
+static uint64_t ticks(double ms)
+{
+  return (uint64_t)(ms * SIM_TICKS_PER_MS + 0.5);
+}
+
+double sim_now_ms(void)
+{
+  return now / SIM_TICKS_PER_MS;
+}
+
+void sim_cpu_scale(double factor)
+{
+  cpu_scale = factor;
+}
+
+static double since(const struct timespec *start)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (ts.tv_sec - start->tv_sec) * 1e6 + (ts.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+/* sleeptimer interrupts due by now, in timeout order; a callback reading the tick count does not
+   run the next one inside it, it follows when the callback returned */
+static void interrupts(void)
+{
+  static int running = 0;
+  if (running) {
+    return;
+  }
+  running = 1;
+  for (;;) {
+    int i, first = -1;
+    sl_sleeptimer_timer_handle_t *handle;
+    for (i = 0; i < MAX_SLEEPTIMERS; i++) {
+      if (sleeptimers[i].handle && sleeptimers[i].at <= now && (first < 0 || sleeptimers[i].at < sleeptimers[first].at)) {
+        first = i;
+      }
+    }
+    if (first < 0) {
+      break;
+    }
+    handle = sleeptimers[first].handle;
+    if (handle->timeout_periodic) {
+      sleeptimers[first].at += handle->timeout_periodic;
+    } else {
+      sleeptimers[first].handle = NULL;
+    }
+    handle->callback(handle, handle->callback_data);
+  }
+  running = 0;
+}
+
+/* the application ran since it last called into the stack, virtual time follows its cpu time */
+static void charge(void)
+{
+  if (cpu_scale > 0 && cpu_since.tv_sec) {
+    cpu_carry += since(&cpu_since) * cpu_scale * SIM_TICKS_PER_MS / 1000;
+    now += (uint64_t)cpu_carry;
+    cpu_carry -= (uint64_t)cpu_carry;
+  }
+  interrupts();
+}
+
+static void resume(void)
+{
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_since);
+}
+
+static scripted *add(double ms, uint32_t id)
+{
+  scripted *s;
+  if (count == capacity) {
+    capacity = capacity ? capacity * 2 : 256;
+    script = realloc(script, capacity * sizeof(*script));
+    if (!script) {
+      fprintf(stderr, "out of memory\n");
+      exit(2);
+    }
+  }
+  s = &script[count++];
+  memset(s, 0, sizeof(*s));
+  s->at = ticks(ms);
+  s->order = orders++;
+  s->id = id;
+  unsorted = running;
+  return s;
+}
+
+void sim_connect(double ms, uint8_t connection)
+{
+  add(ms, gecko_evt_le_connection_opened_id)->connection = connection;
+}
+
+void sim_disconnect(double ms, uint8_t connection, uint16_t reason)
+{
+  scripted *s = add(ms, gecko_evt_le_connection_closed_id);
+  s->connection = connection;
+  s->value = reason;
+}
+
+void sim_write(double ms, uint8_t connection, uint16_t characteristic, uint8_t opcode,
+               const uint8_t *data, uint8_t len)
+{
+  scripted *s = add(ms, gecko_evt_gatt_server_user_write_request_id);
+  s->connection = connection;
+  s->characteristic = characteristic;
+  s->opcode = opcode;
+  s->len = len;
+  memcpy(s->data, data, len);
+}
+
+void sim_read(double ms, uint8_t connection, uint16_t characteristic)
+{
+  scripted *s = add(ms, gecko_evt_gatt_server_user_read_request_id);
+  s->connection = connection;
+  s->characteristic = characteristic;
+  s->opcode = gatt_read_request;
+}
+
+void sim_client_config(double ms, uint8_t connection, uint16_t characteristic, uint16_t flags)
+{
+  scripted *s = add(ms, gecko_evt_gatt_server_characteristic_status_id);
+  s->connection = connection;
+  s->characteristic = characteristic;
+  s->value = flags;
+}
+
+void sim_on_output(sim_output_fn fn)
+{
+  output_fn = fn;
+}
+
+void sim_on_handled(sim_handled_fn fn)
+{
+  handled_fn = fn;
+}
+
+int sim_attribute(uint16_t attribute, uint8_t *data, int size)
+{
+  if (attribute >= MAX_ATTRIBUTES || !attributes[attribute].used) {
+    return -1;
+  }
+  if (size > attributes[attribute].len) {
+    size = attributes[attribute].len;
+  }
+  memcpy(data, attributes[attribute].data, size);
+  return attributes[attribute].len;
+}
+
+static void emit(int kind, uint8_t connection, uint16_t characteristic, uint8_t error,
+                 const uint8_t *data, uint8_t len)
+{
+  sim_output out;
+  if (!output_fn) {
+    return;
+  }
+  out.kind = kind;
+  out.ms = sim_now_ms();
+  out.connection = connection;
+  out.characteristic = characteristic;
+  out.error = error;
+  out.len = len;
+  if (len) {
+    memcpy(out.data, data, len);
+  }
+  output_fn(&out);
+}
+
+static int earlier(const void *a, const void *b)
+{
+  const scripted *x = a, *y = b;
+  if (x->at != y->at) {
+    return x->at < y->at ? -1 : 1;
+  }
+  return x->order < y->order ? -1 : x->order > y->order;
+}
+
+static void arrange(void)
+{
+  if (unsorted) {
+    qsort(script + next, count - next, sizeof(*script), earlier);
+    unsorted = 0;
+  }
+}
+
+/* cpu time of the previous event ends when the application asks for the next one */
+static void handled(void)
+{
+  if (!handling_id || !handled_fn) {
+    handling_id = 0;
+    return;
+  }
+  handled_fn(handling_id, handling_ms, since(&handling_start));
+  handling_id = 0;
+}
+
+static struct gecko_cmd_packet *deliver(uint32_t id)
+{
+  evt->header = id;
+  handling_id = id;
+  handling_ms = sim_now_ms();
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &handling_start);
+  return evt;
+}
+
+/* earliest soft timer, -1 when none runs */
+static int soonest(uint64_t *at)
+{
+  int t, first = -1;
+  *at = UINT64_MAX;
+  for (t = 0; t < MAX_TIMERS; t++) {
+    if (timers[t].active && timers[t].at < *at) {
+      *at = timers[t].at;
+      first = t;
+    }
+  }
+  return first;
+}
+
+/* next event due at or before limit, time moves to it */
+static struct gecko_cmd_packet *take(uint64_t limit)
+{
+  int first;
+  uint64_t at;
+  if (!booted) {
+    booted = 1;
+    memset(&evt->data.evt_system_boot, 0, sizeof(evt->data.evt_system_boot));
+    evt->data.evt_system_boot.major = 2;
+    return deliver(gecko_evt_system_boot_id);
+  }
+  if (signals) {
+    evt->data.evt_system_external_signal.extsignals = signals;
+    signals = 0;
+    return deliver(gecko_evt_system_external_signal_id);
+  }
+  arrange();
+  first = soonest(&at);
+  /* scripted events win ties, the timer sees what they changed */
+  if (next < count && script[next].at <= at) {
+    scripted *s = &script[next];
+    if (s->at > limit) {
+      return NULL;
+    }
+    next++;
+    if (s->at > now) {
+      now = s->at;
+    }
+    switch (s->id) {
+      case gecko_evt_le_connection_opened_id:
+        memset(&evt->data.evt_le_connection_opened, 0, sizeof(evt->data.evt_le_connection_opened));
+        evt->data.evt_le_connection_opened.connection = s->connection;
+        break;
+      case gecko_evt_le_connection_closed_id:
+        evt->data.evt_le_connection_closed.connection = s->connection;
+        evt->data.evt_le_connection_closed.reason = s->value;
+        break;
+      case gecko_evt_gatt_server_user_write_request_id:
+        evt->data.evt_gatt_server_user_write_request.connection = s->connection;
+        evt->data.evt_gatt_server_user_write_request.characteristic = s->characteristic;
+        evt->data.evt_gatt_server_user_write_request.att_opcode = s->opcode;
+        evt->data.evt_gatt_server_user_write_request.offset = 0;
+        evt->data.evt_gatt_server_user_write_request.value.len = s->len;
+        memcpy(evt->data.evt_gatt_server_user_write_request.value.data, s->data, s->len);
+        break;
+      case gecko_evt_gatt_server_user_read_request_id:
+        evt->data.evt_gatt_server_user_read_request.connection = s->connection;
+        evt->data.evt_gatt_server_user_read_request.characteristic = s->characteristic;
+        evt->data.evt_gatt_server_user_read_request.att_opcode = s->opcode;
+        evt->data.evt_gatt_server_user_read_request.offset = 0;
+        break;
+      case gecko_evt_gatt_server_characteristic_status_id:
+        evt->data.evt_gatt_server_characteristic_status.connection = s->connection;
+        evt->data.evt_gatt_server_characteristic_status.characteristic = s->characteristic;
+        evt->data.evt_gatt_server_characteristic_status.status_flags = gatt_server_client_config;
+        evt->data.evt_gatt_server_characteristic_status.client_config_flags = s->value;
+        break;
+    }
+    return deliver(s->id);
+  }
+  if (first < 0 || at > limit) {
+    return NULL;
+  }
+  if (at > now) {
+    now = at;
+  }
+  if (timers[first].period) {
+    timers[first].at += timers[first].period;
+  } else {
+    timers[first].active = 0;
+  }
+  evt->data.evt_hardware_soft_timer.handle = (uint8_t)first;
+  return deliver(gecko_evt_hardware_soft_timer_id);
+}
+
+struct gecko_cmd_packet *gecko_wait_event(void)
+{
+  struct gecko_cmd_packet *p;
+  charge();
+  handled();
+  p = take(end);
+  if (!p) {
+    longjmp(finished, 1);
+  }
+  resume();
+  return p;
+}
+
+struct gecko_cmd_packet *gecko_peek_event(void)
+{
+  struct gecko_cmd_packet *p;
+  charge();
+  handled();
+  p = take(now);
+  resume();
+  return p;
+}
+
+int gecko_event_pending(void)
+{
+  uint64_t at;
+  arrange();
+  if (!booted || signals || (next < count && script[next].at <= now)) {
+    return 1;
+  }
+  return soonest(&at) >= 0 && at <= now;
+}
+
+void gecko_external_signal(uint32 bits)
+{
+  signals |= bits;
+}
+
+/* idle until a stack event, a signal from a sleeptimer interrupt or max ms, ends the run when nothing
+   is left before the end */
+uint32 gecko_sleep_for_ms(uint32 max)
+{
+  uint64_t from, limit;
+  charge();
+  handled();
+  from = now;
+  limit = max == UINT32_MAX ? UINT64_MAX : now + ticks(max);
+  while (!gecko_event_pending()) {
+    uint64_t at, wake = limit;
+    int i, timer = -1;
+    arrange();
+    soonest(&at);
+    if (next < count && script[next].at < at) {
+      at = script[next].at;
+    }
+    if (at < wake) {
+      wake = at;
+    }
+    for (i = 0; i < MAX_SLEEPTIMERS; i++) {
+      if (sleeptimers[i].handle && sleeptimers[i].at <= wake) {
+        wake = sleeptimers[i].at;
+        timer = i;
+      }
+    }
+    if (wake > end) {
+      longjmp(finished, 1);
+    }
+    now = wake;
+    if (timer < 0) {
+      break;
+    }
+    interrupts();
+  }
+  resume();
+  return (uint32)((now - from) / SIM_TICKS_PER_MS);
+}
+
+static void harness_tick(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  ((sim_every_fn)data)();
+}
+
+void sim_every(double start_ms, double period_ms, sim_every_fn fn)
+{
+  int i;
+  for (i = 0; i < MAX_SLEEPTIMERS && sleeptimers[i].handle; i++) {
+  }
+  if (i == MAX_SLEEPTIMERS || harness.callback) {
+    fprintf(stderr, "sim_every: no sleeptimer left\n");
+    exit(2);
+  }
+  harness.callback = harness_tick;
+  harness.callback_data = (void *)fn;
+  harness.timeout_periodic = ticks(period_ms);
+  sleeptimers[i].handle = &harness;
+  sleeptimers[i].at = ticks(start_ms);
+}
+
+void sim_run(gecko_configuration_t *config, double end_ms)
+{
+  qsort(script, count, sizeof(*script), earlier);
+  end = ticks(end_ms);
+  running = 1;
+  resume();
+  if (setjmp(finished) == 0) {
+    appMain(config);
+  }
+  handled();
+}
+
+/* stack internals called by gecko_init */
+errorcode_t gecko_stack_init(const gecko_configuration_t *config)
+{
+  (void)config;
+  return bg_err_success;
+}
+
+void gecko_bgapi_class_dfu_init(void) {}
+void gecko_bgapi_class_system_init(void) {}
+void gecko_bgapi_class_le_gap_init(void) {}
+void gecko_bgapi_class_le_connection_init(void) {}
+void gecko_bgapi_class_gatt_init(void) {}
+void gecko_bgapi_class_gatt_server_init(void) {}
+void gecko_bgapi_class_hardware_init(void) {}
+void gecko_bgapi_class_flash_init(void) {}
+void gecko_bgapi_class_test_init(void) {}
+void gecko_bgapi_class_sm_init(void) {}
+
+/* sleeptimer on virtual time, the tick is the 32768 Hz sleep clock like on the board */
+
+sl_status_t sl_sleeptimer_init(void)
+{
+  return SL_STATUS_OK;
+}
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  charge();
+  resume();
+  return now;
+}
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return (uint32_t)sl_sleeptimer_get_tick_count64();
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+  return 32768;
+}
+
+static sl_status_t arm(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout, uint32_t period,
+                       sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                       uint8_t priority, uint16_t option_flags)
+{
+  int i, free = -1;
+  for (i = 0; i < MAX_SLEEPTIMERS; i++) {
+    if (sleeptimers[i].handle == handle) {
+      return SL_STATUS_NOT_READY;
+    }
+    if (!sleeptimers[i].handle && free < 0) {
+      free = i;
+    }
+  }
+  if (free < 0 || !callback) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  handle->callback = callback;
+  handle->callback_data = callback_data;
+  handle->priority = priority;
+  handle->option_flags = option_flags;
+  handle->timeout_periodic = period;
+  sleeptimers[free].handle = handle;
+  sleeptimers[free].at = now + timeout;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout,
+                                      sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                      uint8_t priority, uint16_t option_flags)
+{
+  return arm(handle, timeout, 0, callback, callback_data, priority, option_flags);
+}
+
+/* first timeout after one period like on the board */
+sl_status_t sl_sleeptimer_start_periodic_timer(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout,
+                                               sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                               uint8_t priority, uint16_t option_flags)
+{
+  return arm(handle, timeout, timeout, callback, callback_data, priority, option_flags);
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  int i;
+  for (i = 0; i < MAX_SLEEPTIMERS; i++) {
+    if (sleeptimers[i].handle == handle) {
+      sleeptimers[i].handle = NULL;
+      return SL_STATUS_OK;
+    }
+  }
+  return SL_STATUS_INVALID_STATE;
+}
+
+/* NVM3 default instance, data objects only */
+
+static int object(nvm3_ObjectKey_t key)
+{
+  int i;
+  for (i = 0; i < MAX_OBJECTS; i++) {
+    if (objects[i].used && objects[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t maxLen)
+{
+  int i = object(key);
+  (void)h;
+  if (i < 0) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  memcpy(value, objects[i].data, objects[i].len < maxLen ? objects[i].len : maxLen);
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len)
+{
+  int i = object(key);
+  (void)h;
+  if (key > NVM3_KEY_MAX || len > NVM3_MAX_OBJECT_SIZE) {
+    return ECODE_NVM3_ERR_PARAMETER;
+  }
+  if (i < 0) {
+    for (i = 0; i < MAX_OBJECTS && objects[i].used; i++) {
+    }
+  }
+  if (i == MAX_OBJECTS) {
+    return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+  objects[i].used = 1;
+  objects[i].key = key;
+  objects[i].len = len;
+  memcpy(objects[i].data, value, len);
+  return ECODE_NVM3_OK;
+}
+
+void sli_bt_cmd_handler_delegate(uint32_t header, gecko_cmd_handler handler, const void *payload)
+{
+  (void)header;
+  handler(payload);
+}
+
+/* commands */
+
+void sli_bt_cmd_le_gap_set_advertise_timing(const void *payload)
+{
+  (void)payload;
+  response()->data.rsp_le_gap_set_advertise_timing.result = bg_err_success;
+}
+
+void sli_bt_cmd_le_gap_start_advertising(const void *payload)
+{
+  (void)payload;
+  response()->data.rsp_le_gap_start_advertising.result = bg_err_success;
+  emit(SIM_ADVERTISE, 0xff, 0, 0, NULL, 0);
+}
+
+void sli_bt_cmd_le_connection_close(const void *payload)
+{
+  uint8_t connection = command()->data.cmd_le_connection_close.connection;
+  (void)payload;
+  response()->data.rsp_le_connection_close.result = bg_err_success;
+  emit(SIM_CLOSE, connection, 0, 0, NULL, 0);
+  /* closed right away, before anything else scripted at this time */
+  {
+    scripted *s = add(sim_now_ms(), gecko_evt_le_connection_closed_id);
+    s->at = now;
+    s->order = 0;
+    s->connection = connection;
+    s->value = bg_err_bt_connection_terminated_by_local_host;
+    qsort(script + next, count - next, sizeof(*script), earlier);
+  }
+}
+
+void sli_bt_cmd_system_reset(const void *payload)
+{
+  (void)payload;
+  emit(SIM_RESET, 0xff, 0, 0, NULL, 0);
+  handled();
+  longjmp(finished, 1);
+}
+
+void sli_bt_cmd_hardware_set_soft_timer(const void *payload)
+{
+  uint32_t time = command()->data.cmd_hardware_set_soft_timer.time;
+  uint8_t handle = command()->data.cmd_hardware_set_soft_timer.handle;
+  uint8_t single = command()->data.cmd_hardware_set_soft_timer.single_shot;
+  (void)payload;
+  if (handle >= MAX_TIMERS) {
+    response()->data.rsp_hardware_set_soft_timer.result = bg_err_invalid_param;
+    return;
+  }
+  timers[handle].active = time != 0;
+  timers[handle].at = now + time;
+  timers[handle].period = single ? 0 : time;
+  response()->data.rsp_hardware_set_soft_timer.result = bg_err_success;
+}
+
+void sli_bt_cmd_gatt_server_write_attribute_value(const void *payload)
+{
+  uint16_t attribute = command()->data.cmd_gatt_server_write_attribute_value.attribute;
+  uint16_t offset = command()->data.cmd_gatt_server_write_attribute_value.offset;
+  uint8_t len = command()->data.cmd_gatt_server_write_attribute_value.value.len;
+  (void)payload;
+  if (attribute >= MAX_ATTRIBUTES || offset + len > 255) {
+    response()->data.rsp_gatt_server_write_attribute_value.result = bg_err_att_invalid_handle;
+    return;
+  }
+  memcpy(attributes[attribute].data + offset, command()->data.cmd_gatt_server_write_attribute_value.value.data, len);
+  attributes[attribute].len = (uint8_t)(offset + len);
+  attributes[attribute].used = 1;
+  response()->data.rsp_gatt_server_write_attribute_value.result = bg_err_success;
+}
+
+void sli_bt_cmd_gatt_server_send_characteristic_notification(const void *payload)
+{
+  struct gecko_msg_gatt_server_send_characteristic_notification_cmd_t *cmd =
+    &command()->data.cmd_gatt_server_send_characteristic_notification;
+  (void)payload;
+  response()->data.rsp_gatt_server_send_characteristic_notification.result = bg_err_success;
+  emit(SIM_NOTIFY, cmd->connection, cmd->characteristic, 0, cmd->value.data, cmd->value.len);
+}
+
+void sli_bt_cmd_gatt_server_send_user_read_response(const void *payload)
+{
+  struct gecko_msg_gatt_server_send_user_read_response_cmd_t *cmd =
+    &command()->data.cmd_gatt_server_send_user_read_response;
+  (void)payload;
+  response()->data.rsp_gatt_server_send_user_read_response.result = bg_err_success;
+  emit(SIM_READ_RESPONSE, cmd->connection, cmd->characteristic, cmd->att_errorcode, cmd->value.data, cmd->value.len);
+}
+
+void sli_bt_cmd_gatt_server_send_user_write_response(const void *payload)
+{
+  struct gecko_msg_gatt_server_send_user_write_response_cmd_t *cmd =
+    &command()->data.cmd_gatt_server_send_user_write_response;
+  (void)payload;
+  response()->data.rsp_gatt_server_send_user_write_response.result = bg_err_success;
+  emit(SIM_WRITE_RESPONSE, cmd->connection, cmd->characteristic, cmd->att_errorcode, NULL, 0);
+}
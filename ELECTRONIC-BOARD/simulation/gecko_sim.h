@@ -0,0 +1,79 @@
+/*
+ *  gecko_sim.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Simulated Bluetooth stack for host builds of the firmware: app.c is compiled unchanged against the
+ *  SDK native_gecko.h, its commands land here and its events come from a script in virtual time,
+ *  the sleeptimer (sl_sleeptimer.h) counts the same virtual time, NVM3 objects are kept in RAM
+ */
+
+#ifndef GECKO_SIM_H_
+#define GECKO_SIM_H_
+
+#include <stdint.h>
+
+#include "native_gecko.h"
+
+/* virtual time runs on the 32768 Hz sleep clock like the soft timers, nothing waits in real time */
+#define SIM_TICKS_PER_MS 32.768
+
+/* what the application did through the stack */
+enum {
+  SIM_ADVERTISE = 1,
+  SIM_NOTIFY,
+  SIM_READ_RESPONSE,
+  SIM_WRITE_RESPONSE,
+  SIM_CLOSE,
+  SIM_RESET
+};
+
+typedef struct {
+  int kind;
+  double ms;
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t error;
+  uint8_t len;
+  uint8_t data[255];
+} sim_output;
+
+typedef void (*sim_output_fn)(const sim_output *output);
+typedef void (*sim_every_fn)(void);
+
+/* host cpu time the application spent on one event, from gecko_wait_event returning it to the next call */
+typedef void (*sim_handled_fn)(uint32_t event_id, double ms, double cpu_us);
+
+double sim_now_ms(void);
+
+/* virtual time moves by the host cpu time the application spends between stack calls times factor,
+   0 (default) - the application takes no time */
+void sim_cpu_scale(double factor);
+
+/* scripted events, any order, events at the same time keep the order they were added in */
+void sim_connect(double ms, uint8_t connection);
+void sim_disconnect(double ms, uint8_t connection, uint16_t reason);
+/* opcode gatt_write_command (without response) or gatt_write_request, user characteristics only */
+void sim_write(double ms, uint8_t connection, uint16_t characteristic, uint8_t opcode,
+               const uint8_t *data, uint8_t len);
+void sim_read(double ms, uint8_t connection, uint16_t characteristic);
+/* client enabled (gatt_notification) or disabled (0) notifications */
+void sim_client_config(double ms, uint8_t connection, uint16_t characteristic, uint16_t flags);
+
+/* harness code run like a sleeptimer interrupt every period_ms of virtual time from start_ms, for models
+   that have to see what the firmware does by then (a phone camera looking at the motor), they may script
+   events from now on; one per run */
+void sim_every(double start_ms, double period_ms, sim_every_fn fn);
+
+void sim_on_output(sim_output_fn fn);
+void sim_on_handled(sim_handled_fn fn);
+
+/* boots the application and runs it until nothing is scheduled before end_ms (or it resets),
+   once per process, appMain never returns on its own */
+void sim_run(gecko_configuration_t *config, double end_ms);
+
+/* attribute value the application wrote with gatt_server_write_attribute_value, length or -1 */
+int sim_attribute(uint16_t attribute, uint8_t *data, int size);
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ *  plansim.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Checks the S-curve planner (planner.c) on the host, exit 1 on a failure
+ *  usage: plansim [--record] [--dump=scenario]
+ *  single moves from rest are followed slice by slice: limits, jerk, no overshoot or hunting, arrival, and the
+ *  fixed point profile against the same accelerations integrated in doubles;
+ *  the planner_bench.c scenarios are filled in segments like on the board, every interval is checked
+ *  and their hashes have to equal pb_expected, the values the board benchmark compares with
+ *  --record prints pb_expected for planner_bench.c, --dump prints the steps of a scenario as csv
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "planner.h"
+#include "planner_bench.h"
+#include "stepper.h"
+
+#define MAX_SLICES (120 * PL_SLICE_HZ)
+
+typedef struct {
+  const char *name;
+  uint32_t v_max, a_max, jerk;
+} limits;
+
+static const limits limit_sets[] = {
+  { "gimbal", 1067, 2000, 20000 },
+  { "fast", 40000, 50000, 1000000 },
+  { "soft", 200, 100, 300 },
+};
+
+static const int32_t velocities[] = { 1, 37, 333, 1067, -1067, 40000 };
+static const int32_t positions[] = { 1, 2, 5, 100, 800, -3200, 20000 };
+
+static int failures = 0;
+
+static void fail(const char *what, const char *name, double value)
+{
+  if (failures++ < 20) {
+    printf("FAIL %s: %s (%g)\n", name, what, value);
+  }
+}
+
+static double steps_per_s(int32_t velocity)
+{
+  return velocity * (double)PL_SLICE_HZ / 65536;
+}
+
+/* one move from rest, slice by slice */
+static void follow(const limits *l, int mode, int32_t value)
+{
+  planner pl;
+  char name[96];
+  double position = 0, velocity = 0, worst = 0, overshoot = 0;
+  int32_t accel = 0, target_v;
+  uint32_t slices = 0;
+
+  snprintf(name, sizeof(name), "%s %s %d", l->name, mode == PL_VELOCITY_MODE ? "velocity" : "position", (int)value);
+  pl_init(&pl, PL_VELOCITY(l->v_max), PL_ACCEL(l->a_max), PL_JERK(l->jerk), STEPPER_TICK_HZ, STEPPER_MIN_INTERVAL);
+  if (mode == PL_VELOCITY_MODE) {
+    pl_velocity(&pl, PL_VELOCITY(value));
+  } else {
+    pl_position(&pl, PL_POSITION(value));
+  }
+  target_v = pl.v_target;
+
+  while (slices < MAX_SLICES) {
+    double from = accel * (double)pl.jerk, to;
+    pl_slice(&pl);
+    slices++;
+    to = pl.accel * (double)pl.jerk;
+    /* the position snap at the end may drop the acceleration */
+    if ((pl.accel - accel > 1 || accel - pl.accel > 1) && !pl_idle(&pl)) {
+      fail("jerk over the limit", name, slices);
+      break;
+    }
+    if (pl.accel > pl.ramp || -pl.accel > pl.ramp || pl.velocity > pl.v_max || -pl.velocity > pl.v_max) {
+      fail("acceleration or velocity over the limit", name, slices);
+      break;
+    }
+    accel = pl.accel;
+    /* exact integration of the accelerations the planner chose */
+    position += velocity + from / 2 + (to - from) / 6;
+    velocity += (from + to) / 2;
+    if (pl.accel == 0 && (velocity - pl.velocity) * (velocity - pl.velocity) < (double)pl.jerk * pl.jerk) {
+      velocity = pl.velocity;   /* the snap onto the target velocity */
+    }
+    if (mode == PL_VELOCITY_MODE) {
+      if ((target_v >= 0 && pl.velocity > target_v) || (target_v < 0 && pl.velocity < target_v)) {
+        fail("velocity overshoot", name, steps_per_s(pl.velocity - target_v));
+        break;
+      }
+      if (pl.velocity == target_v && pl.accel == 0) {
+        break;
+      }
+    } else {
+      double past = (double)(pl.position - pl.target) / 65536 * (value < 0 ? -1 : 1);
+      if (past > overshoot) {
+        overshoot = past;
+      }
+      if ((value > 0 && pl.velocity < 0) || (value < 0 && pl.velocity > 0)) {
+        fail("turned back on the way to the target", name, slices);
+        break;
+      }
+      if (pl_idle(&pl)) {
+        break;
+      }
+    }
+    if (fabs(position - (double)pl.position) > worst) {
+      worst = fabs(position - (double)pl.position);
+    }
+  }
+  if (slices >= MAX_SLICES) {
+    fail("target never reached", name, slices);
+  }
+  if (worst / 65536 > 0.01) {
+    fail("fixed point position off the exact profile (steps)", name, worst / 65536);
+  }
+  if (overshoot > 1) {
+    fail("position overshoot (steps)", name, overshoot);
+  }
+  if (mode == PL_POSITION_MODE && pl.position != pl.target) {
+    fail("position not reached", name, (double)(pl.position - pl.target) / 65536);
+  }
+}
+
+/* stream of one scenario */
+static struct {
+  int64_t step;
+  uint64_t tick;
+  int dump;
+  const char *name;
+} stream;
+
+static void observe(const planner *pl, const uint32_t *intervals, uint32_t count, int direction)
+{
+  uint64_t start = pl->last_tick;
+  uint32_t i;
+  for (i = 0; i < count; i++) {
+    start -= intervals[i];
+  }
+  /* after a restart the first interval counts from the end of the idle slice */
+  if (start < stream.tick) {
+    fail("intervals go back in time", stream.name, (double)(stream.tick - start));
+  }
+  stream.tick = start;
+  for (i = 0; i < count; i++) {
+    if (intervals[i] < STEPPER_MIN_INTERVAL) {
+      fail("interval shorter than the driver plays", stream.name, intervals[i]);
+    }
+    stream.step += direction;
+    stream.tick += intervals[i];
+    if (stream.dump) {
+      printf("%lld,%llu,%d\n", (long long)stream.step, (unsigned long long)stream.tick, direction);
+    }
+  }
+  if (stream.step != pl->step) {
+    fail("intervals do not add up to the planner's steps", stream.name, (double)(stream.step - pl->step));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  pb_result results[PB_SCENARIOS];
+  char names[PB_SCENARIOS][16];
+  int record = 0, dump = -1, matched = 1;
+  size_t i, j;
+
+  for (i = 1; i < (size_t)argc; i++) {
+    if (!strcmp(argv[i], "--record")) {
+      record = 1;
+    } else if (!strncmp(argv[i], "--dump=", 7) && atoi(argv[i] + 7) >= 0 && atoi(argv[i] + 7) < PB_SCENARIOS) {
+      dump = atoi(argv[i] + 7);
+    } else {
+      fprintf(stderr, "usage: plansim [--record] [--dump=0..%d]\n", PB_SCENARIOS - 1);
+      return 2;
+    }
+  }
+
+  if (dump >= 0) {
+    memset(&stream, 0, sizeof(stream));
+    stream.dump = 1;
+    printf("step,tick,direction\n");
+    pb_run(dump, NULL, observe, &results[0]);
+    return 0;
+  }
+
+  for (i = 0; i < sizeof(limit_sets) / sizeof(*limit_sets); i++) {
+    for (j = 0; j < sizeof(velocities) / sizeof(*velocities); j++) {
+      follow(&limit_sets[i], PL_VELOCITY_MODE, velocities[j]);
+    }
+    for (j = 0; j < sizeof(positions) / sizeof(*positions); j++) {
+      follow(&limit_sets[i], PL_POSITION_MODE, positions[j]);
+    }
+  }
+
+  for (i = 0; i < PB_SCENARIOS; i++) {
+    memset(&stream, 0, sizeof(stream));
+    stream.name = names[i];
+    snprintf(names[i], sizeof(names[i]), "scenario %d", (int)i);
+    pb_run((int)i, NULL, observe, &results[i]);
+    printf("%-16s %6u steps, at %6d, %5u slices, %4u fills, hash %08x%s\n", results[i].name,
+           (unsigned)results[i].steps, (int)results[i].position, (unsigned)results[i].slices,
+           (unsigned)results[i].fills, (unsigned)results[i].hash,
+           results[i].hash == pb_expected[i] ? "" : " (expected a different one)");
+    if (results[i].hash != pb_expected[i]) {
+      matched = 0;
+    }
+  }
+  if (record) {
+    printf("const uint32_t pb_expected[PB_SCENARIOS] = {");
+    for (i = 0; i < PB_SCENARIOS; i++) {
+      printf(" 0x%08x%s", (unsigned)results[i].hash, i + 1 < PB_SCENARIOS ? "," : " };\n");
+    }
+  } else if (!matched) {
+    fail("scenario hashes differ from pb_expected", "planner_bench.c", 0);
+  }
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
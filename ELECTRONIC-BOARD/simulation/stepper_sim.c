@@ -0,0 +1,319 @@
+/*
+ *  stepper_sim.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  stepper.h on the host: the stream of queued intervals is timed like TIMER0 and the LDMA of stepper.c,
+ *  a sleeptimer interrupt pops a segment when its last interval would be loaded and stops the motor at
+ *  its last step, the same moments the LDMA interrupt posts segment_done
+ *  the tables are played into the stats when queued and checksummed again when the driver lets go of them
+ */
+
+#include <stddef.h>
+
+#include "gecko_sim.h"
+#include "sl_sleeptimer.h"
+#include "stepper.h"
+#include "stepper_sim.h"
+
+/* steps of the windows the acceleration is estimated from */
+#define WINDOW 8
+
+typedef struct {
+  const uint32_t *intervals;
+  uint32_t count;
+  int direction;
+  uint32_t checksum;
+  uint64_t at;              /* overflow its first period starts at, in timer ticks */
+  uint64_t first_load;      /* overflow its first interval is written at, a period before at when queued */
+  uint32_t preloaded;       /* intervals written by start */
+} segment;
+
+static segment queue[2];
+static int queued = 0;
+static int running = 0;
+static uint64_t end_tick;   /* overflow of the last step */
+/* where the running move started, all steps when idle */
+static int32_t position = 0;
+static int moving = 1;
+/* steps of the running move's segments that left the queue, the last two of them may still be ahead */
+static uint32_t finished = 0;
+static uint64_t last_steps[2];
+static sched_task *done_task = NULL;
+static sl_sleeptimer_timer_handle_t timer;
+static stepper_sim_stats stats;
+
+/* rate estimate of the current move */
+static struct {
+  uint64_t start;
+  uint32_t steps;
+  double rate;
+  double mid;
+  int valid;
+} window;
+
+static uint64_t now_tick(void)
+{
+  return (uint64_t)(sim_now_ms() * (STEPPER_TICK_HZ / 1000));
+}
+
+static uint32_t checksum(const uint32_t *intervals, uint32_t count)
+{
+  uint32_t hash = 2166136261u, i;
+  for (i = 0; i < count; i++) {
+    hash = (hash ^ intervals[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/* ticks from the overflow of the first period to the overflow ending period n */
+static uint64_t span(const segment *s, uint32_t n)
+{
+  uint64_t ticks = 0;
+  uint32_t i;
+  for (i = 0; i < n && i < s->count; i++) {
+    ticks += s->intervals[i] + 1;
+  }
+  return ticks;
+}
+
+/* the LDMA writes interval m at the overflow before its period, the first two of a move before the start */
+static uint64_t loaded_at(const segment *s, uint32_t m)
+{
+  return m < s->preloaded ? 0 : m == 0 ? s->first_load : s->at + span(s, m - 1);
+}
+
+/* a first segment of two intervals has no descriptor, it goes at the stop */
+static int described(const segment *s)
+{
+  return s->count > s->preloaded;
+}
+
+static void play(const segment *s)
+{
+  uint64_t tick = s->at;
+  uint32_t i;
+  if (!stats.enabled) {
+    stats.disabled_steps += s->count;
+  }
+  for (i = 0; i < s->count; i++) {
+    uint32_t period = s->intervals[i] + 1;
+    double rate = (double)STEPPER_TICK_HZ / period;
+    if (stats.min_interval == 0 || period < stats.min_interval) {
+      stats.min_interval = period;
+    }
+    if (rate > stats.max_rate) {
+      stats.max_rate = rate;
+    }
+    tick += period;
+    if (++window.steps == WINDOW) {
+      double estimate = WINDOW * (double)STEPPER_TICK_HZ / (double)(tick - window.start);
+      double mid = (window.start + tick) / 2.0;
+      if (window.valid) {
+        double accel = (estimate - window.rate) * STEPPER_TICK_HZ / (mid - window.mid);
+        if (accel < 0) {
+          accel = -accel;
+        }
+        if (accel > stats.max_accel) {
+          stats.max_accel = accel;
+        }
+      }
+      window.rate = estimate;
+      window.mid = mid;
+      window.valid = 1;
+      window.start = tick;
+      window.steps = 0;
+    }
+  }
+  stats.steps += s->count;
+  stats.position += s->direction * (int32_t)s->count;
+  end_tick = tick;
+}
+
+static void pop(void)
+{
+  if (checksum(queue[0].intervals, queue[0].count) != queue[0].checksum) {
+    stats.changed++;
+  }
+  finished += queue[0].count;
+  last_steps[0] = queue[0].at + span(&queue[0], queue[0].count);
+  last_steps[1] = queue[0].count > 1 ? queue[0].at + span(&queue[0], queue[0].count - 1) : 0;
+  queue[0] = queue[1];
+  queued--;
+}
+
+/* steps of the running move played by now */
+static uint32_t played(uint64_t now)
+{
+  uint32_t n = finished, m;
+  n -= (last_steps[0] > now) + (last_steps[1] > now);
+  for (m = 0; queued && m < queue[0].count && queue[0].at + span(&queue[0], m + 1) <= now; m++) {
+    n++;
+  }
+  return n;
+}
+
+static void interrupt(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+/* segments the LDMA finished and the stop by now, then the interrupt for the next one */
+static void service(void)
+{
+  uint64_t now = now_tick(), next = 0;
+  int posted = 0;
+  while (queued && described(&queue[0]) && loaded_at(&queue[0], queue[0].count - 1) <= now) {
+    pop();
+    posted = 1;
+  }
+  if (running && end_tick <= now) {
+    running = 0;
+    while (queued) {
+      pop();
+    }
+    position += moving * (int32_t)finished;
+    posted = 1;
+  }
+  if (posted && done_task) {
+    sched_post(done_task);
+  }
+  sl_sleeptimer_stop_timer(&timer);
+  if (queued && described(&queue[0])) {
+    next = loaded_at(&queue[0], queue[0].count - 1);
+  } else if (running) {
+    next = end_tick;
+  }
+  if (next) {
+    /* the sleep clock is slower, the interrupt comes up to a sleep tick late */
+    uint64_t ticks = ((next - now) * SCHED_TICKS_PER_S + STEPPER_TICK_HZ - 1) / STEPPER_TICK_HZ;
+    sl_sleeptimer_start_timer(&timer, (uint32_t)ticks, interrupt, NULL, 0, 0);
+  }
+}
+
+static void interrupt(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  service();
+}
+
+static void enqueue(segment *s, const uint32_t *intervals, uint32_t count, int direction, uint64_t at,
+                    uint64_t first_load, uint32_t preloaded)
+{
+  s->intervals = intervals;
+  s->count = count;
+  s->direction = direction;
+  s->checksum = checksum(intervals, count);
+  s->at = at;
+  s->first_load = first_load;
+  s->preloaded = preloaded;
+  play(s);
+  queued++;
+}
+
+void stepper_init(sched_task *segment_done)
+{
+  done_task = segment_done;
+  queued = 0;
+  running = 0;
+  position = 0;
+  finished = 0;
+  stats = (stepper_sim_stats){ 0 };
+}
+
+void stepper_enable(int on)
+{
+  stats.enabled = on;
+}
+
+int stepper_queue(const uint32_t *intervals, uint32_t count, int direction)
+{
+  uint64_t now = now_tick();
+  int result = STEPPER_OK;
+
+  if (!intervals || count == 0 || count > STEPPER_MAX_SEGMENT || (direction != 1 && direction != -1)) {
+    return STEPPER_INVALID;
+  }
+  if (queued == 0 && running) {
+    result = STEPPER_TOO_LATE;
+  } else if (queued == 0) {
+    window.start = now;
+    window.steps = 0;
+    window.valid = 0;
+    stats.moves++;
+    if ((double)STEPPER_TICK_HZ / (intervals[0] + 1) > stats.max_start_rate) {
+      stats.max_start_rate = (double)STEPPER_TICK_HZ / (intervals[0] + 1);
+    }
+    running = 1;
+    moving = direction;
+    finished = 0;
+    last_steps[0] = last_steps[1] = 0;
+    enqueue(&queue[0], intervals, count, direction, now, now, 2);
+  } else if (queued == 2) {
+    result = STEPPER_BUSY;
+  } else if (direction != queue[0].direction) {
+    result = STEPPER_DIRECTION;
+  } else {
+    /* one more transfer of the running segment after the current one at least */
+    uint32_t left = 0, m;
+    for (m = queue[0].preloaded; m < queue[0].count; m++) {
+      left += loaded_at(&queue[0], m) > now;
+    }
+    if (!described(&queue[0]) || left < 2) {
+      result = STEPPER_TOO_LATE;
+    } else {
+      enqueue(&queue[1], intervals, count, direction, queue[0].at + span(&queue[0], queue[0].count),
+              queue[0].at + span(&queue[0], queue[0].count - 1), 0);
+    }
+  }
+  if (result != STEPPER_OK) {
+    stats.rejected++;
+  }
+  service();
+  return result;
+}
+
+void stepper_stop(void)
+{
+  uint64_t now = now_tick();
+  uint32_t steps, planned = finished;
+  int i;
+  if (!running) {
+    return;
+  }
+  /* steps after now do not happen */
+  steps = played(now);
+  for (i = 0; i < queued; i++) {
+    planned += queue[i].count;
+  }
+  stats.steps -= planned - steps;
+  stats.position -= moving * (int32_t)(planned - steps);
+  position += moving * (int32_t)steps;
+  queued = 0;
+  running = 0;
+  sl_sleeptimer_stop_timer(&timer);
+}
+
+int stepper_busy(void)
+{
+  return running;
+}
+
+int stepper_free(void)
+{
+  return 2 - queued;
+}
+
+int32_t stepper_position(void)
+{
+  return position;
+}
+
+const stepper_sim_stats *stepper_sim(void)
+{
+  return &stats;
+}
+
+int32_t stepper_played(void)
+{
+  return running ? position + moving * (int32_t)played(now_tick()) : position;
+}
@@ -0,0 +1,32 @@
+/*
+ *  stepper_sim.h
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Host model of the stepper driver (stepper.h): segments play in virtual time, what the motor did is
+ *  kept for the checks of boardsim
+ */
+
+#ifndef STEPPER_SIM_H_
+#define STEPPER_SIM_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t steps;
+  int32_t position;         /* steps played, signed */
+  uint32_t moves;           /* starts from rest */
+  uint32_t min_interval;    /* shortest step period in timer ticks */
+  double max_rate;          /* steps/s */
+  double max_accel;         /* steps/s^2, from the rates of 8 step windows */
+  double max_start_rate;    /* rate of the first period of a move, a move has to start from rest */
+  uint32_t changed;         /* tables written while the driver read them */
+  uint32_t rejected;        /* stepper_queue results other than STEPPER_OK */
+  uint32_t disabled_steps;  /* queued while the driver was disabled */
+  int enabled;
+} stepper_sim_stats;
+
+const stepper_sim_stats *stepper_sim(void);
+
+#endif
@@ -0,0 +1,329 @@
+/*
+ *  steptable.c
+ *  Firmware
+ *
+ *  Created by Jakub Adamski on 17/10/2026.
+ *  Copyright © 2026 Jakub Adamski. All rights reserved.
+ *  Checks the step interval tables of step_table.c and how stepper.c plays them, exit 1 on a failure
+ *  usage: steptable [--dump=start_rate,max_rate,accel,steps]
+ *  a grid of profiles and move lengths is built at the stepper's tick rate and checked against the exact
+ *  motion (times within 2 ticks), the acceleration limit, the peak rate, symmetry and chunked building;
+ *  the timer and LDMA stream of stepper.c is modelled (two intervals preloaded, segments of at most
+ *  STEPPER_MAX_SEGMENT chained, tail, stop) and has to give one pulse per step at the table's times;
+ *  moves of several queued segments are run through the descriptors overflow by overflow, with the
+ *  segment interrupts late, and the steps stepper.c counts from the channel have to be the pulses so far
+ *  --dump prints one move as csv: step, interval, time in ticks
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "step_table.h"
+#include "stepper.h"
+
+#define CHUNK 7
+
+static const uint32_t start_rates[] = { 0, 50, 400 };
+static const uint32_t max_rates[] = { 200, 2000, 20000, 40000 };
+static const uint32_t accels[] = { 500, 5000, 50000 };
+static const uint32_t moves[] = { 1, 2, 3, 7, 100, 1000, 20001 };
+
+static int failures = 0;
+static double worst_error = 0;
+
+static void fail(const st_profile *p, uint32_t steps, const char *what, double value)
+{
+  if (failures++ < 20) {
+    printf("FAIL v0 %u v %u a %u steps %u: %s (%g)\n",
+           (unsigned)p->start_rate, (unsigned)p->max_rate, (unsigned)p->accel, (unsigned)steps, what, value);
+  }
+}
+
+/* exact ticks from the start of a ramp to its step n */
+static double ramp(const st_profile *p, double n)
+{
+  double v0 = p->start_rate;
+  return p->tick_hz * (sqrt(v0 * v0 + 2.0 * p->accel * n) - v0) / p->accel;
+}
+
+/* exact ticks from the start of the move to step k, same split into ramps and cruise as st_trapezoid */
+static double exact(const st_profile *p, uint32_t steps, uint32_t k)
+{
+  uint32_t full = st_ramp_steps(p), up = full * 2 > steps ? steps / 2 : full;
+  double top = up < full && steps % 2 ? ramp(p, up + 1) : ramp(p, up);
+  double cruise = up < full ? 0 : (double)(steps - 2 * up) * p->tick_hz / p->max_rate;
+  if (k <= up) {
+    return ramp(p, k);
+  }
+  if (k <= steps - up) {
+    return up < full ? top : ramp(p, up) + (double)(k - up) * p->tick_hz / p->max_rate;
+  }
+  return top + cruise + ramp(p, up) - ramp(p, steps - k);
+}
+
+/* timer and LDMA of stepper.c: returns the number of pulses, their times have to match the table */
+static uint32_t play(const st_profile *p, uint32_t *tops, uint32_t steps)
+{
+  uint32_t *stream = malloc((steps + 2) * sizeof(uint32_t));
+  uint32_t count = 0, pulses = 0, done, k;
+  uint32_t top, topb, oc = STEPPER_PULSE_TICKS, ocb = STEPPER_PULSE_TICKS;
+  uint64_t now = 0, expected = 0;
+  int stopped = 0;
+
+  /* segments as the planner queues them, the driver preloads two intervals of the first one */
+  for (done = 0; done < steps; done += count) {
+    count = steps - done > STEPPER_MAX_SEGMENT ? STEPPER_MAX_SEGMENT : steps - done;
+    memcpy(stream + done, tops + done, count * sizeof(uint32_t));
+  }
+  stream[steps] = STEPPER_TICK_HZ / 1000 - 1;  /* tail */
+  top = stream[0];
+  topb = steps > 1 ? stream[1] : stream[steps];
+
+  /* overflow k: the buffered values are taken, the request writes stream element k + 1 */
+  for (k = 1; !stopped; k++) {
+    now += top + 1;
+    top = topb;
+    oc = ocb;
+    if (oc) {
+      pulses++;
+      expected += tops[k - 1] + 1;
+      if (k > steps || now != expected) {
+        fail(p, steps, "pulse off the table", (double)k);
+        break;
+      }
+    }
+    if (k + 1 <= steps) {
+      topb = stream[k + 1];
+    } else {
+      ocb = 0;      /* stop descriptor, its interrupt halts the timer in the tail period */
+      stopped = 1;
+    }
+  }
+  free(stream);
+  return pulses;
+}
+
+/* descriptor chain of stepper.c for segments of the given sizes, TAIL and STOP after the last one */
+#define TAIL -1
+#define STOP -2
+#define DONE -3
+
+/* elements of the stream loaded, counted like loaded() in stepper.c: the segments the interrupt did not
+   take off the queue yet are loaded whole up to the one the channel reads, then the tail and the stop */
+static uint32_t counted(const uint32_t *sizes, int segments, int popped, uint32_t finished, int channel, uint32_t offset)
+{
+  uint32_t n = finished;
+  int i;
+  for (i = popped; i < segments; i++) {
+    if (channel == i) {
+      return n + (i == 0 ? 2 : 0) + offset;
+    }
+    n += sizes[i];
+  }
+  return n + (channel == STOP ? 1 : channel == DONE ? 2 : 0);
+}
+
+static void count(const uint32_t *sizes, int segments, uint32_t late)
+{
+  static const st_profile none = { STEPPER_TICK_HZ, 0, 0, 0 };
+  uint32_t steps = 0, pulses = 0, finished = 0, offset = 0, k, due[8];
+  int i, channel, popped = 0, ends = 0, oc = 1, ocb = 1;
+
+  for (i = 0; i < segments; i++) {
+    steps += sizes[i];
+  }
+  /* the first two intervals (or the one and the tail) are preloaded */
+  channel = sizes[0] > 2 ? 0 : sizes[0] == 2 ? TAIL : STOP;
+  for (k = 1; channel != DONE || oc; k++) {
+    uint32_t length;
+    oc = ocb;
+    pulses += oc != 0;
+    /* the request writes the next element */
+    if (channel == STOP) {
+      ocb = 0;
+      channel = DONE;
+    } else if (channel == TAIL) {
+      channel = STOP;
+    } else if (channel >= 0) {
+      length = sizes[channel] - (channel == 0 ? 2 : 0);
+      if (++offset == length) {
+        due[ends++] = k + late;
+        channel = channel + 1 < segments ? channel + 1 : TAIL;
+        offset = 0;
+      }
+    }
+    /* segment interrupts, the stop one takes all */
+    while (popped < ends && (due[popped] <= k || channel == DONE)) {
+      finished += sizes[popped++];
+    }
+    if (counted(sizes, segments, popped, finished, channel, offset) - 2 != pulses) {
+      fail(&none, steps, "steps counted from the channel", (double)k);
+      return;
+    }
+    if (k > steps + 2) {
+      break;
+    }
+  }
+  if (pulses != steps) {
+    fail(&none, steps, "pulses of queued segments", pulses);
+  }
+}
+
+static void check(const st_profile *p, uint32_t steps)
+{
+  uint32_t *table = malloc(steps * sizeof(uint32_t)), *chunked = malloc(steps * sizeof(uint32_t));
+  uint32_t full = st_ramp_steps(p), up = full * 2 > steps ? steps / 2 : full, k, bad;
+  uint64_t time = 0;
+  double peak = 0;
+
+  if (st_trapezoid(p, steps, 0, table, steps) != steps) {
+    fail(p, steps, "count", 0);
+    goto out;
+  }
+  for (k = 0; k < steps; k += CHUNK) {
+    st_trapezoid(p, steps, k, chunked + k, CHUNK);
+  }
+  if (memcmp(table, chunked, steps * sizeof(uint32_t))) {
+    fail(p, steps, "chunked build differs", 0);
+  }
+  if ((bad = st_check(p, table, steps, STEPPER_MIN_INTERVAL))) {
+    fail(p, steps, "st_check", bad - 1);
+  }
+  for (k = 0; k < steps; k++) {
+    double error;
+    time += table[k];
+    error = fabs((double)time - exact(p, steps, k + 1));
+    if (error > worst_error) {
+      worst_error = error;
+    }
+    if (error > 2) {
+      fail(p, steps, "time", error);
+      break;
+    }
+    if ((double)p->tick_hz / table[k] > peak) {
+      peak = (double)p->tick_hz / table[k];
+    }
+  }
+  if (peak > p->max_rate * 1.01 + 1 && peak > p->start_rate * 1.01 + 1) {
+    fail(p, steps, "peak rate", peak);
+  }
+  for (k = 0; k < up; k++) {
+    if (table[k] != table[steps - 1 - k]) {
+      fail(p, steps, "ramps not symmetric", k);
+      break;
+    }
+  }
+  st_timer_top(table, steps);
+  if (play(p, table, steps) != steps) {
+    fail(p, steps, "pulses", 0);
+  }
+out:
+  free(table);
+  free(chunked);
+}
+
+static int dump(const char *arg)
+{
+  st_profile p = { STEPPER_TICK_HZ, 0, 0, 0 };
+  unsigned v0, v, a, steps, k;
+  uint64_t time = 0;
+  uint32_t *table;
+  if (sscanf(arg, "%u,%u,%u,%u", &v0, &v, &a, &steps) != 4 || steps == 0) {
+    fprintf(stderr, "--dump=start_rate,max_rate,accel,steps\n");
+    return 2;
+  }
+  p.start_rate = v0;
+  p.max_rate = v;
+  p.accel = a;
+  table = malloc(steps * sizeof(uint32_t));
+  if (st_trapezoid(&p, steps, 0, table, steps) != steps) {
+    fprintf(stderr, "invalid profile\n");
+    free(table);
+    return 2;
+  }
+  printf("step,interval,ticks\n");
+  for (k = 0; k < steps; k++) {
+    time += table[k];
+    printf("%u,%u,%llu\n", k + 1, (unsigned)table[k], (unsigned long long)time);
+  }
+  free(table);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  st_profile p = { STEPPER_TICK_HZ, 0, 0, 0 };
+  size_t i, j, l, m;
+  int tables = 0;
+
+  for (i = 1; i < (size_t)argc; i++) {
+    if (!strncmp(argv[i], "--dump=", 7)) {
+      return dump(argv[i] + 7);
+    }
+    fprintf(stderr, "usage: steptable [--dump=start_rate,max_rate,accel,steps]\n");
+    return 2;
+  }
+
+  for (i = 0; i < sizeof(start_rates) / sizeof(*start_rates); i++) {
+    for (j = 0; j < sizeof(max_rates) / sizeof(*max_rates); j++) {
+      for (l = 0; l < sizeof(accels) / sizeof(*accels); l++) {
+        for (m = 0; m < sizeof(moves) / sizeof(*moves); m++) {
+          p.start_rate = start_rates[i];
+          p.max_rate = max_rates[j];
+          p.accel = accels[l];
+          check(&p, moves[m]);
+          tables++;
+        }
+      }
+    }
+  }
+
+  /* a lone segment, segments chained to the first one, short ones after a long one */
+  {
+    static const uint32_t moves_of[][5] = { { 1 }, { 2 }, { 3 }, { 4, 1 }, { 4, 4, 4, 4, 4 }, { 7, 2, 5 },
+                                            { 100, 1, 1, 1, 3 }, { STEPPER_MAX_SEGMENT, 4, STEPPER_MAX_SEGMENT } };
+    static const int segments[] = { 1, 1, 1, 2, 5, 3, 5, 3 };
+    uint32_t late;
+    for (i = 0; i < sizeof(segments) / sizeof(*segments); i++) {
+      for (late = 0; late < 3; late++) {
+        count(moves_of[i], segments[i], late);
+      }
+    }
+  }
+
+  /* parameters st_trapezoid must refuse */
+  p.start_rate = 0;
+  p.max_rate = ST_MAX_RATE + 1;
+  p.accel = 1000;
+  if (st_trapezoid(&p, 10, 0, NULL, 0) != 0) {
+    fail(&p, 10, "rate over ST_MAX_RATE accepted", 0);
+  }
+  p.max_rate = 1000;
+  p.accel = 0;
+  if (st_trapezoid(&p, 10, 0, NULL, 0) != 0) {
+    fail(&p, 10, "zero acceleration accepted", 0);
+  }
+
+  /* st_check has to see a ramp twice as steep and a step that is too fast */
+  {
+    uint32_t table[200];
+    p.max_rate = 20000;
+    p.accel = 10000;
+    st_trapezoid(&p, 200, 0, table, 200);
+    p.accel = 5000;
+    if (!st_check(&p, table, 200, STEPPER_MIN_INTERVAL)) {
+      fail(&p, 200, "steep ramp passed st_check", 0);
+    }
+    p.accel = 10000;
+    table[100] = STEPPER_MIN_INTERVAL - 1;
+    if (st_check(&p, table, 200, STEPPER_MIN_INTERVAL) != 101) {
+      fail(&p, 200, "short interval passed st_check", 0);
+    }
+  }
+
+  printf("%d tables, worst time error %.3f ticks\n", tables, worst_error);
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#exports one tower of the siamese net (my_net.py) for the android app
+#tower: MobileNetV2 224x224x3 input normalized to -1..1 (BGR like cv2.imread) -> 1280 embedding
+#head: dense layer on |embedding1 - embedding2| saved as raw little endian float32, 1280 weights + bias
+#copy both output files to APPS/Android/FinalAppv2/app/src/main/assets
+import keras
+import numpy as np
+import tensorflow as tf
+
+MODEL_PATH = 'Model/0_newdata_imagenet_350.h5'
+TOWER_H5 = 'siamese_tower.h5'
+TOWER_TFLITE = 'siamese_tower.tflite'
+HEAD_BIN = 'siamese_head.bin'
+
+#the same function as in my_net.py, needed to load lambda layer
+def absolute(tensors):
+    return [keras.backend.abs(tensors[0]-tensors[1])]
+
+model = keras.models.load_model(MODEL_PATH, custom_objects={'absolute': absolute, 'keras': keras})
+
+#first input and its pooled output are one tower, both towers have the same imagenet weights
+difference = [l for l in model.layers if isinstance(l, keras.layers.Lambda)][0]
+tower = keras.models.Model(inputs=model.inputs[0], outputs=difference.input[0])
+tower.save(TOWER_H5)
+
+#batch dimension stays flexible, the app resizes input to the number of crops
+converter = tf.lite.TFLiteConverter.from_keras_model_file(TOWER_H5)
+open(TOWER_TFLITE, 'wb').write(converter.convert())
+
+weights, bias = model.layers[-1].get_weights()
+head = np.concatenate([weights.reshape(-1), bias.reshape(-1)]).astype('<f4')
+head.tofile(HEAD_BIN)
+
+print('tower:', TOWER_TFLITE, 'embedding size:', weights.shape[0])
+print('head:', HEAD_BIN, head.shape[0], 'floats')
@@ -0,0 +1,41 @@
+#packs the app models into one blob, the app maps it and gives interpreters slices of it without copying
+#models are page aligned from the start of models.bin, the app copies it out of the apk once (assets are only
+#4 byte aligned there) and maps the copy from offset 0
+#layout (little endian): magic 'OTMB', version, entry count, alignment (uint32 each)
+#then per entry: name (48 bytes, zero padded), offset, size (uint64), every model starts at a multiple of alignment
+#run after export.py / quantize.py, copy models.bin to APPS/Android/FinalAppv2/app/src/main/assets
+import os, struct, sys
+
+PACK = 'models.bin'
+MAGIC = b'OTMB'
+VERSION = 1
+ALIGNMENT = 16384 #largest page size of android devices, also fine for 4k pages
+NAME_SIZE = 48
+MODELS = ['../APPS/Android/FinalAppv2/app/src/main/assets/q_detect.tflite',
+          'siamese_tower_int8.tflite', 'siamese_tower.tflite', 'siamese_head.bin']
+
+def aligned(n):
+    return (n + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+paths = [p for p in (sys.argv[1:] or MODELS) if os.path.exists(p)]
+header = 16 + len(paths) * (NAME_SIZE + 16)
+offset = aligned(header)
+entries = []
+for path in paths:
+    name = os.path.basename(path).encode()
+    if len(name) >= NAME_SIZE:
+        sys.exit('name too long: ' + path)
+    size = os.path.getsize(path)
+    entries.append((name, offset, size, path))
+    offset = aligned(offset + size)
+
+with open(PACK, 'wb') as out:
+    out.write(MAGIC + struct.pack('<III', VERSION, len(entries), ALIGNMENT))
+    for name, start, size, _ in entries:
+        out.write(name.ljust(NAME_SIZE, b'\0') + struct.pack('<QQ', start, size))
+    for name, start, size, path in entries:
+        out.write(b'\0' * (start - out.tell()))
+        out.write(open(path, 'rb').read())
+        print(name.decode(), 'at', start, size, 'bytes')
+
+print(PACK, os.path.getsize(PACK), 'bytes,', len(entries), 'models')
@@ -0,0 +1,97 @@
+#int8 export of the siamese tower (run export.py first)
+#weights are quantized per channel, activation ranges are calibrated on crops from the YES/NO pair datasets
+#quantized tower is accepted only if the pair accuracy on validation stays at the float baseline (85%)
+#copy siamese_tower_int8.tflite to APPS/Android/FinalAppv2/app/src/main/assets, app uses it when present
+import os, random, time
+import numpy as np
+import tensorflow as tf
+from cv2 import cv2
+
+TOWER_H5 = 'siamese_tower.h5'
+TOWER_TFLITE = 'siamese_tower.tflite'
+TOWER_INT8 = 'siamese_tower_int8.tflite'
+HEAD_BIN = 'siamese_head.bin'
+train_dir = 'DATA/train'
+validation_dir = 'DATA/validation'
+
+CALIBRATION_IMAGES = 300 #crops used to find activation ranges
+BASELINE = 0.85 #validation accuracy of my_net.py model
+TOLERANCE = 0.01 #allowed drop below the baseline
+
+#the same normalization as in my_net.py
+def convert(img):
+    img = np.expand_dims(img, axis=0)
+    img = (2.0 / 255.0) * img - 1.0
+    img = img.astype('float32')
+    return img
+
+#pairs as in my_net.py, picture has two 224x224 crops side by side
+def pairs(path):
+    alldata = []
+    for label, folder in [(1, '/YES/'), (0, '/NO/')]:
+        for name in os.listdir(path + folder):
+            img = cv2.imread(path + folder + name)
+            alldata.append([img[:224, :224], img[:224, 224:448], label])
+    return alldata
+
+def representative_dataset():
+    crops = [p[0] for p in train_pairs] + [p[1] for p in train_pairs]
+    random.shuffle(crops)
+    for crop in crops[:CALIBRATION_IMAGES]:
+        yield [convert(crop)]
+
+class Tower:
+    def __init__(self, path):
+        self.size = os.path.getsize(path)
+        self.interpreter = tf.lite.Interpreter(model_path=path)
+        self.interpreter.allocate_tensors()
+        self.input = self.interpreter.get_input_details()[0]['index']
+        self.output = self.interpreter.get_output_details()[0]['index']
+        self.time = 0
+        self.runs = 0
+
+    def embed(self, img):
+        times = time.time()
+        self.interpreter.set_tensor(self.input, convert(img))
+        self.interpreter.invoke()
+        embedding = self.interpreter.get_tensor(self.output)[0].copy()
+        self.time += time.time() - times
+        self.runs += 1
+        return embedding
+
+#siamese head from export.py, dense layer on |e1 - e2| with sigmoid
+head = np.fromfile(HEAD_BIN, dtype='<f4')
+weights, bias = head[:-1], head[-1]
+
+def accuracy(tower, data):
+    good = 0
+    for img1, img2, label in data:
+        score = 1 / (1 + np.exp(-(np.dot(weights, np.abs(tower.embed(img1) - tower.embed(img2))) + bias)))
+        if (score > 0.5) == (label == 1):
+            good += 1
+    return good / len(data)
+
+train_pairs = pairs(train_dir)
+validation_pairs = pairs(validation_dir)
+print('Calibration pairs:', len(train_pairs), 'validation pairs:', len(validation_pairs))
+
+#float input and output stay, so the app preprocessing does not change
+converter = tf.lite.TFLiteConverter.from_keras_model_file(TOWER_H5)
+converter.optimizations = [tf.lite.Optimize.DEFAULT]
+converter.representative_dataset = representative_dataset
+open(TOWER_INT8, 'wb').write(converter.convert())
+
+fp32 = Tower(TOWER_TFLITE)
+int8 = Tower(TOWER_INT8)
+fp32_acc = accuracy(fp32, validation_pairs)
+int8_acc = accuracy(int8, validation_pairs)
+
+#speed on this CPU, memory is mostly weights so file size is a good measure
+for name, tower, acc in [('fp32', fp32, fp32_acc), ('int8', int8, int8_acc)]:
+    print(name, 'accuracy: %.3f' % acc, 'time: %.1fms' % (1000 * tower.time / tower.runs), 'size: %.1fMB' % (tower.size / 1e6))
+
+if int8_acc >= BASELINE - TOLERANCE:
+    print('int8 tower accepted, copy', TOWER_INT8, 'to app assets')
+else:
+    print('int8 tower below baseline, app should keep using', TOWER_TFLITE)
+    os.remove(TOWER_INT8)